@@ -0,0 +1,13 @@
+#ifndef CUTOFF_LOG_H
+#define CUTOFF_LOG_H
+
+#include <stdint.h>
+
+// Hardware cut-off trips (NVS), shown on the info screen
+struct CutoffLog {
+  uint32_t trips;           // Trips since the log was created
+  float lastLimitC;         // Alert limit in force at the last trip
+  float lastTemperatureC;   // Reading when the control task saw the last trip
+};
+
+#endif // CUTOFF_LOG_H
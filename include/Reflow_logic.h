@@ -2,7 +2,19 @@
 #define REFLOW_LOGIC_H
 
 #include <Arduino.h>
-#include <PID_v1.h>
+#include "PIDEngine.h"
+#include "PIDAutotune.h"
+#include "PlantModel.h"
+#include "SmithPredictor.h"
+#include "SetpointTrajectory.h"
+#include "IterativeLearning.h"
+#include "ModelPredictive.h"
+#include "BoardObserver.h"
+#include "ReflowSequencer.h"
+#include "RunAnalyzer.h"
+#include "FaultEngine.h"
+#include "CutoffLog.h"
+#include "RunLimits.h"
 
 // ***** TYPE DEFINITIONS *****
 // Reflow state machine types
@@ -14,7 +26,9 @@ enum ReflowState {
   REFLOW_STATE_COOL,
   REFLOW_STATE_COMPLETE,
   REFLOW_STATE_TOO_HOT,
-  REFLOW_STATE_ERROR
+  REFLOW_STATE_ERROR,
+  REFLOW_STATE_AUTOTUNE,
+  REFLOW_STATE_CHARACTERIZE
 };
 
 enum ReflowStatus {
@@ -39,7 +53,10 @@ enum Switch {
 #define TEMPERATURE_COOL_MIN 50
 #define TEMPERATURE_REFLOW_MAX 250
 
-// PID constants
+// PID constants (PID_v1 units: Ki per second, Kd in seconds)
+// Numeric type of the PID engine: float (hardware FPU) or Fixed16 (Q16.16)
+#define PID_NUMERIC_TYPE float
+
 #define PID_KP_PREHEAT 100
 #define PID_KI_PREHEAT 0.025
 #define PID_KD_PREHEAT 20
@@ -52,13 +69,177 @@ enum Switch {
 #define PID_KI_REFLOW 0.05
 #define PID_KD_REFLOW 350
 
+// Setpoint trajectory built from the profile stages and time range (ramp rates in C/s)
+#define TRAJECTORY_PREHEAT_RATE 1.5
+#define TRAJECTORY_REFLOW_RATE 1.5
+#define TRAJECTORY_COOL_RATE 2.0
+#define TRAJECTORY_MIN_SOAK 30
+// The trajectory clock pauses while the oven lags the setpoint by more than this
+#define TRAJECTORY_MAX_LAG 10
+
+// Feed-forward from the setpoint slope and the loss at the current temperature,
+// summed with the PID output. Uses the characterized oven model, or these
+// constants until the oven has been characterized
+#define FEEDFORWARD_ENABLED 1
+#define FEEDFORWARD_GAIN 270
+#define FEEDFORWARD_TAU 140
+#define FEEDFORWARD_AMBIENT 25
+// Slope lookahead in s when the model has no dead time
+#define FEEDFORWARD_LOOKAHEAD 5
+
+// Iterative learning: each completed run corrects the feed-forward of the next
+// run of the same profile (stored per profile, cleared when the oven is re-characterized)
+#define ILC_ENABLED 1
+#define ILC_BIN_TIME 2
+// Duty per C of tracking error, about half the PID's proportional gain
+#define ILC_LEARNING_GAIN 0.025
+#define ILC_FORGETTING 0.99
+#define ILC_LIMIT 0.3
+
+// Model-predictive control instead of PID + feed-forward while heating, once
+// the oven has been characterized. Hard limits: the profile's peak and max ramp rate
+#define MPC_ENABLED 0
+#define MPC_MOVE_WEIGHT 0.02
+// Ramp limit for profiles without max_ramp_rate: MPC_MAX_RAMP_RATE in RunLimits.h
+
+// Smith predictor around the PID once a characterized oven model with dead time is stored
+#define PID_DEAD_TIME_COMPENSATION 1
+// The REFLOW state cuts the heater this far below the peak to absorb the oven's
+// transport lag; with dead-time compensation the predicted temperature is used
+#define REFLOW_PEAK_MARGIN 5
+#define REFLOW_PEAK_MARGIN_COMPENSATED 0
+// Longest hold at the peak (s) once the setpoint trajectory is cooling, in every
+// controller mode, whether or not the cut-off was reached
+#define REFLOW_PEAK_HOLD_MAX 60
+// Longest REFLOW stage (s) from its start, also when the trajectory stopped
+// because the oven levelled off below the peak
+#define REFLOW_MAX_TIME 180
+
+// Board observer: two-node model (oven air and board) estimating the joint temperature
+#define BOARD_TAU 15
+#define BOARD_MASS_RATIO 0.3
+#define BOARD_AIR_CORRECTION 0.5
+#define BOARD_BOARD_CORRECTION 0.05
+// Temperature the PID regulates on per phase (CONTROL_VARIABLE_AIR or _BOARD)
+#define CONTROL_VARIABLE_PREHEAT CONTROL_VARIABLE_AIR
+#define CONTROL_VARIABLE_SOAK CONTROL_VARIABLE_AIR
+#define CONTROL_VARIABLE_REFLOW CONTROL_VARIABLE_AIR
+// REFLOW cuts the heater once the board is predicted to reach the peak within
+// BOARD_PEAK_HORIZON s, instead of comparing the air with the peak. Only with a
+// characterized oven model; on the FEEDFORWARD_* fallback the air decides
+#define REFLOW_EXIT_ON_BOARD 1
+#define BOARD_PEAK_HORIZON 120
+
+// Run conformance scoring: limits (RUN_*) in RunLimits.h
+// Reports kept in NVS (ring)
+#define RUN_HISTORY_SIZE 8
+
+// Relay autotune (one experiment per phase at the profile's operating temperature)
+#define AUTOTUNE_HYSTERESIS 1.0
+#define AUTOTUNE_CYCLES 3
+#define AUTOTUNE_TIMEOUT 1800
+#define AUTOTUNE_RULE AUTOTUNE_RULE_TYREUS_LUYBEN
+
+// Oven characterization: heater steps fitted to a first-order-plus-dead-time model
+#define CHARACTERIZE_BASELINE_TIME 30
+#define CHARACTERIZE_STEP_DUTY 1.0
+#define CHARACTERIZE_PEAK 150
+#define CHARACTERIZE_COOL_DROP 30
+#define CHARACTERIZE_HOLD_DUTY 0.35
+#define CHARACTERIZE_HOLD_TIME 300
+#define CHARACTERIZE_MAX_DEAD_TIME 20
+#define CHARACTERIZE_TIMEOUT 1800
+
+// SSR modulation per phase (SSR_MODULATION_WINDOWED, _BURST_FIRE or _SIGMA_DELTA)
+// Half-cycle modulation removes the slow-PWM ripple on the SOAK plateau
+#define SSR_MODULATION_PREHEAT SSR_MODULATION_WINDOWED
+#define SSR_MODULATION_SOAK SSR_MODULATION_SIGMA_DELTA
+#define SSR_MODULATION_REFLOW SSR_MODULATION_WINDOWED
+#define SSR_MODULATION_COOL SSR_MODULATION_WINDOWED
+
 // Timing constants
 #define PID_SAMPLE_TIME 1000
 #define SENSOR_SAMPLING_TIME 1000
-#define SOAK_MICRO_PERIOD 9000
-#define SOAK_TEMPERATURE_STEP 5
 #define DEBOUNCE_PERIOD_MIN 50
 
+// Task constants
+// The control task runs on the application core with a hard period; UI and
+// networking run on the protocol core next to the WiFi stack
+#define CONTROL_TASK_PERIOD_MS 10
+#define CONTROL_TASK_CORE 1
+#define CONTROL_TASK_PRIORITY (configMAX_PRIORITIES - 2)
+// Sequencer, MPC, observer and fault handling with String logging; printStats()
+// reports the free stack left
+#define CONTROL_TASK_STACK 8192
+#define UI_TASK_PERIOD_MS 20
+#define UI_TASK_CORE 0
+#define UI_TASK_PRIORITY 1
+#define SENSOR_TASK_CORE 0
+#define SENSOR_TASK_PRIORITY 3
+#define SENSOR_POLL_PERIOD_MS 10
+// A sample older than this is treated as a sensor failure
+#define SENSOR_STALE_TIME 2000
+// 16-bit conversions (80 ms) oversample the 1 s control period
+#define SENSOR_RESOLUTION MCP9600_RES_16
+
+// Thermocouple probes: air (MCP9600 at the default address), board top and board bottom
+// (MCP9600_BOARD_TOP_ADDRESS, MCP9600_BOARD_BOTTOM_ADDRESS). SENSOR_PROBES of them are used
+#define SENSOR_PROBE_AIR 0
+#define SENSOR_PROBE_BOARD_TOP 1
+#define SENSOR_PROBE_BOARD_BOTTOM 2
+#define SENSOR_PROBE_COUNT 3
+#define SENSOR_PROBES 1
+// Controlled temperature from the probes (FUSION_POLICY_PRIMARY, _MAX, _WEIGHTED or _PHASE),
+// a failed or missing probe drops out and the air probe takes over
+#define SENSOR_FUSION_POLICY FUSION_POLICY_PRIMARY
+#define SENSOR_WEIGHT_AIR 1.0
+#define SENSOR_WEIGHT_BOARD_TOP 1.0
+#define SENSOR_WEIGHT_BOARD_BOTTOM 1.0
+// Probe per phase with FUSION_POLICY_PHASE
+#define SENSOR_PROBE_PREHEAT SENSOR_PROBE_AIR
+#define SENSOR_PROBE_SOAK SENSOR_PROBE_AIR
+#define SENSOR_PROBE_REFLOW SENSOR_PROBE_BOARD_TOP
+#define SENSOR_PROBE_COOL SENSOR_PROBE_AIR
+
+// Fault engine: any fault latches its cause, enters REFLOW_STATE_ERROR and forces the SSR off.
+// Sensor faults (open, short, no data, range) clear once the thermocouple is healthy again,
+// frozen/jumping readings, heater and relay faults and over-temperature need a restart
+#define FAULT_MIN_TEMPERATURE -20
+#define FAULT_MAX_TEMPERATURE 500
+#define FAULT_OVER_TEMPERATURE (TEMPERATURE_REFLOW_MAX + 10)
+#define FAULT_SENSOR_DEBOUNCE 3
+// Step between consecutive conversions, kept for FAULT_JUMP_CONFIRM conversions
+#define FAULT_JUMP 10.0
+#define FAULT_JUMP_CONFIRM 3
+// Reading inside FAULT_FLATLINE_BAND for FAULT_FLATLINE_TIME ms at FAULT_FLATLINE_DUTY or more
+#define FAULT_FLATLINE_TIME 30000
+#define FAULT_FLATLINE_BAND 0.05
+#define FAULT_FLATLINE_DUTY 0.6
+// Less than FAULT_HEATING_RISE C in FAULT_HEATING_WINDOW ms at FAULT_HEATING_DUTY or more
+#define FAULT_HEATING_WINDOW 30000
+#define FAULT_HEATING_DUTY 0.95
+#define FAULT_HEATING_RISE 5.0
+// SSR off: at most FAULT_STUCK_COAST C of coasting in FAULT_STUCK_GRACE ms, then
+// no more than FAULT_STUCK_RISE C above the lowest reading
+#define FAULT_STUCK_GRACE 30000
+#define FAULT_STUCK_COAST 10.0
+#define FAULT_STUCK_RISE 5.0
+
+// Hardware cut-off: MCP9600 alert HW_CUTOFF_ALERT drives MCP9600_ALERT_PIN low above the
+// limit and its interrupt kills the SSR, whatever the tasks are doing. The limit is the
+// running profile's peak + HW_CUTOFF_MARGIN, never above TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN
+#define HW_CUTOFF_ALERT 1
+#define HW_CUTOFF_MARGIN 20
+#define HW_CUTOFF_HYSTERESIS 10
+
+// Sample filter pipeline (median -> IIR or Kalman -> derivative)
+#define FILTER_MEDIAN_WINDOW 5
+#define FILTER_SMOOTHER FILTER_SMOOTHER_KALMAN
+#define FILTER_IIR_TIME_CONSTANT 1.0
+#define FILTER_KALMAN_Q 0.05
+#define FILTER_KALMAN_R 0.04
+#define FILTER_DERIVATIVE_WINDOW 12
+
 // ***** EXTERNAL VARIABLES *****
 // Reflow state variables (extern declarations)
 extern ReflowState reflowState;
@@ -67,8 +248,17 @@ extern DebounceState debounceState;
 extern long lastDebounceTime;
 extern Switch switchStatus;
 extern int timerSeconds;
+extern OvenGains ovenGains;
+extern bool autotuneRequested;
+extern PlantModel plantModel;
+extern bool characterizeRequested;
+extern RunReport lastRunReport;
+extern volatile bool runReportReady;
+extern CutoffLog cutoffLog;
+extern ControlClock* controlClock;
 
 // Function declaration
 void reflow_main();
+const char* reflowStateName(ReflowState state);
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef RUN_LIMITS_H
+#define RUN_LIMITS_H
+
+// Profile limits shared by the firmware (Reflow_logic.h) and the native
+// controller benchmark; no Arduino dependencies
+
+// Ramp limit in C/s for profiles without max_ramp_rate (J-STD-020 heating limit)
+#define MPC_MAX_RAMP_RATE 3.0
+
+// Run conformance scoring, limits around the profile: liquidus = melting_point,
+// peak between stages_reflow_1 - RUN_PEAK_TOLERANCE and temp_range_1, soak window
+// stages_soak_0 - stages_soak_1, ramp limit max_ramp_rate, run within time_range_1
+#define RUN_TAL_MIN 30
+#define RUN_TAL_MAX 90
+#define RUN_PEAK_TOLERANCE 5
+#define RUN_MAX_COOL_RATE 6
+#define RUN_SOAK_MIN 60
+#define RUN_SOAK_MAX 120
+#define RUN_DURATION_MARGIN 60
+
+#endif // RUN_LIMITS_H
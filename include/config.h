@@ -37,12 +37,24 @@
 // I2C pin definitions
 #define I2C_SDA 22
 #define I2C_SCL 27
+// The MCP9600 is rated for 100 kHz; 400 kHz (fast mode) or 1 MHz only with parts
+// rated for it on the bus, or after checking the waveform on this board
+#define I2C_FREQUENCY 100000
+// Extra MCP9600 board probes (address pins), the air probe uses MCP9600_DEFAULT_ADDRESS
+#define MCP9600_BOARD_TOP_ADDRESS 0x66
+#define MCP9600_BOARD_BOTTOM_ADDRESS 0x65
 
 // Profile configuration
 #define NUM_OF_PROFILES 10
 
 // Output pin definitions
 #define SSR_PIN 26      // Solid State Relay pin
+#define SSR_TIMER 0     // Hardware timer generating the SSR window edges
+#define MAINS_FREQUENCY 50  // Hz, sets the half-cycle slot of the burst-fire and sigma-delta modes
+
+// MCP9600 ALERT1 output (open drain, active low), cuts the SSR from its interrupt.
+// GPIO 35 is input only without an internal pull-up: fit 10k to 3.3 V
+#define MCP9600_ALERT_PIN 35
 //#define BUZZER_PIN 26   // Buzzer pin
 
 // SD Card pin definitions
@@ -0,0 +1,84 @@
+#include "BoardObserver.h"
+
+BoardObserver::BoardObserver()
+  : samplePeriodS(1.0f), airC(0.0f), boardC(0.0f), delay(0), head(0), configured(false) {
+  oven = {0, 0, 0, 0, 0, 0};
+  board = defaultBoard();
+  reset(0.0f);
+}
+
+BoardModel BoardObserver::defaultBoard() {
+  BoardModel b;
+  b.boardTauS = 15.0f;
+  b.massRatio = 0.3f;
+  b.airCorrection = 0.5f;
+  b.boardCorrection = 0.05f;
+  return b;
+}
+
+bool BoardObserver::configure(const PlantModel& oven, const BoardModel& board, float samplePeriodS) {
+  configured = false;
+  if (!oven.valid || oven.gainC <= 0.0f || oven.tauS <= 0.0f || board.boardTauS <= 0.0f || samplePeriodS <= 0.0f) {
+    return false;
+  }
+  this->oven = oven;
+  this->board = board;
+  this->samplePeriodS = samplePeriodS;
+  int d = (int)(oven.deadTimeS / samplePeriodS + 0.5f);
+  if (d < 0) d = 0;
+  if (d > BOARD_OBSERVER_MAX_DELAY) d = BOARD_OBSERVER_MAX_DELAY;
+  delay = (uint8_t)d;
+  configured = true;
+  return true;
+}
+
+void BoardObserver::reset(float temperatureC) {
+  airC = temperatureC;
+  boardC = temperatureC;
+  for (int i = 0; i <= BOARD_OBSERVER_MAX_DELAY; i++) history[i] = 0.0f;
+  head = 0;
+}
+
+void BoardObserver::step(float& air, float& boardTemp, float duty, float dtS) const {
+  float exchange = (air - boardTemp) / board.boardTauS;
+  float airRate = (oven.ambientC + oven.gainC * duty - air) / oven.tauS - board.massRatio * exchange;
+  air += airRate * dtS;
+  boardTemp += exchange * dtS;
+}
+
+void BoardObserver::update(float measuredC, float duty) {
+  if (!configured) {
+    // No model: the board is taken as the air
+    airC = measuredC;
+    boardC = measuredC;
+    return;
+  }
+  // Duty that reaches the oven now, delayed by the dead time
+  history[head] = duty;
+  head = (uint8_t)((head + 1) % (delay + 1));
+  step(airC, boardC, history[head], samplePeriodS);
+
+  float innovation = measuredC - airC;
+  airC += board.airCorrection * innovation;
+  boardC += board.boardCorrection * innovation;
+}
+
+float BoardObserver::predictBoardPeak(float horizonS) const {
+  if (!configured) return boardC;
+  float air = airC;
+  float boardTemp = boardC;
+  float peak = boardTemp;
+  int steps = (int)(horizonS / samplePeriodS);
+  uint8_t index = head;
+  for (int i = 0; i < steps; i++) {
+    // Duty still in the dead-time pipe, then heater off
+    float duty = 0.0f;
+    if (i < delay) {
+      index = (uint8_t)((index + 1) % (delay + 1));
+      duty = history[index];
+    }
+    step(air, boardTemp, duty, samplePeriodS);
+    if (boardTemp > peak) peak = boardTemp;
+  }
+  return peak;
+}
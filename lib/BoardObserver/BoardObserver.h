@@ -0,0 +1,67 @@
+#ifndef BOARD_OBSERVER_H
+#define BOARD_OBSERVER_H
+
+#include <stdint.h>
+#include "PlantModel.h"
+
+// Longest heater dead time the observer delays the duty by, in samples
+#define BOARD_OBSERVER_MAX_DELAY 32
+
+// Second node of the thermal model: the board (and its joints) exchanging
+// heat with the oven air
+struct BoardModel {
+  float boardTauS;          // Board time constant to the air around it
+  float massRatio;          // Board heat capacity relative to the oven's
+  float airCorrection;      // Observer gain on the air estimate per sample (0 - 1)
+  float boardCorrection;    // Observer gain on the board estimate per sample
+};
+
+// Two-node observer: estimates the board temperature the thermocouple cannot
+// see from the air measurement and the heater duty.
+//
+//   air'   = (ambient + gain * duty(t - dead time) - air) / tau - massRatio * (air - board) / boardTau
+//   board' = (air - board) / boardTau
+//
+// The air node is the characterized oven model (same steady-state gain), the
+// board follows it with its own lag. Every sample both estimates are
+// corrected by the air innovation (measurement minus estimated air).
+class BoardObserver {
+private:
+  PlantModel oven;
+  BoardModel board;
+  float samplePeriodS;
+  float airC;
+  float boardC;
+  float history[BOARD_OBSERVER_MAX_DELAY + 1];
+  uint8_t delay;
+  uint8_t head;
+  bool configured;
+
+  // One Euler step of the two-node model
+  void step(float& air, float& boardTemp, float duty, float dtS) const;
+
+public:
+  BoardObserver();
+
+  static BoardModel defaultBoard();
+  // False for an invalid oven model
+  bool configure(const PlantModel& oven, const BoardModel& board, float samplePeriodS);
+  bool isConfigured() const { return configured; }
+
+  // Oven and board at the same temperature, heater off
+  void reset(float temperatureC);
+
+  // One sample: measured air temperature and the duty applied over the last sample
+  void update(float measuredC, float duty);
+
+  float getAir() const { return airC; }
+  float getBoard() const { return boardC; }
+  // How far the board is behind the air
+  float getLag() const { return airC - boardC; }
+
+  // Highest board temperature within the horizon if the heater is cut now
+  // (includes the heat already on its way through the dead time)
+  float predictBoardPeak(float horizonS) const;
+};
+
+#endif // BOARD_OBSERVER_H
@@ -0,0 +1,81 @@
+#ifndef CONTROL_CLOCK_H
+#define CONTROL_CLOCK_H
+
+#include <stdint.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+// Rollover-safe time comparisons on the wrapping 32-bit clocks, valid while
+// the two times are less than 2^31 apart (24 days in ms)
+inline bool timeReached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;
+}
+
+inline uint32_t timeElapsed(uint32_t now, uint32_t since) {
+  return now - since;
+}
+
+// Time source of the control path. The firmware uses ArduinoClock; tests,
+// simulations and replays step a VirtualClock instead.
+class ControlClock {
+public:
+  virtual ~ControlClock() {}
+  virtual uint32_t nowMs() = 0;
+  virtual uint32_t nowUs() = 0;
+};
+
+// Deterministic clock advanced by its owner. Milliseconds and microseconds
+// wrap like millis() and micros(), so a clock started just below the wrap
+// exercises the rollover.
+class VirtualClock : public ControlClock {
+private:
+  uint64_t us;
+
+public:
+  VirtualClock(uint32_t startMs = 0) : us((uint64_t)startMs * 1000ULL) {}
+
+  uint32_t nowMs() override { return (uint32_t)(us / 1000ULL); }
+  uint32_t nowUs() override { return (uint32_t)us; }
+
+  void setMs(uint32_t ms) { us = (uint64_t)ms * 1000ULL; }
+  void advanceMs(uint32_t ms) { us += (uint64_t)ms * 1000ULL; }
+  void advanceUs(uint32_t deltaUs) { us += deltaUs; }
+};
+
+#if defined(ARDUINO)
+class ArduinoClock : public ControlClock {
+public:
+  uint32_t nowMs() override { return millis(); }
+  uint32_t nowUs() override { return micros(); }
+};
+#endif
+
+// Fixed-rate schedule on a millisecond clock. A late caller catches up one
+// period per call, so the number of periods run matches the elapsed time.
+class PeriodicTimer {
+private:
+  uint32_t nextMs;
+  uint32_t periodMs;
+
+public:
+  PeriodicTimer() : nextMs(0), periodMs(1000) {}
+
+  // First period due at nowMs + offsetMs
+  void start(uint32_t nowMs, uint32_t periodMs, uint32_t offsetMs = 0) {
+    this->periodMs = periodMs;
+    nextMs = nowMs + offsetMs;
+  }
+
+  // True once per elapsed period
+  bool due(uint32_t nowMs) {
+    if (!timeReached(nowMs, nextMs)) return false;
+    nextMs += periodMs;
+    return true;
+  }
+
+  uint32_t getNext() const { return nextMs; }
+  uint32_t getPeriod() const { return periodMs; }
+};
+
+#endif // CONTROL_CLOCK_H
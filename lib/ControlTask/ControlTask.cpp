@@ -0,0 +1,92 @@
+#include "ControlTask.h"
+
+ControlTask::ControlTask(void (*tick)(), uint32_t periodMs, BaseType_t core, UBaseType_t priority)
+  : tickFunction(tick), periodMs(periodMs), core(core), priority(priority), handle(nullptr) {
+  statsMux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&stats, 0, sizeof(stats));
+}
+
+bool ControlTask::begin(uint32_t stackSize) {
+  if (handle != nullptr) {
+    return true;
+  }
+  BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "control", stackSize, this, priority, &handle, core);
+  if (result != pdPASS) {
+    handle = nullptr;
+    Serial.println("Control task creation failed");
+    return false;
+  }
+  return true;
+}
+
+void ControlTask::stop() {
+  if (handle != nullptr) {
+    TaskHandle_t task = handle;
+    handle = nullptr;
+    vTaskDelete(task);
+  }
+}
+
+void ControlTask::taskEntry(void* arg) {
+  static_cast<ControlTask*>(arg)->run();
+}
+
+void ControlTask::run() {
+  const TickType_t periodTicks = pdMS_TO_TICKS(periodMs);
+  const int64_t periodUs = (int64_t)periodMs * 1000;
+  TickType_t lastWake = xTaskGetTickCount();
+  int64_t releaseUs = esp_timer_get_time();
+
+  for (;;) {
+    int64_t startUs = esp_timer_get_time();
+    tickFunction();
+    int64_t endUs = esp_timer_get_time();
+
+    uint32_t execUs = (uint32_t)(endUs - startUs);
+    uint32_t jitterUs = startUs > releaseUs ? (uint32_t)(startUs - releaseUs) : 0;
+    bool missed = endUs > releaseUs + periodUs;
+
+    portENTER_CRITICAL(&statsMux);
+    stats.ticks++;
+    stats.lastExecUs = execUs;
+    if (execUs > stats.maxExecUs) stats.maxExecUs = execUs;
+    if (jitterUs > stats.maxJitterUs) stats.maxJitterUs = jitterUs;
+    if (missed) stats.deadlineMisses++;
+    portEXIT_CRITICAL(&statsMux);
+
+    releaseUs += periodUs;
+    if (xTaskDelayUntil(&lastWake, periodTicks) == pdFALSE) {
+      // Release time already passed: drop the missed slots and restart the schedule
+      lastWake = xTaskGetTickCount();
+      releaseUs = esp_timer_get_time();
+    }
+  }
+}
+
+ControlTaskStats ControlTask::getStats() {
+  ControlTaskStats copy;
+  portENTER_CRITICAL(&statsMux);
+  copy = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+void ControlTask::resetStats() {
+  portENTER_CRITICAL(&statsMux);
+  memset(&stats, 0, sizeof(stats));
+  portEXIT_CRITICAL(&statsMux);
+}
+
+uint32_t ControlTask::getStackHighWaterMark() const {
+  // ESP-IDF reports the stack in bytes
+  return handle != nullptr ? uxTaskGetStackHighWaterMark(handle) : 0;
+}
+
+void ControlTask::printStats() {
+  ControlTaskStats s = getStats();
+  Serial.println("Control task: " + String(s.ticks) + " ticks, "
+                 + String(s.deadlineMisses) + " deadline misses, max exec "
+                 + String(s.maxExecUs) + " us, max jitter "
+                 + String(s.maxJitterUs) + " us, stack free "
+                 + String(getStackHighWaterMark()) + " bytes");
+}
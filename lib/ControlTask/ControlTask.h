@@ -0,0 +1,51 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#include <Arduino.h>
+
+// Timing statistics collected by the control task
+struct ControlTaskStats {
+  uint32_t ticks;            // Number of completed control ticks
+  uint32_t deadlineMisses;   // Ticks that finished after the next release time
+  uint32_t lastExecUs;       // Execution time of the last tick
+  uint32_t maxExecUs;        // Worst execution time seen
+  uint32_t maxJitterUs;      // Worst release latency relative to the ideal schedule
+};
+
+// Fixed-rate FreeRTOS task pinned to one core. The tick function is released
+// every periodMs with vTaskDelayUntil semantics; overruns are counted and the
+// schedule is re-synchronised instead of bursting to catch up.
+class ControlTask {
+private:
+  void (*tickFunction)();
+  uint32_t periodMs;
+  BaseType_t core;
+  UBaseType_t priority;
+  TaskHandle_t handle;
+  portMUX_TYPE statsMux;
+  ControlTaskStats stats;
+
+  static void taskEntry(void* arg);
+  void run();
+
+public:
+  ControlTask(void (*tick)(), uint32_t periodMs, BaseType_t core, UBaseType_t priority);
+
+  // Create the pinned task, returns false if FreeRTOS could not allocate it
+  bool begin(uint32_t stackSize = 8192);
+
+  // Delete the task
+  void stop();
+
+  bool isRunning() const { return handle != nullptr; }
+  uint32_t getPeriodMs() const { return periodMs; }
+
+  // Statistics (safe to call from any core)
+  ControlTaskStats getStats();
+  // Least free stack (bytes) the task has had since it started, 0 if not running
+  uint32_t getStackHighWaterMark() const;
+  void resetStats();
+  void printStats();
+};
+
+#endif // CONTROL_TASK_H
@@ -0,0 +1,210 @@
+#include "FaultEngine.h"
+
+FaultEngine::FaultEngine(const FaultConfig& config) : config(config) {
+  clear();
+}
+
+FaultConfig FaultEngine::defaultConfig() {
+  FaultConfig c;
+  c.minPlausibleC = -20.0f;
+  c.maxPlausibleC = 500.0f;
+  c.overTemperatureC = 260.0f;
+  c.staleMs = 2000;
+  c.sensorDebounce = 3;
+  c.jumpC = 10.0f;
+  c.jumpConfirm = 3;
+  c.flatlineMs = 30000;
+  c.flatlineBandC = 0.05f;
+  c.flatlineMinDuty = 0.6f;
+  c.heatingWindowMs = 30000;
+  c.heatingFullDuty = 0.95f;
+  c.heatingMinRiseC = 5.0f;
+  c.stuckGraceMs = 30000;
+  c.stuckCoastC = 10.0f;
+  c.stuckRiseC = 5.0f;
+  return c;
+}
+
+void FaultEngine::clear() {
+  fault = FAULT_NONE;
+  faultMs = 0;
+  faultTemperatureC = 0.0f;
+  haveSample = false;
+  clockStarted = false;
+  lastValidMs = 0;
+  lastSampleC = 0.0f;
+  openCount = 0;
+  shortCount = 0;
+  jumpPending = false;
+  jumpFromC = 0.0f;
+  jumpCount = 0;
+  flatArmed = false;
+  flatSinceMs = 0;
+  flatMinC = 0.0f;
+  flatMaxC = 0.0f;
+  duty = 0.0f;
+  heatingArmed = false;
+  heatingSinceMs = 0;
+  heatingStartC = 0.0f;
+  offArmed = false;
+  offSinceMs = 0;
+  offMinC = 0.0f;
+  offSettled = false;
+  offWindowMs = 0;
+}
+
+void FaultEngine::latch(FaultCode code, uint32_t nowMs, float temperatureC) {
+  if (fault != FAULT_NONE) return;
+  fault = code;
+  faultMs = nowMs;
+  faultTemperatureC = temperatureC;
+}
+
+void FaultEngine::addSample(uint32_t nowMs, float temperatureC, bool valid, bool openCircuit, bool shortCircuit) {
+  openCount = openCircuit ? (openCount < 255 ? openCount + 1 : 255) : 0;
+  shortCount = shortCircuit ? (shortCount < 255 ? shortCount + 1 : 255) : 0;
+  if (openCount >= config.sensorDebounce) latch(FAULT_SENSOR_OPEN, nowMs, lastSampleC);
+  if (shortCount >= config.sensorDebounce) latch(FAULT_SENSOR_SHORT, nowMs, lastSampleC);
+  if (!valid || openCircuit || shortCircuit) return;
+
+  // Written so that a NaN reading fails it too
+  if (!(temperatureC >= config.minPlausibleC && temperatureC <= config.maxPlausibleC)) {
+    latch(FAULT_SENSOR_RANGE, nowMs, temperatureC);
+    return;
+  }
+  lastValidMs = nowMs;
+
+  if (!haveSample) {
+    haveSample = true;
+    lastSampleC = temperatureC;
+    flatArmed = false;
+    return;
+  }
+
+  // Jump: the new level has to persist, a single spike is the filter's job
+  if (jumpPending) {
+    float fromStart = temperatureC - jumpFromC;
+    if (fromStart > config.jumpC || fromStart < -config.jumpC) {
+      if (++jumpCount >= config.jumpConfirm) latch(FAULT_SENSOR_JUMP, nowMs, temperatureC);
+    } else {
+      jumpPending = false;
+    }
+  } else {
+    float step = temperatureC - lastSampleC;
+    if (step > config.jumpC || step < -config.jumpC) {
+      jumpPending = true;
+      jumpFromC = lastSampleC;
+      jumpCount = 1;
+      if (jumpCount >= config.jumpConfirm) latch(FAULT_SENSOR_JUMP, nowMs, temperatureC);
+    }
+  }
+
+  // Flat line: the reading never leaves a narrow band while the heater drives the oven
+  if (duty < config.flatlineMinDuty) {
+    flatArmed = false;
+  } else {
+    float low = flatArmed && flatMinC < temperatureC ? flatMinC : temperatureC;
+    float high = flatArmed && flatMaxC > temperatureC ? flatMaxC : temperatureC;
+    if (!flatArmed || high - low > config.flatlineBandC) {
+      flatArmed = true;
+      flatSinceMs = nowMs;
+      flatMinC = temperatureC;
+      flatMaxC = temperatureC;
+    } else {
+      flatMinC = low;
+      flatMaxC = high;
+      if (nowMs - flatSinceMs >= config.flatlineMs) latch(FAULT_SENSOR_FLATLINE, nowMs, temperatureC);
+    }
+  }
+  lastSampleC = temperatureC;
+}
+
+void FaultEngine::update(uint32_t nowMs, float temperatureC, float duty) {
+  this->duty = duty;
+
+  // Staleness, measured from the last valid conversion (or the first update)
+  if (!clockStarted) {
+    clockStarted = true;
+    if (!haveSample) lastValidMs = nowMs;
+  }
+  if (nowMs - lastValidMs >= config.staleMs) {
+    latch(FAULT_SENSOR_STALE, nowMs, temperatureC);
+  }
+  if (!haveSample) return;
+
+  if (temperatureC > config.overTemperatureC) {
+    latch(FAULT_OVER_TEMPERATURE, nowMs, temperatureC);
+  }
+
+  // Full duty has to heat the oven: restart the window whenever it made the rise
+  if (duty >= config.heatingFullDuty) {
+    if (!heatingArmed) {
+      heatingArmed = true;
+      heatingSinceMs = nowMs;
+      heatingStartC = temperatureC;
+    } else if (temperatureC - heatingStartC >= config.heatingMinRiseC) {
+      heatingSinceMs = nowMs;
+      heatingStartC = temperatureC;
+    } else if (nowMs - heatingSinceMs >= config.heatingWindowMs) {
+      latch(FAULT_HEATING_TOO_SLOW, nowMs, temperatureC);
+    }
+  } else {
+    heatingArmed = false;
+  }
+
+  // SSR off: after the grace period the oven may only cool
+  if (duty <= 0.0f) {
+    if (!offArmed) {
+      offArmed = true;
+      offSinceMs = nowMs;
+      offMinC = temperatureC;
+      offSettled = false;
+    } else if (nowMs - offSinceMs < config.stuckGraceMs) {
+      // Elements and walls still coast the oven up, but only so far
+      if (temperatureC - offMinC > config.stuckCoastC) latch(FAULT_STUCK_RELAY, nowMs, temperatureC);
+    } else if (!offSettled || nowMs - offWindowMs >= config.stuckGraceMs) {
+      // Rolling windows, so a slow drift of the room is never mistaken for the heater
+      offSettled = true;
+      offWindowMs = nowMs;
+      offMinC = temperatureC;
+    } else {
+      if (temperatureC < offMinC) offMinC = temperatureC;
+      if (temperatureC - offMinC > config.stuckRiseC) latch(FAULT_STUCK_RELAY, nowMs, temperatureC);
+    }
+  } else {
+    offArmed = false;
+  }
+}
+
+bool FaultEngine::isRecoverable() const {
+  switch (fault) {
+    case FAULT_SENSOR_OPEN:
+    case FAULT_SENSOR_SHORT:
+    case FAULT_SENSOR_STALE:
+    case FAULT_SENSOR_RANGE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool FaultEngine::isSensorHealthy(uint32_t nowMs) const {
+  return haveSample && openCount == 0 && shortCount == 0 && nowMs - lastValidMs < config.staleMs;
+}
+
+const char* FaultEngine::faultName(FaultCode code) {
+  switch (code) {
+    case FAULT_NONE: return "None";
+    case FAULT_SENSOR_OPEN: return "TC open";
+    case FAULT_SENSOR_SHORT: return "TC short";
+    case FAULT_SENSOR_STALE: return "TC no data";
+    case FAULT_SENSOR_RANGE: return "TC range";
+    case FAULT_SENSOR_JUMP: return "TC jump";
+    case FAULT_SENSOR_FLATLINE: return "TC flat";
+    case FAULT_HEATING_TOO_SLOW: return "No heating";
+    case FAULT_STUCK_RELAY: return "SSR stuck";
+    case FAULT_OVER_TEMPERATURE: return "Over temp";
+    case FAULT_HARDWARE_CUTOFF: return "HW cutoff";
+  }
+  return "?";
+}
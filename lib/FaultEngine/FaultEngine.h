@@ -0,0 +1,114 @@
+#ifndef FAULT_ENGINE_H
+#define FAULT_ENGINE_H
+
+#include <stdint.h>
+
+// Latched cause of a fault, the first detected one wins
+enum FaultCode {
+  FAULT_NONE,
+  FAULT_SENSOR_OPEN,          // Thermocouple open (MCP9600 input range)
+  FAULT_SENSOR_SHORT,         // Thermocouple shorted (MCP9601 short-circuit flag)
+  FAULT_SENSOR_STALE,         // No valid conversion for staleMs (bus error, stuck converter)
+  FAULT_SENSOR_RANGE,         // Reading outside the plausible range
+  FAULT_SENSOR_JUMP,          // Step between consecutive samples no oven can make, confirmed
+  FAULT_SENSOR_FLATLINE,      // Reading frozen while the heater is driving the oven
+  FAULT_HEATING_TOO_SLOW,     // Full duty without the expected rise: heater or SSR open
+  FAULT_STUCK_RELAY,          // Temperature rising with the SSR off: SSR shorted
+  FAULT_OVER_TEMPERATURE,     // Above the software limit
+  FAULT_HARDWARE_CUTOFF       // Raised by the owner: the sensor's own alert output cut the heater
+};
+
+struct FaultConfig {
+  float minPlausibleC;        // Sensor range check
+  float maxPlausibleC;
+  float overTemperatureC;     // Software over-temperature limit
+  uint32_t staleMs;
+  uint8_t sensorDebounce;     // Consecutive open/short samples before latching
+  float jumpC;                // Step between consecutive valid samples
+  uint8_t jumpConfirm;        // Samples the new level must persist (single spikes are ignored)
+  uint32_t flatlineMs;
+  float flatlineBandC;        // Frozen: the reading stays inside this band
+  float flatlineMinDuty;      // Only while the heater is at least this much on
+  uint32_t heatingWindowMs;
+  float heatingFullDuty;      // Duty counted as full power
+  float heatingMinRiseC;      // Expected rise over the window at full power
+  uint32_t stuckGraceMs;      // Heat still arriving after the SSR turned off
+  float stuckCoastC;          // Largest rise allowed during the grace period
+  float stuckRiseC;           // Rise above the minimum within one grace period after it
+};
+
+// Thermal-runaway and sensor-plausibility checks. Raw conversions go through
+// addSample() (open/short, range, jumps, flat line), the control tick calls
+// update() with the filtered temperature and the commanded duty (staleness,
+// heating rate at full duty, rise with the SSR off, over-temperature). Both
+// are O(1) and rollover-safe on the millisecond clock. The first fault is
+// latched with its time and temperature; the owner forces the SSR off while
+// isFaulted() is true.
+class FaultEngine {
+private:
+  FaultConfig config;
+  FaultCode fault;
+  uint32_t faultMs;
+  float faultTemperatureC;
+
+  // Sensor checks
+  bool haveSample;
+  bool clockStarted;
+  uint32_t lastValidMs;
+  float lastSampleC;
+  uint8_t openCount;
+  uint8_t shortCount;
+  bool jumpPending;
+  float jumpFromC;
+  uint8_t jumpCount;
+  uint32_t flatSinceMs;
+  float flatMinC;
+  float flatMaxC;
+  bool flatArmed;
+
+  // Thermal checks
+  float duty;
+  bool heatingArmed;
+  uint32_t heatingSinceMs;
+  float heatingStartC;
+  bool offArmed;
+  uint32_t offSinceMs;
+  float offMinC;
+  bool offSettled;
+  uint32_t offWindowMs;
+
+  void latch(FaultCode code, uint32_t nowMs, float temperatureC);
+
+public:
+  FaultEngine(const FaultConfig& config);
+
+  static FaultConfig defaultConfig();
+  void setConfig(const FaultConfig& config) { this->config = config; }
+
+  // Every conversion from the thermocouple
+  void addSample(uint32_t nowMs, float temperatureC, bool valid, bool openCircuit, bool shortCircuit);
+
+  // Every control tick: filtered temperature and the SSR duty commanded (0 - 1)
+  void update(uint32_t nowMs, float temperatureC, float duty);
+
+  // Latch a fault detected outside the engine
+  void raise(FaultCode code, uint32_t nowMs, float temperatureC) { latch(code, nowMs, temperatureC); }
+
+  bool isFaulted() const { return fault != FAULT_NONE; }
+  FaultCode getFault() const { return fault; }
+  uint32_t getFaultTime() const { return faultMs; }
+  float getFaultTemperature() const { return faultTemperatureC; }
+
+  // Sensor faults may clear once the sensor is healthy again; thermal faults
+  // (heater, relay, over-temperature) stay latched until reset
+  bool isRecoverable() const;
+  // Valid conversions are arriving and none is open or shorted
+  bool isSensorHealthy(uint32_t nowMs) const;
+
+  // Clear the latch and restart every check
+  void clear();
+
+  static const char* faultName(FaultCode code);
+};
+
+#endif // FAULT_ENGINE_H
@@ -0,0 +1,123 @@
+#include "FaultInjector.h"
+#include <math.h>
+#include <string.h>
+#include "ControlClock.h"
+
+FaultInjector::FaultInjector(OvenSimulator& oven) : oven(oven), eventCount(0), startMs(0), noiseState(1) {
+  begin(0);
+}
+
+void FaultInjector::setScript(const FaultEvent* events, uint8_t count) {
+  eventCount = count < FAULT_INJECTOR_EVENTS ? count : FAULT_INJECTOR_EVENTS;
+  memcpy(this->events, events, eventCount * sizeof(FaultEvent));
+}
+
+void FaultInjector::begin(uint32_t nowMs) {
+  startMs = nowMs;
+  noiseState = 1;
+  lastFault = FAULT_NONE;
+  for (uint8_t i = 0; i < FAULT_INJECTOR_EVENTS; i++) {
+    reports[i].injectedMs = 0;
+    reports[i].injected = false;
+    reports[i].detected = FAULT_NONE;
+    reports[i].detectMs = -1;
+    reports[i].ssrOffMs = -1;
+    stuckC[i] = 0.0f;
+  }
+}
+
+bool FaultInjector::isActive(uint8_t event, uint32_t nowMs) const {
+  const FaultEvent& e = events[event];
+  uint32_t fromMs = startMs + e.atMs;
+  if (!timeReached(nowMs, fromMs)) return false;
+  return e.durationMs == 0 || !timeReached(nowMs, fromMs + e.durationMs);
+}
+
+bool FaultInjector::activate(uint8_t event, uint32_t nowMs) {
+  bool active = isActive(event, nowMs);
+  FaultInjectionReport& report = reports[event];
+  if (active && !report.injected) {
+    report.injected = true;
+    report.injectedMs = startMs + events[event].atMs;
+    // The converter freezes on the reading it had
+    stuckC[event] = oven.getSensorTemperature();
+  }
+  return active;
+}
+
+float FaultInjector::gaussian() {
+  float sum = 0.0f;
+  for (int i = 0; i < 4; i++) {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    sum += (noiseState >> 8) * (1.0f / 16777216.0f);
+  }
+  return (sum - 2.0f) * 1.7320508f;
+}
+
+bool FaultInjector::readSensor(uint32_t nowMs, float* temperatureC) {
+  float reading = oven.getSensorTemperature();
+  for (uint8_t i = 0; i < eventCount; i++) {
+    if (!activate(i, nowMs)) continue;
+    switch (events[i].fault) {
+      case INJECT_I2C_FAILURE:   return false;
+      case INJECT_READING_VALUE: reading = events[i].magnitude; break;
+      case INJECT_READING_NAN:   reading = NAN; break;
+      case INJECT_STUCK_VALUE:   reading = stuckC[i]; break;
+      case INJECT_NOISE_BURST:   reading += events[i].magnitude * gaussian(); break;
+      default:                   break;
+    }
+  }
+  *temperatureC = reading;
+  return true;
+}
+
+float FaultInjector::heaterFraction(uint32_t nowMs, float ssrFraction) {
+  float fraction = ssrFraction;
+  for (uint8_t i = 0; i < eventCount; i++) {
+    if (!activate(i, nowMs)) continue;
+    switch (events[i].fault) {
+      case INJECT_SSR_STUCK_ON:     fraction = 1.0f; break;
+      case INJECT_SSR_STUCK_OFF:    fraction = 0.0f; break;
+      case INJECT_HEATER_DEGRADED:  fraction *= events[i].magnitude; break;
+      default:                      break;
+    }
+  }
+  return fraction;
+}
+
+void FaultInjector::step(uint32_t nowMs, float ssrFraction, float dtS) {
+  oven.step(heaterFraction(nowMs, ssrFraction), dtS);
+}
+
+void FaultInjector::observe(uint32_t nowMs, FaultCode fault, bool ssrPin) {
+  bool latched = fault != FAULT_NONE && lastFault == FAULT_NONE;
+  lastFault = fault;
+  for (uint8_t i = 0; i < eventCount; i++) {
+    bool active = activate(i, nowMs);
+    FaultInjectionReport& report = reports[i];
+    if (!report.injected) continue;
+    if (latched && active) {
+      report.detected = fault;
+      report.detectMs = (int32_t)timeElapsed(nowMs, report.injectedMs);
+    }
+    if (report.detected != FAULT_NONE && report.ssrOffMs < 0 && !ssrPin) {
+      report.ssrOffMs = (int32_t)timeElapsed(nowMs, report.injectedMs);
+    }
+  }
+}
+
+const char* FaultInjector::faultName(InjectedFault fault) {
+  switch (fault) {
+    case INJECT_I2C_FAILURE:     return "I2C failure";
+    case INJECT_READING_VALUE:   return "Bad reading";
+    case INJECT_READING_NAN:     return "NaN reading";
+    case INJECT_STUCK_VALUE:     return "Stuck reading";
+    case INJECT_NOISE_BURST:     return "Noise burst";
+    case INJECT_SSR_STUCK_ON:    return "SSR stuck on";
+    case INJECT_SSR_STUCK_OFF:   return "SSR stuck off";
+    case INJECT_HEATER_DEGRADED: return "Heater degraded";
+    default:                     return "?";
+  }
+}
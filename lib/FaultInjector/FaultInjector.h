@@ -0,0 +1,88 @@
+#ifndef FAULT_INJECTOR_H
+#define FAULT_INJECTOR_H
+
+#include <stdint.h>
+#include "OvenSimulator.h"
+#include "FaultEngine.h"
+
+// Faults the injector can put on the simulated sensor and SSR paths
+enum InjectedFault {
+  INJECT_I2C_FAILURE,       // Bus error: the read fails, no conversion arrives
+  INJECT_READING_VALUE,     // The converter returns magnitude (e.g. -999) as a good reading
+  INJECT_READING_NAN,       // The converter returns NaN as a good reading
+  INJECT_STUCK_VALUE,       // The converter keeps returning the reading at the injection
+  INJECT_NOISE_BURST,       // Gaussian noise of magnitude C standard deviation on the reading
+  INJECT_SSR_STUCK_ON,      // Heater on whatever SSR_PIN says
+  INJECT_SSR_STUCK_OFF,     // Heater off whatever SSR_PIN says
+  INJECT_HEATER_DEGRADED,   // Heater power scaled by magnitude (0 - 1)
+  INJECT_FAULT_COUNT
+};
+
+// One scripted fault, times from begin()
+struct FaultEvent {
+  InjectedFault fault;
+  uint32_t atMs;
+  uint32_t durationMs;      // 0 = until the end of the run
+  float magnitude;          // Reading, noise (C) or heater power fraction
+};
+
+// What the firmware made of an event
+struct FaultInjectionReport {
+  uint32_t injectedMs;      // Absolute time the event started
+  bool injected;
+  FaultCode detected;       // Fault latched while the event was active
+  int32_t detectMs;         // Injection to the latch, -1 if never
+  int32_t ssrOffMs;         // Injection to SSR_PIN low with the fault latched, -1 if never
+};
+
+#define FAULT_INJECTOR_EVENTS 8
+
+// Scripted fault injection between the oven simulator and the firmware's
+// sensor and SSR paths. The harness reads the thermocouple through
+// readSensor(), drives the heater through step() with the SSR_PIN level and
+// reports the fault latch and the pin every tick through observe().
+//
+// A latch is attributed to the events active when it happens; a glitch that
+// ended without one is reported as ridden through.
+class FaultInjector {
+private:
+  OvenSimulator& oven;
+  FaultEvent events[FAULT_INJECTOR_EVENTS];
+  uint8_t eventCount;
+  FaultInjectionReport reports[FAULT_INJECTOR_EVENTS];
+  float stuckC[FAULT_INJECTOR_EVENTS];
+  uint32_t startMs;
+  uint32_t noiseState;
+  FaultCode lastFault;
+
+  bool isActive(uint8_t event, uint32_t nowMs) const;
+  // Marks events that started by nowMs; true if the event is active
+  bool activate(uint8_t event, uint32_t nowMs);
+  float gaussian();
+
+public:
+  FaultInjector(OvenSimulator& oven);
+
+  // Copies up to FAULT_INJECTOR_EVENTS events
+  void setScript(const FaultEvent* events, uint8_t count);
+  void begin(uint32_t nowMs);
+
+  // One thermocouple conversion: false on a bus error, otherwise the reading
+  // as the converter would report it
+  bool readSensor(uint32_t nowMs, float* temperatureC);
+
+  // Heater fraction the oven receives for the SSR_PIN level
+  float heaterFraction(uint32_t nowMs, float ssrFraction);
+  void step(uint32_t nowMs, float ssrFraction, float dtS);
+
+  // Every tick: the latched fault and the SSR_PIN level
+  void observe(uint32_t nowMs, FaultCode fault, bool ssrPin);
+
+  uint8_t getEventCount() const { return eventCount; }
+  const FaultEvent& getEvent(uint8_t event) const { return events[event]; }
+  const FaultInjectionReport& getReport(uint8_t event) const { return reports[event]; }
+
+  static const char* faultName(InjectedFault fault);
+};
+
+#endif // FAULT_INJECTOR_H
@@ -0,0 +1,78 @@
+#include "GainSchedule.h"
+#include <string.h>
+
+GainSchedule::GainSchedule() : points(nullptr), count(0) {
+}
+
+void GainSchedule::setTable(const GainPoint* points, uint8_t count) {
+  this->points = points;
+  this->count = points ? count : 0;
+}
+
+bool GainSchedule::lookup(float temperatureC, uint8_t phase, PIDGains* gains) const {
+  if (phase != GAIN_PHASE_ANY && lookupPhase(temperatureC, phase, gains)) {
+    return true;
+  }
+  return lookupPhase(temperatureC, GAIN_PHASE_ANY, gains);
+}
+
+uint8_t GainSchedule::merge(GainPoint* points, uint8_t count, const GainPoint& point, bool* stored) {
+  *stored = true;
+  for (uint8_t i = 0; i < count; i++) {
+    if (points[i].temperature == point.temperature && points[i].phase == point.phase) {
+      points[i] = point;
+      return count;
+    }
+  }
+  if (count >= GAIN_SCHEDULE_SIZE) {
+    *stored = false;
+    return count;
+  }
+  points[count] = point;
+  return count + 1;
+}
+
+bool GainSchedule::lookupPhase(float temperatureC, uint8_t phase, PIDGains* gains) const {
+  const GainPoint* below = nullptr;
+  const GainPoint* above = nullptr;
+  for (uint8_t i = 0; i < count; i++) {
+    const GainPoint& p = points[i];
+    if (p.phase != phase) continue;
+    if (p.temperature <= temperatureC) {
+      if (!below || p.temperature > below->temperature) below = &p;
+    } else {
+      if (!above || p.temperature < above->temperature) above = &p;
+    }
+  }
+
+  if (!below && !above) return false;
+  if (!below) {
+    *gains = above->gains;
+  } else if (!above) {
+    *gains = below->gains;
+  } else {
+    float f = (temperatureC - below->temperature) / (float)(above->temperature - below->temperature);
+    gains->kp = below->gains.kp + f * (above->gains.kp - below->gains.kp);
+    gains->ki = below->gains.ki + f * (above->gains.ki - below->gains.ki);
+    gains->kd = below->gains.kd + f * (above->gains.kd - below->gains.kd);
+  }
+  return true;
+}
+
+const char* GainSchedule::phaseName(uint8_t phase) {
+  switch (phase) {
+    case GAIN_PHASE_PREHEAT: return "preheat";
+    case GAIN_PHASE_SOAK:    return "soak";
+    case GAIN_PHASE_REFLOW:  return "reflow";
+    case GAIN_PHASE_COOL:    return "cool";
+  }
+  return "any";
+}
+
+uint8_t GainSchedule::phaseFromName(const char* name) {
+  if (!name) return GAIN_PHASE_ANY;
+  for (uint8_t phase = GAIN_PHASE_PREHEAT; phase <= GAIN_PHASE_COOL; phase++) {
+    if (strcmp(name, phaseName(phase)) == 0) return phase;
+  }
+  return GAIN_PHASE_ANY;
+}
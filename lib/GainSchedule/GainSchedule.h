@@ -0,0 +1,62 @@
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <stdint.h>
+#include "PIDController.h"
+
+// Table entries stored with each profile
+#define GAIN_SCHEDULE_SIZE 6
+
+// Phase a table entry applies to; GAIN_PHASE_ANY entries cover every phase
+enum GainPhase {
+  GAIN_PHASE_ANY,
+  GAIN_PHASE_PREHEAT,
+  GAIN_PHASE_SOAK,
+  GAIN_PHASE_REFLOW,
+  GAIN_PHASE_COOL
+};
+
+// One operating point of the schedule. Kept flat so it can be stored as bytes
+// inside profile_t.
+struct GainPoint {
+  uint16_t temperature;   // Operating temperature in C
+  uint8_t phase;          // GainPhase
+  PIDGains gains;
+};
+
+// Gain scheduling on the measured temperature. The gains are linearly
+// interpolated between the two entries around the temperature and held
+// constant outside the table. Entries for the current phase take precedence
+// over GAIN_PHASE_ANY entries. The table does not need to be sorted; a lookup
+// is one pass over at most GAIN_SCHEDULE_SIZE entries.
+class GainSchedule {
+private:
+  const GainPoint* points;
+  uint8_t count;
+
+  bool lookupPhase(float temperatureC, uint8_t phase, PIDGains* gains) const;
+
+public:
+  GainSchedule();
+
+  // The table is referenced, not copied
+  void setTable(const GainPoint* points, uint8_t count);
+
+  bool isEmpty() const { return count == 0; }
+  uint8_t size() const { return count; }
+
+  // Gains at the temperature, false if no entry applies
+  bool lookup(float temperatureC, uint8_t phase, PIDGains* gains) const;
+
+  // Puts an operating point into a table of capacity GAIN_SCHEDULE_SIZE:
+  // replaces the entry with the same temperature and phase, or appends it.
+  // Other entries are kept. Returns the new count, false in *stored when the
+  // table is full
+  static uint8_t merge(GainPoint* points, uint8_t count, const GainPoint& point, bool* stored);
+
+  static const char* phaseName(uint8_t phase);
+  // GAIN_PHASE_ANY for unknown names
+  static uint8_t phaseFromName(const char* name);
+};
+
+#endif // GAIN_SCHEDULE_H
@@ -0,0 +1,131 @@
+#include "IterativeLearning.h"
+#include <math.h>
+
+IterativeLearning::IterativeLearning(const ILCConfig& config) : config(config), recording(false) {
+  clear();
+}
+
+ILCConfig IterativeLearning::defaultConfig(float proportionalDutyPerC) {
+  ILCConfig c;
+  c.binS = 2.0f;
+  // The error left by the feedback loop is already divided down by the PID, so
+  // the learning gain scales with Kp rather than with the plant's inverse gain
+  c.learningGain = 0.5f * proportionalDutyPerC;
+  c.leadS = 6.0f;
+  c.forgetting = 0.99f;
+  c.limit = 0.3f;
+  return c;
+}
+
+void IterativeLearning::setConfig(const ILCConfig& config) {
+  this->config = config;
+}
+
+void IterativeLearning::clear() {
+  store.version = ILC_STORE_VERSION;
+  store.runs = 0;
+  store.bins = 0;
+  store.binS = config.binS;
+  for (int i = 0; i < ILC_MAX_BINS; i++) store.correction[i] = 0;
+  discardRun();
+}
+
+void IterativeLearning::load(const ILCStore* stored) {
+  if (stored && stored->version == ILC_STORE_VERSION && stored->bins <= ILC_MAX_BINS) {
+    store = *stored;
+  } else {
+    clear();
+  }
+  discardRun();
+}
+
+void IterativeLearning::begin(float durationS) {
+  int bins = (int)ceilf(durationS / config.binS);
+  if (bins < 1) bins = 1;
+  if (bins > ILC_MAX_BINS) bins = ILC_MAX_BINS;
+  if (bins != store.bins || store.binS != config.binS) {
+    // Different trajectory: what was learned no longer lines up
+    clear();
+    store.bins = (uint8_t)bins;
+  }
+  discardRun();
+  recording = true;
+}
+
+int IterativeLearning::binAt(float timeS) const {
+  if (store.bins == 0 || timeS < 0.0f) return -1;
+  int bin = (int)(timeS / store.binS);
+  return bin < store.bins ? bin : -1;
+}
+
+float IterativeLearning::correctionAt(float timeS) const {
+  if (store.bins == 0 || store.runs == 0) return 0.0f;
+  // Bin centers at (i + 0.5) * binS
+  float x = timeS / store.binS - 0.5f;
+  if (x <= 0.0f) return store.correction[0] / (float)ILC_SCALE;
+  int i = (int)x;
+  if (i >= store.bins - 1) return store.correction[store.bins - 1] / (float)ILC_SCALE;
+  float f = x - i;
+  return ((1.0f - f) * store.correction[i] + f * store.correction[i + 1]) / ILC_SCALE;
+}
+
+void IterativeLearning::record(float timeS, float errorC) {
+  if (!recording) return;
+  int bin = binAt(timeS);
+  if (bin < 0) return;
+  errorSum[bin] += errorC;
+  errorCount[bin]++;
+}
+
+void IterativeLearning::discardRun() {
+  for (int i = 0; i < ILC_MAX_BINS; i++) {
+    errorSum[i] = 0.0f;
+    errorCount[i] = 0;
+  }
+  recording = false;
+}
+
+float IterativeLearning::getRunRmsError() const {
+  float sumSq = 0.0f;
+  int n = 0;
+  for (int i = 0; i < store.bins; i++) {
+    if (errorCount[i] == 0) continue;
+    float e = errorSum[i] / errorCount[i];
+    sumSq += e * e;
+    n++;
+  }
+  return n ? sqrtf(sumSq / n) : 0.0f;
+}
+
+bool IterativeLearning::finishRun() {
+  if (!recording) return false;
+  recording = false;
+  int bins = store.bins;
+  int lead = (int)(config.leadS / store.binS + 0.5f);
+
+  float updated[ILC_MAX_BINS];
+  bool any = false;
+  for (int i = 0; i < bins; i++) {
+    // The duty in bin i shows up in the error lead bins later
+    int j = i + lead < bins ? i + lead : bins - 1;
+    float error = 0.0f;
+    if (errorCount[j]) {
+      error = errorSum[j] / errorCount[j];
+      any = true;
+    }
+    updated[i] = config.forgetting * store.correction[i] / (float)ILC_SCALE + config.learningGain * error;
+  }
+  if (!any) return false;
+
+  // Q filter: zero-phase 1-2-1 smoothing keeps the update from amplifying noise
+  for (int i = 0; i < bins; i++) {
+    float left = updated[i > 0 ? i - 1 : i];
+    float right = updated[i + 1 < bins ? i + 1 : i];
+    float v = 0.25f * left + 0.5f * updated[i] + 0.25f * right;
+    if (v > config.limit) v = config.limit;
+    if (v < -config.limit) v = -config.limit;
+    store.correction[i] = (int16_t)lroundf(v * ILC_SCALE);
+  }
+  if (store.runs < 0xFFFF) store.runs++;
+  return true;
+}
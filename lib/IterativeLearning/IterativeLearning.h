@@ -0,0 +1,78 @@
+#ifndef ITERATIVE_LEARNING_H
+#define ITERATIVE_LEARNING_H
+
+#include <stdint.h>
+
+// Correction bins over the trajectory time
+#define ILC_MAX_BINS 128
+// Corrections are stored as duty * ILC_SCALE
+#define ILC_SCALE 10000
+#define ILC_STORE_VERSION 1
+
+struct ILCConfig {
+  float binS;               // Trajectory time per bin
+  float learningGain;       // Duty added per C of tracking error
+  float leadS;              // Error this far ahead is attributed to the bin (dead time)
+  float forgetting;         // Old correction kept per run (1 = no forgetting)
+  float limit;              // Largest correction (duty)
+};
+
+// Persistent part, written to NVS per profile
+struct ILCStore {
+  uint16_t version;
+  uint16_t runs;
+  uint8_t bins;
+  float binS;
+  int16_t correction[ILC_MAX_BINS];
+};
+
+// Iterative learning control over repeated runs of the same profile. The
+// tracking error of a run is averaged per trajectory time bin; when the run
+// completes, the feed-forward correction is updated with the error shifted by
+// the dead time (P-type ILC with lead), low-pass filtered with a zero-phase
+// 1-2-1 kernel (Q filter) and clamped. The next run adds the correction to the
+// feed-forward.
+class IterativeLearning {
+private:
+  ILCConfig config;
+  ILCStore store;
+  float errorSum[ILC_MAX_BINS];
+  uint16_t errorCount[ILC_MAX_BINS];
+  bool recording;
+
+  int binAt(float timeS) const;
+
+public:
+  IterativeLearning(const ILCConfig& config);
+
+  // Learning gain at half the PID's proportional gain (duty per C)
+  static ILCConfig defaultConfig(float proportionalDutyPerC);
+  void setConfig(const ILCConfig& config);
+
+  // Stored correction, or a cleared one if the blob does not fit
+  void load(const ILCStore* stored);
+  const ILCStore& getStore() const { return store; }
+  void clear();
+
+  // Start a run over a trajectory of the given duration; a different
+  // duration or bin size resets the learned correction
+  void begin(float durationS);
+
+  // Correction (duty, linear between bin centers) at the trajectory time
+  float correctionAt(float timeS) const;
+
+  // Tracking error (setpoint - measured) at the trajectory time
+  void record(float timeS, float errorC);
+
+  // Update the correction from the recorded run, false if nothing was recorded
+  bool finishRun();
+  // Drop the recorded run (aborted or faulted)
+  void discardRun();
+
+  uint16_t getRuns() const { return store.runs; }
+  bool isRecording() const { return recording; }
+  // RMS of the recorded run's bin errors
+  float getRunRmsError() const;
+};
+
+#endif // ITERATIVE_LEARNING_H
@@ -0,0 +1,54 @@
+#include "MCP9600Scheduler.h"
+
+MCP9600Scheduler::MCP9600Scheduler() : count(0), first(0), pollMs(10), task(nullptr) {
+  for (uint8_t i = 0; i < MCP9600_SCHEDULER_MAX_SENSORS; i++) {
+    sensors[i] = nullptr;
+  }
+}
+
+bool MCP9600Scheduler::add(MCP9600Sensor& sensor) {
+  if (task != nullptr || sensor.task != nullptr || count >= MCP9600_SCHEDULER_MAX_SENSORS) {
+    return false;
+  }
+  sensors[count++] = &sensor;
+  return true;
+}
+
+bool MCP9600Scheduler::start(uint32_t pollMs, BaseType_t core, UBaseType_t priority, UBaseType_t queueLength) {
+  if (task != nullptr) {
+    return true;
+  }
+  this->pollMs = pollMs;
+  for (uint8_t i = 0; i < count; i++) {
+    sensors[i]->pollMs = pollMs;
+    if (!sensors[i]->createQueues(queueLength)) {
+      return false;
+    }
+  }
+  if (xTaskCreatePinnedToCore(taskEntry, "mcp9600", 3072, this, priority, &task, core) != pdPASS) {
+    task = nullptr;
+    Serial.println("MCP9600 scheduler task creation failed");
+    return false;
+  }
+  // From here on alert changes go through the task
+  for (uint8_t i = 0; i < count; i++) {
+    sensors[i]->task = task;
+  }
+  return true;
+}
+
+void MCP9600Scheduler::pollAll() {
+  for (uint8_t n = 0; n < count; n++) {
+    sensors[(first + n) % count]->poll();
+  }
+  first = count > 0 ? (first + 1) % count : 0;
+}
+
+void MCP9600Scheduler::taskEntry(void* arg) {
+  MCP9600Scheduler* scheduler = static_cast<MCP9600Scheduler*>(arg);
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    scheduler->pollAll();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(scheduler->pollMs));
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef MCP9600_SCHEDULER_H
+#define MCP9600_SCHEDULER_H
+
+#include <Arduino.h>
+#include "MCP9600Sensor.h"
+
+#define MCP9600_SCHEDULER_MAX_SENSORS 4
+
+// One acquisition task for several MCP9600s on the same bus (different
+// addresses). Every period it visits the sensors round-robin, starting one
+// further along each time; a sensor only uses the bus once its conversion is
+// due, so the bursts of the probes interleave instead of queueing behind one
+// another. Each sensor keeps its own FIFO and latest-sample mailbox.
+class MCP9600Scheduler {
+private:
+  MCP9600Sensor* sensors[MCP9600_SCHEDULER_MAX_SENSORS];
+  uint8_t count;
+  uint8_t first;
+  uint32_t pollMs;
+  TaskHandle_t task;
+
+  static void taskEntry(void* arg);
+  void pollAll();
+
+public:
+  MCP9600Scheduler();
+
+  // Add a configured sensor (after begin()), before start()
+  bool add(MCP9600Sensor& sensor);
+  uint8_t getCount() const { return count; }
+
+  // Start the shared acquisition task
+  bool start(uint32_t pollMs, BaseType_t core, UBaseType_t priority, UBaseType_t queueLength = 16);
+};
+
+#endif // MCP9600_SCHEDULER_H
@@ -0,0 +1,330 @@
+#include "MCP9600Sensor.h"
+
+// Hot junction register resolution
+#define MCP9600_LSB_C 0.0625f
+
+// Without a data-ready flag for this long the sensor is reported as failed
+#define MCP9600_UPDATE_TIMEOUT_FACTOR 4
+
+MCP9600Sensor::MCP9600Sensor(uint8_t address, TwoWire& wire)
+  : wire(&wire), address(address), resolution(MCP9600_RES_18), sampleQueue(nullptr), latestQueue(nullptr),
+    task(nullptr), pollMs(10), lastUpdateUs(0), alertPending(0), sampleCount(0), errorCount(0), droppedCount(0) {
+  alertMux = portMUX_INITIALIZER_UNLOCKED;
+  statsMux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&busStats, 0, sizeof(busStats));
+  for (uint8_t i = 0; i < MCP9600_ALERT_COUNT; i++) {
+    alertLimitC[i] = NAN;
+    alertHysteresisC[i] = 0;
+  }
+}
+
+bool MCP9600Sensor::readRegister(uint8_t reg, uint8_t* data, uint8_t length) {
+  wire->beginTransmission(address);
+  wire->write(reg);
+  if (wire->endTransmission(false) != 0) {
+    return false;
+  }
+  if (wire->requestFrom(address, length) != length) {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = wire->read();
+  }
+  return true;
+}
+
+bool MCP9600Sensor::writeRegister(uint8_t reg, uint8_t value) {
+  wire->beginTransmission(address);
+  wire->write(reg);
+  wire->write(value);
+  return wire->endTransmission() == 0;
+}
+
+bool MCP9600Sensor::writeRegister16(uint8_t reg, uint16_t value) {
+  wire->beginTransmission(address);
+  wire->write(reg);
+  wire->write((uint8_t)(value >> 8));
+  wire->write((uint8_t)(value & 0xFF));
+  return wire->endTransmission() == 0;
+}
+
+bool MCP9600Sensor::programAlert(uint8_t alert, float limitC, uint8_t hysteresisC) {
+  uint8_t offset = alert - 1;
+  // Disabled while the limit changes so a half-written limit cannot trip
+  bool ok = writeRegister(MCP9600_REG_ALERT_CONFIG_1 + offset, 0x00);
+  ok = ok && writeRegister16(MCP9600_REG_ALERT_LIMIT_1 + offset, (uint16_t)((int16_t)(limitC * 16.0f) & 0xFFFC));
+  ok = ok && writeRegister(MCP9600_REG_ALERT_HYSTERESIS_1 + offset, hysteresisC);
+  ok = ok && writeRegister(MCP9600_REG_ALERT_CONFIG_1 + offset, MCP9600_ALERT_RISING | MCP9600_ALERT_ENABLE);
+  return ok;
+}
+
+void MCP9600Sensor::applyAlerts() {
+  for (uint8_t i = 0; i < MCP9600_ALERT_COUNT; i++) {
+    portENTER_CRITICAL(&alertMux);
+    bool pending = alertPending & (1 << i);
+    float limitC = alertLimitC[i];
+    uint8_t hysteresisC = alertHysteresisC[i];
+    alertPending &= ~(1 << i);
+    portEXIT_CRITICAL(&alertMux);
+    if (pending && !programAlert(i + 1, limitC, hysteresisC)) {
+      // Retried on the next poll
+      errorCount++;
+      portENTER_CRITICAL(&alertMux);
+      alertPending |= 1 << i;
+      portEXIT_CRITICAL(&alertMux);
+    }
+  }
+}
+
+bool MCP9600Sensor::setAlert(uint8_t alert, float limitC, uint8_t hysteresisC) {
+  if (alert < 1 || alert > MCP9600_ALERT_COUNT) {
+    return false;
+  }
+  if (task == nullptr) {
+    if (!programAlert(alert, limitC, hysteresisC)) {
+      return false;
+    }
+    alertLimitC[alert - 1] = limitC;
+    alertHysteresisC[alert - 1] = hysteresisC;
+    return true;
+  }
+  portENTER_CRITICAL(&alertMux);
+  alertLimitC[alert - 1] = limitC;
+  alertHysteresisC[alert - 1] = hysteresisC;
+  alertPending |= 1 << (alert - 1);
+  portEXIT_CRITICAL(&alertMux);
+  return true;
+}
+
+float MCP9600Sensor::getAlertLimit(uint8_t alert) const {
+  if (alert < 1 || alert > MCP9600_ALERT_COUNT) {
+    return NAN;
+  }
+  return alertLimitC[alert - 1];
+}
+
+bool MCP9600Sensor::begin(MCP9600Type type, MCP9600Resolution resolution, uint8_t filter) {
+  uint8_t id[2];
+  if (!readRegister(MCP9600_REG_DEVICE_ID, id, 2) || (id[0] != 0x40 && id[0] != 0x41)) {
+    return false;
+  }
+  this->resolution = resolution;
+
+  // Thermocouple type and digital filter coefficient
+  if (!writeRegister(MCP9600_REG_SENSOR_CONFIG, ((uint8_t)type << 4) | (filter & 0x07))) {
+    return false;
+  }
+  // ADC resolution, normal (continuous conversion) mode
+  if (!writeRegister(MCP9600_REG_DEVICE_CONFIG, (uint8_t)resolution << 5)) {
+    return false;
+  }
+  // Clear stale update flags
+  return writeRegister(MCP9600_REG_STATUS, 0x00);
+}
+
+bool MCP9600Sensor::start(uint32_t pollMs, BaseType_t core, UBaseType_t priority, UBaseType_t queueLength) {
+  if (task != nullptr) {
+    return true;
+  }
+  this->pollMs = pollMs;
+  if (!createQueues(queueLength)) {
+    return false;
+  }
+  if (xTaskCreatePinnedToCore(taskEntry, "mcp9600", 3072, this, priority, &task, core) != pdPASS) {
+    task = nullptr;
+    Serial.println("MCP9600 task creation failed");
+    return false;
+  }
+  return true;
+}
+
+bool MCP9600Sensor::createQueues(UBaseType_t queueLength) {
+  if (sampleQueue == nullptr) {
+    sampleQueue = xQueueCreate(queueLength, sizeof(ThermocoupleSample));
+  }
+  if (latestQueue == nullptr) {
+    latestQueue = xQueueCreate(1, sizeof(ThermocoupleSample));
+  }
+  if (sampleQueue == nullptr || latestQueue == nullptr) {
+    Serial.println("MCP9600 queue allocation failed");
+    return false;
+  }
+  lastUpdateUs = micros();
+  return true;
+}
+
+void MCP9600Sensor::taskEntry(void* arg) {
+  MCP9600Sensor* sensor = static_cast<MCP9600Sensor*>(arg);
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    sensor->poll();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(sensor->pollMs));
+  }
+}
+
+void MCP9600Sensor::publish(const ThermocoupleSample& sample) {
+  xQueueOverwrite(latestQueue, &sample);
+  if (xQueueSend(sampleQueue, &sample, 0) != pdTRUE) {
+    droppedCount++;
+  }
+}
+
+// STATUS, hot junction, delta and cold junction. The register pointer does
+// not advance across registers, so one contiguous read is not possible: each
+// register is its own pointer write and read, joined by a repeated start. The
+// bus is released between the four (arduino-esp32 does not hold it after
+// requestFrom); the acquisition task is its only user
+bool MCP9600Sensor::readBurstOnce(uint8_t* status, uint8_t* data) {
+  static const uint8_t registers[3] = {MCP9600_REG_HOT_JUNCTION, MCP9600_REG_DELTA, MCP9600_REG_COLD_JUNCTION};
+  wire->beginTransmission(address);
+  wire->write(MCP9600_REG_STATUS);
+  if (wire->endTransmission(false) != 0 || wire->requestFrom(address, (uint8_t)1) != 1) {
+    return false;
+  }
+  *status = wire->read();
+  for (uint8_t i = 0; i < 3; i++) {
+    wire->beginTransmission(address);
+    wire->write(registers[i]);
+    if (wire->endTransmission(false) != 0 || wire->requestFrom(address, (uint8_t)2) != 2) {
+      return false;
+    }
+    data[2 * i] = wire->read();
+    data[2 * i + 1] = wire->read();
+  }
+  return true;
+}
+
+bool MCP9600Sensor::readBurst(uint8_t* status, uint8_t* data) {
+  uint32_t start = micros();
+  for (uint8_t attempt = 1; attempt <= MCP9600_BUS_ATTEMPTS; attempt++) {
+    if (readBurstOnce(status, data)) {
+      recordTransaction(start, attempt, true);
+      return true;
+    }
+  }
+  recordTransaction(start, MCP9600_BUS_ATTEMPTS, false);
+  return false;
+}
+
+// Writing zero clears the update flag so the next conversion can be detected
+bool MCP9600Sensor::clearStatus() {
+  uint32_t start = micros();
+  for (uint8_t attempt = 1; attempt <= MCP9600_BUS_ATTEMPTS; attempt++) {
+    if (writeRegister(MCP9600_REG_STATUS, 0x00)) {
+      recordTransaction(start, attempt, true);
+      return true;
+    }
+  }
+  recordTransaction(start, MCP9600_BUS_ATTEMPTS, false);
+  return false;
+}
+
+void MCP9600Sensor::recordTransaction(uint32_t startUs, uint8_t attempts, bool ok) {
+  uint32_t durationUs = micros() - startUs;
+  portENTER_CRITICAL(&statsMux);
+  busStats.transactions++;
+  busStats.retries += attempts - 1;
+  if (!ok) busStats.failures++;
+  busStats.lastUs = durationUs;
+  if (durationUs > busStats.maxUs) busStats.maxUs = durationUs;
+  busStats.totalUs += durationUs;
+  portEXIT_CRITICAL(&statsMux);
+}
+
+MCP9600BusStats MCP9600Sensor::getBusStats() {
+  MCP9600BusStats copy;
+  portENTER_CRITICAL(&statsMux);
+  copy = busStats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+void MCP9600Sensor::resetBusStats() {
+  portENTER_CRITICAL(&statsMux);
+  memset(&busStats, 0, sizeof(busStats));
+  portEXIT_CRITICAL(&statsMux);
+}
+
+void MCP9600Sensor::poll() {
+  ThermocoupleSample sample;
+  uint8_t status;
+  uint8_t data[6];
+  uint32_t now = micros();
+
+  if (alertPending) {
+    applyAlerts();
+  }
+
+  // Leave the bus alone until the next conversion can be ready
+  uint32_t conversionMs = getConversionTimeMs();
+  if (conversionMs > pollMs && now - lastUpdateUs < (conversionMs - pollMs) * 1000UL) {
+    return;
+  }
+
+  sample.timestampUs = now;
+  if (!readBurst(&status, data)) {
+    errorCount++;
+    sample.temperature = NAN;
+    sample.delta = NAN;
+    sample.coldJunction = NAN;
+    sample.sequence = ++sampleCount;
+    sample.status = 0;
+    sample.valid = false;
+    publish(sample);
+    return;
+  }
+
+  if (!(status & MCP9600_STATUS_TH_UPDATE)) {
+    // Conversion still running; report a stuck converter after a few periods
+    if (now - lastUpdateUs > conversionMs * 1000UL * MCP9600_UPDATE_TIMEOUT_FACTOR) {
+      lastUpdateUs = now;
+      sample.temperature = NAN;
+      sample.delta = NAN;
+      sample.coldJunction = NAN;
+      sample.sequence = ++sampleCount;
+      sample.status = status;
+      sample.valid = false;
+      publish(sample);
+    }
+    return;
+  }
+  lastUpdateUs = now;
+
+  bool ok = clearStatus();
+  if (!ok) {
+    errorCount++;
+  }
+
+  sample.temperature = (int16_t)((data[0] << 8) | data[1]) * MCP9600_LSB_C;
+  sample.delta = (int16_t)((data[2] << 8) | data[3]) * MCP9600_LSB_C;
+  sample.coldJunction = (int16_t)((data[4] << 8) | data[5]) * MCP9600_LSB_C;
+  sample.sequence = ++sampleCount;
+  sample.status = status;
+  // The data is good even if the flag could not be cleared, the next burst retries that
+  sample.valid = !(status & (MCP9600_STATUS_INPUT_RANGE | MCP9600_STATUS_SHORT_CIRCUIT));
+  publish(sample);
+}
+
+bool MCP9600Sensor::getLatest(ThermocoupleSample* sample) {
+  if (latestQueue == nullptr) {
+    return false;
+  }
+  return xQueuePeek(latestQueue, sample, 0) == pdTRUE;
+}
+
+bool MCP9600Sensor::receive(ThermocoupleSample* sample) {
+  if (sampleQueue == nullptr) {
+    return false;
+  }
+  return xQueueReceive(sampleQueue, sample, 0) == pdTRUE;
+}
+
+uint32_t MCP9600Sensor::getConversionTimeMs() const {
+  switch (resolution) {
+    case MCP9600_RES_18: return 320;
+    case MCP9600_RES_16: return 80;
+    case MCP9600_RES_14: return 20;
+    case MCP9600_RES_12: return 5;
+  }
+  return 320;
+}
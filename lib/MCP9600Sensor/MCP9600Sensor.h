@@ -0,0 +1,163 @@
+#ifndef MCP9600_SENSOR_H
+#define MCP9600_SENSOR_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// MCP9600 registers
+#define MCP9600_REG_HOT_JUNCTION  0x00
+#define MCP9600_REG_DELTA         0x01
+#define MCP9600_REG_COLD_JUNCTION 0x02
+#define MCP9600_REG_RAW_ADC       0x03
+#define MCP9600_REG_STATUS        0x04
+#define MCP9600_REG_SENSOR_CONFIG 0x05
+#define MCP9600_REG_DEVICE_CONFIG 0x06
+#define MCP9600_REG_ALERT_CONFIG_1 0x08      // Alert n at 0x08 + n - 1
+#define MCP9600_REG_ALERT_HYSTERESIS_1 0x0C  // 1 C per LSB
+#define MCP9600_REG_ALERT_LIMIT_1 0x10       // 0.25 C per LSB in bits 15:2
+#define MCP9600_REG_DEVICE_ID     0x20
+
+// STATUS register bits
+#define MCP9600_STATUS_BURST_COMPLETE 0x80
+#define MCP9600_STATUS_TH_UPDATE      0x40
+#define MCP9600_STATUS_SHORT_CIRCUIT  0x20   // Shorted thermocouple (MCP9601 only, reads 0 on the MCP9600)
+#define MCP9600_STATUS_INPUT_RANGE    0x10   // Open or shorted thermocouple
+#define MCP9600_STATUS_ALERT_1        0x01   // Alert n output asserted at bit n - 1
+
+// ALERT configuration bits
+#define MCP9600_ALERT_ENABLE          0x01
+#define MCP9600_ALERT_INTERRUPT_MODE  0x02   // Clear: comparator (asserted while over the limit)
+#define MCP9600_ALERT_ACTIVE_HIGH     0x04   // Clear: active low (open drain)
+#define MCP9600_ALERT_RISING          0x08   // Trip on rising temperature
+#define MCP9600_ALERT_COLD_JUNCTION   0x10   // Clear: monitor the hot junction
+
+#define MCP9600_ALERT_COUNT 4
+
+#define MCP9600_DEFAULT_ADDRESS 0x67
+
+// Attempts per bus transaction before a sample is published as invalid
+#define MCP9600_BUS_ATTEMPTS 3
+
+enum MCP9600Type {
+  MCP9600_TC_K = 0,
+  MCP9600_TC_J,
+  MCP9600_TC_T,
+  MCP9600_TC_N,
+  MCP9600_TC_S,
+  MCP9600_TC_E,
+  MCP9600_TC_B,
+  MCP9600_TC_R
+};
+
+// ADC resolution, conversion time 320 / 80 / 20 / 5 ms
+enum MCP9600Resolution {
+  MCP9600_RES_18 = 0,
+  MCP9600_RES_16,
+  MCP9600_RES_14,
+  MCP9600_RES_12
+};
+
+// One timestamped conversion result
+struct ThermocoupleSample {
+  float temperature;      // Hot junction temperature
+  float delta;            // Hot minus cold junction
+  float coldJunction;     // Cold junction (device) temperature
+  uint32_t timestampUs;   // micros() when the data-ready flag was seen
+  uint32_t sequence;      // Increments with every published sample
+  uint8_t status;         // STATUS register at the time of the read
+  bool valid;             // False on bus error or open/shorted thermocouple
+};
+
+// I2C transaction counters of the acquisition task
+struct MCP9600BusStats {
+  uint32_t transactions;  // Completed transactions (bursts and writes)
+  uint32_t retries;       // Attempts repeated after a NACK or short read
+  uint32_t failures;      // Transactions that failed every attempt
+  uint32_t lastUs;        // Duration of the last transaction
+  uint32_t maxUs;         // Longest transaction
+  uint64_t totalUs;       // Sum of transaction durations
+};
+
+// Non-blocking MCP9600 driver. A small task waits until a conversion is due,
+// reads STATUS and the hot junction, delta and cold junction registers (one
+// write/read pair each) and publishes the result to a FIFO and a
+// latest-sample mailbox, so the control path never waits on the I2C bus.
+class MCP9600Sensor {
+  friend class MCP9600Scheduler;
+
+private:
+  TwoWire* wire;
+  uint8_t address;
+  MCP9600Resolution resolution;
+  QueueHandle_t sampleQueue;    // Every sample, for consumers that need all of them
+  QueueHandle_t latestQueue;    // Length one mailbox with the newest sample
+  TaskHandle_t task;
+  uint32_t pollMs;
+  uint32_t lastUpdateUs;
+
+  // Alert limits requested by the application, programmed from the acquisition task
+  portMUX_TYPE alertMux;
+  uint8_t alertPending;
+  float alertLimitC[MCP9600_ALERT_COUNT];
+  uint8_t alertHysteresisC[MCP9600_ALERT_COUNT];
+
+  // Bus statistics, updated by the acquisition task
+  portMUX_TYPE statsMux;
+  MCP9600BusStats busStats;
+
+  // Statistics
+  volatile uint32_t sampleCount;
+  volatile uint32_t errorCount;
+  volatile uint32_t droppedCount;
+
+  bool readRegister(uint8_t reg, uint8_t* data, uint8_t length);
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool writeRegister16(uint8_t reg, uint16_t value);
+  bool readBurstOnce(uint8_t* status, uint8_t* data);
+  bool readBurst(uint8_t* status, uint8_t* data);
+  bool clearStatus();
+  void recordTransaction(uint32_t startUs, uint8_t attempts, bool ok);
+  bool programAlert(uint8_t alert, float limitC, uint8_t hysteresisC);
+  void applyAlerts();
+  bool createQueues(UBaseType_t queueLength);
+  void publish(const ThermocoupleSample& sample);
+  void poll();
+
+  static void taskEntry(void* arg);
+
+public:
+  MCP9600Sensor(uint8_t address = MCP9600_DEFAULT_ADDRESS, TwoWire& wire = Wire);
+
+  // Detect and configure the device (Wire must already be started)
+  bool begin(MCP9600Type type = MCP9600_TC_K, MCP9600Resolution resolution = MCP9600_RES_18, uint8_t filter = 0);
+
+  // Start the acquisition task
+  bool start(uint32_t pollMs, BaseType_t core, UBaseType_t priority, UBaseType_t queueLength = 16);
+
+  // Newest sample without removing it, false if none was published yet
+  bool getLatest(ThermocoupleSample* sample);
+
+  // Next sample from the FIFO, false if empty (never blocks)
+  bool receive(ThermocoupleSample* sample);
+
+  // Over-temperature alert on the hot junction: the open-drain ALERT output
+  // (1 - 4) goes low above limitC and releases below limitC - hysteresisC.
+  // Before start() it is programmed at once, afterwards by the acquisition
+  // task, so the caller never touches the bus. A sensor left out of a running
+  // MCP9600Scheduler has no task and would write directly: do not call it then
+  bool setAlert(uint8_t alert, float limitC, uint8_t hysteresisC);
+  float getAlertLimit(uint8_t alert) const;
+
+  // Conversion time of the configured resolution
+  uint32_t getConversionTimeMs() const;
+
+  // Per-transaction latency and error counters
+  MCP9600BusStats getBusStats();
+  void resetBusStats();
+
+  uint32_t getSampleCount() const { return sampleCount; }
+  uint32_t getErrorCount() const { return errorCount; }
+  uint32_t getDroppedCount() const { return droppedCount; }
+};
+
+#endif // MCP9600_SENSOR_H
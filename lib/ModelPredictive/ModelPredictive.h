@@ -0,0 +1,347 @@
+#ifndef MODEL_PREDICTIVE_H
+#define MODEL_PREDICTIVE_H
+
+#include <stdint.h>
+#include <math.h>
+#include "FixedPoint.h"
+#include "PlantModel.h"
+
+// Prediction steps after the dead time
+#define MPC_HORIZON 10
+// Duty moves over the horizon (move blocking), the last one holds to the end
+#define MPC_BLOCKS 3
+// Longest dead time, in samples
+#define MPC_MAX_DELAY 32
+// Box (2 per move), peak and ramp rate (1 each per step)
+#define MPC_CONSTRAINTS (2 * MPC_BLOCKS + 2 * MPC_HORIZON)
+#define MPC_MAX_ITERATIONS 40
+
+// Short-horizon model-predictive controller on the first-order-plus-dead-time
+// oven model, templated on the numeric type like PIDController (float or
+// Fixed16).
+//
+// Every sample it predicts the oven over MPC_HORIZON steps starting one dead
+// time ahead (Smith form: measurement plus the heat already on its way) and
+// picks MPC_BLOCKS duty levels minimizing the squared tracking error plus a
+// move penalty, subject to hard constraints:
+//   0 <= duty <= 1, predicted temperature <= peak, predicted rise per step <= max rate
+// The quadratic program is solved by Hildreth's dual coordinate ascent with
+// everything that depends only on the model precomputed in configure(), so
+// compute() is allocation-free with a bounded number of iterations. When the
+// unconstrained optimum is feasible (most of a run) the dual is skipped.
+//
+// Internally the decision variable is the steady-state rise the duty would
+// hold (duty * gain, in C) and temperatures are relative to ambient, which
+// keeps every matrix well inside the Q16.16 range.
+template <typename T>
+class MPCController {
+private:
+  // Model
+  T a;                              // exp(-Ts / tau)
+  T b;                              // 1 - a
+  float gainC;
+  float ambientC;
+  float samplePeriodS;
+  uint8_t delay;
+  bool enabled;
+
+  // Precomputed from the model
+  T step[MPC_HORIZON][MPC_BLOCKS];  // Response at step i to a unit rise in block j
+  T hinv[MPC_BLOCKS][MPC_BLOCKS];   // Inverse Hessian
+  T hinvAt[MPC_BLOCKS][MPC_CONSTRAINTS];
+  T dual[MPC_CONSTRAINTS][MPC_CONSTRAINTS];
+  T dualInvDiag[MPC_CONSTRAINTS];
+  T moveWeight;
+
+  // Constraints
+  T peakRise;                       // Peak relative to ambient
+  T maxStepRise;                    // Max rate * Ts
+
+  // State (relative to ambient, C)
+  T undelayed;                      // Model without the dead time
+  T delayed;                        // Model driven by the delayed input
+  T history[MPC_MAX_DELAY + 1];
+  uint8_t head;
+  T lastMove;
+  T bias;                           // Per-step model error estimate
+  T lastPrediction;                 // One-step prediction of the undelayed state
+  uint8_t iterations;
+  bool constrained;
+
+  T constraintRow(int c, const T* w) const {
+    // Row c of A times w, A is never stored: rows are built from step[]
+    if (c < 2 * MPC_BLOCKS) {
+      int j = c >> 1;
+      return (c & 1) ? -w[j] : w[j];
+    }
+    int i = (c - 2 * MPC_BLOCKS) >> 1;
+    T sum = T(0);
+    for (int j = 0; j < MPC_BLOCKS; j++) {
+      T g = step[i][j];
+      if ((c & 1) && i > 0) g = g - step[i - 1][j];
+      sum += g * w[j];
+    }
+    return sum;
+  }
+
+  static float rowEntry(int c, int j, const double stepD[MPC_HORIZON][MPC_BLOCKS]) {
+    if (c < 2 * MPC_BLOCKS) {
+      if ((c >> 1) != j) return 0.0f;
+      return (c & 1) ? -1.0f : 1.0f;
+    }
+    int i = (c - 2 * MPC_BLOCKS) >> 1;
+    double g = stepD[i][j];
+    if ((c & 1) && i > 0) g -= stepD[i - 1][j];
+    return (float)g;
+  }
+
+public:
+  MPCController()
+    : a(T(0)), b(T(0)), gainC(0.0f), ambientC(0.0f), samplePeriodS(1.0f), delay(0), enabled(false),
+      moveWeight(T(0)), peakRise(T(0)), maxStepRise(T(0)), undelayed(T(0)), delayed(T(0)), head(0),
+      lastMove(T(0)), bias(T(0)), lastPrediction(T(0)), iterations(0), constrained(false) {}
+
+  // Precompute the prediction and dual matrices. moveWeight penalizes the
+  // squared change between duty moves (in C of held rise). Returns false for
+  // an invalid model or a dead time longer than MPC_MAX_DELAY samples.
+  bool configure(const PlantModel& model, float samplePeriodS, float moveWeight) {
+    enabled = false;
+    if (!model.valid || model.gainC <= 0.0f || model.tauS <= 0.0f || samplePeriodS <= 0.0f) return false;
+    int d = (int)(model.deadTimeS / samplePeriodS + 0.5f);
+    if (d > MPC_MAX_DELAY) return false;
+    this->samplePeriodS = samplePeriodS;
+    gainC = model.gainC;
+    ambientC = model.ambientC;
+    delay = (uint8_t)d;
+    double ad = exp(-samplePeriodS / model.tauS);
+    a = T((float)ad);
+    b = T((float)(1.0 - ad));
+    this->moveWeight = T(moveWeight);
+
+    // Step response of each move block: steps [j * L, (j + 1) * L), the last to the end
+    const int blockLength = MPC_HORIZON / MPC_BLOCKS;
+    double stepD[MPC_HORIZON][MPC_BLOCKS];
+    for (int j = 0; j < MPC_BLOCKS; j++) {
+      int first = j * blockLength;
+      int last = j == MPC_BLOCKS - 1 ? MPC_HORIZON : first + blockLength;
+      double z = 0.0;
+      for (int i = 0; i < MPC_HORIZON; i++) {
+        double input = (i >= first && i < last) ? 1.0 : 0.0;
+        z = ad * z + (1.0 - ad) * input;
+        stepD[i][j] = z;
+        step[i][j] = T((float)z);
+      }
+    }
+
+    // Hessian G'G + moveWeight * D'D (D: first differences including the applied duty)
+    double h[MPC_BLOCKS][2 * MPC_BLOCKS];
+    for (int r = 0; r < MPC_BLOCKS; r++) {
+      for (int c = 0; c < MPC_BLOCKS; c++) {
+        double sum = 0.0;
+        for (int i = 0; i < MPC_HORIZON; i++) sum += stepD[i][r] * stepD[i][c];
+        if (r == c) sum += moveWeight * (r == MPC_BLOCKS - 1 ? 1.0 : 2.0);
+        if (r - c == 1 || c - r == 1) sum -= moveWeight;
+        h[r][c] = sum;
+        h[r][MPC_BLOCKS + c] = r == c ? 1.0 : 0.0;
+      }
+    }
+    // Gauss-Jordan, the Hessian is positive definite
+    for (int col = 0; col < MPC_BLOCKS; col++) {
+      int pivot = col;
+      for (int r = col + 1; r < MPC_BLOCKS; r++) {
+        if (fabs(h[r][col]) > fabs(h[pivot][col])) pivot = r;
+      }
+      if (fabs(h[pivot][col]) < 1e-12) return false;
+      for (int c = 0; c < 2 * MPC_BLOCKS; c++) {
+        double t = h[col][c];
+        h[col][c] = h[pivot][c];
+        h[pivot][c] = t;
+      }
+      double inv = 1.0 / h[col][col];
+      for (int c = 0; c < 2 * MPC_BLOCKS; c++) h[col][c] *= inv;
+      for (int r = 0; r < MPC_BLOCKS; r++) {
+        if (r == col) continue;
+        double f = h[r][col];
+        for (int c = 0; c < 2 * MPC_BLOCKS; c++) h[r][c] -= f * h[col][c];
+      }
+    }
+    double hinvD[MPC_BLOCKS][MPC_BLOCKS];
+    for (int r = 0; r < MPC_BLOCKS; r++) {
+      for (int c = 0; c < MPC_BLOCKS; c++) {
+        hinvD[r][c] = h[r][MPC_BLOCKS + c];
+        hinv[r][c] = T((float)hinvD[r][c]);
+      }
+    }
+
+    // H^-1 A' and the dual Hessian A H^-1 A'
+    double hinvAtD[MPC_BLOCKS][MPC_CONSTRAINTS];
+    for (int r = 0; r < MPC_BLOCKS; r++) {
+      for (int c = 0; c < MPC_CONSTRAINTS; c++) {
+        double sum = 0.0;
+        for (int k = 0; k < MPC_BLOCKS; k++) sum += hinvD[r][k] * rowEntry(c, k, stepD);
+        hinvAtD[r][c] = sum;
+        hinvAt[r][c] = T((float)sum);
+      }
+    }
+    for (int r = 0; r < MPC_CONSTRAINTS; r++) {
+      for (int c = 0; c < MPC_CONSTRAINTS; c++) {
+        double sum = 0.0;
+        for (int k = 0; k < MPC_BLOCKS; k++) sum += rowEntry(r, k, stepD) * hinvAtD[k][c];
+        dual[r][c] = T((float)sum);
+        if (r == c) dualInvDiag[r] = T(sum > 1e-9 ? (float)(1.0 / sum) : 0.0f);
+      }
+    }
+
+    setConstraints(1000.0f, 1000.0f);
+    enabled = true;
+    reset(ambientC, 0.0f);
+    return true;
+  }
+
+  bool isEnabled() const { return enabled; }
+
+  // Hard limits on the predicted temperature and heating rate
+  void setConstraints(float peakC, float maxRateCPerS) {
+    peakRise = T(peakC - ambientC);
+    maxStepRise = T(maxRateCPerS * samplePeriodS);
+  }
+
+  // Start from a steady oven at the temperature with the duty applied
+  void reset(float temperatureC, float duty) {
+    T z = T(temperatureC - ambientC);
+    undelayed = z;
+    delayed = z;
+    lastMove = T(duty * gainC);
+    for (int i = 0; i <= MPC_MAX_DELAY; i++) history[i] = lastMove;
+    head = 0;
+    bias = T(0);
+    lastPrediction = z;
+    iterations = 0;
+    constrained = false;
+  }
+
+  // Duty (0 - 1) for this sample. reference[i] is the setpoint one dead time
+  // plus i + 1 samples ahead.
+  float compute(const float* reference, float measuredC) {
+    if (!enabled) return 0.0f;
+    // Temperature one dead time ahead: measurement plus the heat still in the pipe
+    T measured = T(measuredC - ambientC);
+    T z0 = measured + undelayed - delayed;
+    // Slow per-step model error, learned from the one-step prediction miss
+    bias = bias + T(0.05f) * (z0 - lastPrediction);
+
+    // Free response (duty off) with the bias integrated along the horizon
+    T free[MPC_HORIZON];
+    T z = z0;
+    for (int i = 0; i < MPC_HORIZON; i++) {
+      z = a * z + bias;
+      free[i] = z;
+    }
+
+    // Linear term F = -G'(r - f) - moveWeight * lastMove e0
+    T linear[MPC_BLOCKS];
+    for (int j = 0; j < MPC_BLOCKS; j++) {
+      T sum = T(0);
+      for (int i = 0; i < MPC_HORIZON; i++) {
+        sum += step[i][j] * (T(reference[i] - ambientC) - free[i]);
+      }
+      linear[j] = -sum;
+    }
+    linear[0] -= moveWeight * lastMove;
+
+    // Unconstrained optimum
+    T w[MPC_BLOCKS];
+    for (int r = 0; r < MPC_BLOCKS; r++) {
+      T sum = T(0);
+      for (int c = 0; c < MPC_BLOCKS; c++) sum -= hinv[r][c] * linear[c];
+      w[r] = sum;
+    }
+
+    // Right-hand sides b of A w <= b
+    T limit[MPC_CONSTRAINTS];
+    T maxRise = T(gainC);
+    for (int j = 0; j < MPC_BLOCKS; j++) {
+      limit[2 * j] = maxRise;
+      limit[2 * j + 1] = T(0);
+    }
+    for (int i = 0; i < MPC_HORIZON; i++) {
+      limit[2 * MPC_BLOCKS + 2 * i] = peakRise - free[i];
+      limit[2 * MPC_BLOCKS + 2 * i + 1] = maxStepRise - (free[i] - (i > 0 ? free[i - 1] : z0));
+    }
+
+    constrained = false;
+    for (int c = 0; c < MPC_CONSTRAINTS; c++) {
+      if (constraintRow(c, w) > limit[c]) {
+        constrained = true;
+        break;
+      }
+    }
+
+    iterations = 0;
+    if (constrained) {
+      // Hildreth: maximize the dual over lambda >= 0, one coordinate at a time
+      T k[MPC_CONSTRAINTS];
+      T lambda[MPC_CONSTRAINTS];
+      // Few constraints are ever active, only their multipliers enter the sums
+      uint8_t active[MPC_CONSTRAINTS];
+      int activeCount = 0;
+      for (int c = 0; c < MPC_CONSTRAINTS; c++) {
+        // b + A H^-1 F = b - A w (w holds the unconstrained optimum -H^-1 F)
+        k[c] = limit[c] - constraintRow(c, w);
+        lambda[c] = T(0);
+      }
+      T tolerance = T(0.001f);
+      while (iterations < MPC_MAX_ITERATIONS) {
+        iterations++;
+        T change = T(0);
+        for (int c = 0; c < MPC_CONSTRAINTS; c++) {
+          T sum = k[c];
+          for (int n = 0; n < activeCount; n++) {
+            int j = active[n];
+            if (j != c) sum += dual[c][j] * lambda[j];
+          }
+          T next = -sum * dualInvDiag[c];
+          if (next < T(0)) next = T(0);
+          if (next > T(0) && lambda[c] == T(0)) {
+            bool listed = false;
+            for (int n = 0; n < activeCount; n++) listed = listed || active[n] == c;
+            if (!listed) active[activeCount++] = (uint8_t)c;
+          }
+          T delta = next - lambda[c];
+          if (delta < T(0)) delta = -delta;
+          if (delta > change) change = delta;
+          lambda[c] = next;
+        }
+        if (change < tolerance) break;
+      }
+      // w = -H^-1 (F + A' lambda)
+      for (int r = 0; r < MPC_BLOCKS; r++) {
+        T sum = T(0);
+        for (int n = 0; n < activeCount; n++) sum += hinvAt[r][active[n]] * lambda[active[n]];
+        w[r] -= sum;
+      }
+    }
+
+    // Receding horizon: apply the first move, clamped for an infeasible problem
+    T move = w[0];
+    if (move < T(0)) move = T(0);
+    if (move > maxRise) move = maxRise;
+    lastMove = move;
+
+    // Advance the internal models with the applied duty
+    undelayed = a * undelayed + b * move;
+    history[head] = move;
+    head = (uint8_t)((head + 1) % (delay + 1));
+    delayed = a * delayed + b * history[head];
+    lastPrediction = a * z0 + b * move + bias;
+    return (float)move / gainC;
+  }
+
+  uint8_t getDelay() const { return delay; }
+  float getDeadTime() const { return delay * samplePeriodS; }
+  // Hildreth iterations of the last compute, 0 when unconstrained
+  uint8_t getIterations() const { return iterations; }
+  bool wasConstrained() const { return constrained; }
+};
+
+#endif // MODEL_PREDICTIVE_H
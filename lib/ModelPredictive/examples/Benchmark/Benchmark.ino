@@ -0,0 +1,80 @@
+/*
+ * ModelPredictive cycle-count benchmark
+ *
+ * Runs MPCController<float> and MPCController<Fixed16> through a heat-up to a
+ * capped peak on a first-order-plus-dead-time oven and prints the CPU cycles
+ * per compute, average and worst case, with the PIDController<float> cost for
+ * reference.
+ */
+
+#include <Arduino.h>
+#include "PIDEngine.h"
+#include "ModelPredictive.h"
+
+#define ITERATIONS 600
+#define DEAD_TIME 5
+
+// Same oven as the model, heat arrives DEAD_TIME samples late
+static PlantModel model = {1, 272.0f, 136.0f, DEAD_TIME, 25.0f, 0.0f};
+
+static float plant(float temperature, float duty) {
+  static float pipe[DEAD_TIME];
+  static int head = 0;
+  float arrived = pipe[head];
+  pipe[head] = duty;
+  head = (head + 1) % DEAD_TIME;
+  return temperature + (model.ambientC + model.gainC * arrived - temperature) / model.tauS;
+}
+
+template <typename T>
+void benchmarkMPC(const char* name) {
+  MPCController<T> mpc;
+  mpc.configure(model, 1.0f, 0.02f);
+  // Setpoint beyond the peak so the constrained solver runs near the end
+  mpc.setConstraints(200.0f, 1.5f);
+  mpc.reset(25.0f, 0.0f);
+
+  float input = 25.0f;
+  float reference[MPC_HORIZON];
+  uint32_t total = 0, worst = 0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    for (int h = 0; h < MPC_HORIZON; h++) reference[h] = min(25.0f + (i + h) * 1.0f, 220.0f);
+    uint32_t start = ESP.getCycleCount();
+    float duty = mpc.compute(reference, input);
+    uint32_t cycles = ESP.getCycleCount() - start;
+    total += cycles;
+    if (cycles > worst) worst = cycles;
+    input = plant(input, duty);
+  }
+  Serial.println(String(name) + String(total / ITERATIONS) + " avg, " + String(worst) + " worst");
+}
+
+uint32_t benchmarkPID() {
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, 2000);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(25.0f, 0.0f);
+  float input = 25.0f;
+  uint32_t cycles = 0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    uint32_t start = ESP.getCycleCount();
+    float out = pid.compute(150.0f, input);
+    cycles += ESP.getCycleCount() - start;
+    input = plant(input, out / 2000.0f);
+  }
+  return cycles / ITERATIONS;
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println("Controller cost (cycles per call)");
+  Serial.println("PIDController<float>:    " + String(benchmarkPID()));
+  benchmarkMPC<float>("MPCController<float>:    ");
+  benchmarkMPC<Fixed16>("MPCController<Fixed16>:  ");
+}
+
+void loop() {
+}
@@ -0,0 +1,81 @@
+#include "OvenSimulator.h"
+
+OvenSimulator::OvenSimulator(const OvenParameters& params)
+  : params(params), ovenC(params.ambientC), sensorC(params.ambientC), boardC(params.ambientC), timeS(0.0f),
+    noiseC(0.0f), noiseState(1) {
+  reset(params.ambientC);
+}
+
+OvenParameters OvenSimulator::defaultParameters() {
+  OvenParameters p;
+  p.heaterPowerW = 1500.0f;
+  p.thermalMassJPerK = 750.0f;   // ~2 C/s at full power near ambient
+  p.lossWPerK = 5.5f;            // ~300 C equilibrium at full power
+  p.radiationWPerK4 = 0.0f;
+  p.ambientC = 25.0f;
+  p.sensorTauS = 1.5f;
+  p.deadTimeS = 0.0f;
+  p.boardMassJPerK = 0.0f;
+  p.boardTransferWPerK = 0.0f;
+  p.sensorNoiseC = 0.0f;
+  return p;
+}
+
+float OvenSimulator::gaussian() {
+  float sum = 0.0f;
+  for (int i = 0; i < 4; i++) {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    sum += (noiseState >> 8) * (1.0f / 16777216.0f);
+  }
+  // Four uniforms: mean 2, variance 1/3
+  return (sum - 2.0f) * 1.7320508f;
+}
+
+void OvenSimulator::reset(float temperatureC) {
+  ovenC = temperatureC;
+  sensorC = temperatureC;
+  boardC = temperatureC;
+  timeS = 0.0f;
+  noiseC = 0.0f;
+  for (unsigned int i = 0; i < OVEN_DELAY_STEPS; i++) delayLine[i] = 0.0f;
+  delayHead = 0;
+}
+
+void OvenSimulator::step(float heaterFraction, float dtS) {
+  if (heaterFraction < 0.0f) heaterFraction = 0.0f;
+  if (heaterFraction > 1.0f) heaterFraction = 1.0f;
+
+  if (params.deadTimeS > 0.0f) {
+    unsigned int delay = (unsigned int)(params.deadTimeS / dtS + 0.5f);
+    if (delay >= OVEN_DELAY_STEPS) delay = OVEN_DELAY_STEPS - 1;
+    delayLine[delayHead] = heaterFraction;
+    heaterFraction = delayLine[(delayHead + OVEN_DELAY_STEPS - delay) % OVEN_DELAY_STEPS];
+    delayHead = (delayHead + 1) % OVEN_DELAY_STEPS;
+  }
+
+  float powerW = params.heaterPowerW * heaterFraction - params.lossWPerK * (ovenC - params.ambientC);
+  if (params.radiationWPerK4 > 0.0f) {
+    float ovenK = ovenC + 273.15f;
+    float ambientK = params.ambientC + 273.15f;
+    powerW -= params.radiationWPerK4 * (ovenK * ovenK * ovenK * ovenK - ambientK * ambientK * ambientK * ambientK);
+  }
+  if (params.boardMassJPerK > 0.0f) {
+    float transferW = params.boardTransferWPerK * (ovenC - boardC);
+    powerW -= transferW;
+    boardC += transferW / params.boardMassJPerK * dtS;
+  } else {
+    boardC = ovenC;
+  }
+  ovenC += powerW / params.thermalMassJPerK * dtS;
+  if (params.sensorTauS > 0.0f) {
+    sensorC += (ovenC - sensorC) * dtS / (params.sensorTauS + dtS);
+  } else {
+    sensorC = ovenC;
+  }
+  if (params.sensorNoiseC > 0.0f) {
+    noiseC = params.sensorNoiseC * gaussian();
+  }
+  timeS += dtS;
+}
@@ -0,0 +1,64 @@
+#ifndef OVEN_SIMULATOR_H
+#define OVEN_SIMULATOR_H
+
+#include <stdint.h>
+
+// Lumped thermal model of a toaster oven used by the native benchmarks:
+// heater power into one thermal mass with linear (and optionally radiative)
+// loss to ambient, seen by a thermocouple with a first-order lag. The heater
+// power can reach the oven after a transport delay. Optionally a board
+// (second thermal mass) takes heat from the oven through a conductance, and
+// the reading carries seeded (repeatable) Gaussian noise.
+struct OvenParameters {
+  float heaterPowerW;       // Heater power with the SSR on
+  float thermalMassJPerK;   // Heat capacity of oven air, walls and load
+  float lossWPerK;          // Loss to ambient per kelvin of temperature difference
+  float radiationWPerK4;    // Radiative loss coefficient on absolute temperatures (0 = linear plant)
+  float ambientC;           // Ambient temperature
+  float sensorTauS;         // Thermocouple time constant
+  float deadTimeS;          // Delay between SSR switching and heat reaching the oven
+  float boardMassJPerK;     // Heat capacity of the board (0 = no board)
+  float boardTransferWPerK; // Heat transfer between oven and board per kelvin
+  float sensorNoiseC;       // Standard deviation of the reading's noise (0 = clean)
+};
+
+// Delay line length in steps; deadTimeS / dtS must fit
+#define OVEN_DELAY_STEPS 4096
+
+class OvenSimulator {
+private:
+  // Approximately normal, unit variance: sum of four uniforms (xorshift32)
+  float gaussian();
+
+  OvenParameters params;
+  float ovenC;
+  float sensorC;
+  float boardC;
+  float timeS;
+  float noiseC;
+  uint32_t noiseState;
+  float delayLine[OVEN_DELAY_STEPS];
+  unsigned int delayHead;
+
+public:
+  OvenSimulator(const OvenParameters& params);
+
+  // Default parameters of a 1500 W toaster oven
+  static OvenParameters defaultParameters();
+
+  void reset(float temperatureC);
+
+  // Restart the noise sequence, the same seed gives the same readings
+  void setNoiseSeed(uint32_t seed) { noiseState = seed ? seed : 1; }
+
+  // Advance by dtS seconds with the heater on for the given fraction of the step
+  void step(float heaterFraction, float dtS);
+
+  float getOvenTemperature() const { return ovenC; }
+  float getSensorTemperature() const { return sensorC + noiseC; }
+  float getBoardTemperature() const { return boardC; }
+  float getTime() const { return timeS; }
+  const OvenParameters& getParameters() const { return params; }
+};
+
+#endif // OVEN_SIMULATOR_H
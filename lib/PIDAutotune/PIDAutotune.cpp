@@ -0,0 +1,162 @@
+#include "PIDAutotune.h"
+#include <math.h>
+
+#define AUTOTUNE_PI 3.14159265f
+
+RelayAutotuner::RelayAutotuner(const AutotuneConfig& config) : config(config), state(AUTOTUNE_IDLE) {
+  result.ku = 0.0f;
+  result.pu = 0.0f;
+  result.amplitudeC = 0.0f;
+  result.bias = 0.0f;
+  result.gains.kp = 0.0f;
+  result.gains.ki = 0.0f;
+  result.gains.kd = 0.0f;
+}
+
+AutotuneConfig RelayAutotuner::defaultConfig(float outputMax) {
+  AutotuneConfig c;
+  c.outputMax = outputMax;
+  c.hysteresisC = 1.0f;
+  c.cycles = 3;
+  c.timeoutS = 1800.0f;
+  c.maxTemperatureC = 260.0f;
+  c.rule = AUTOTUNE_RULE_TYREUS_LUYBEN;
+  return c;
+}
+
+void RelayAutotuner::setConfig(const AutotuneConfig& config) {
+  this->config = config;
+}
+
+void RelayAutotuner::start(float targetC, float timeS) {
+  this->targetC = targetC;
+  state = AUTOTUNE_APPROACH;
+  bias = config.outputMax / 2.0f;
+  amplitude = config.outputMax / 2.0f;
+  relayHigh = true;
+  startS = timeS;
+  lastSwitchS = timeS;
+  cycleStartS = -1.0f;
+  highS = 0.0f;
+  maxC = -1000.0f;
+  minC = 1000.0f;
+  cycle = 0;
+  periodSum = 0.0f;
+  amplitudeSum = 0.0f;
+  biasSum = 0.0f;
+  relaySum = 0.0f;
+}
+
+void RelayAutotuner::cancel() {
+  if (isRunning()) {
+    state = AUTOTUNE_FAILED;
+  }
+}
+
+float RelayAutotuner::update(float inputC, float timeS) {
+  if (isRunning() && (inputC > config.maxTemperatureC || timeS - startS > config.timeoutS)) {
+    state = AUTOTUNE_FAILED;
+  }
+
+  switch (state) {
+    case AUTOTUNE_APPROACH:
+      if (inputC < targetC - config.hysteresisC) {
+        return config.outputMax;
+      }
+      // Operating point reached: start the relay with the output low
+      state = AUTOTUNE_RELAY;
+      relayHigh = false;
+      lastSwitchS = timeS;
+      return bias - amplitude;
+
+    case AUTOTUNE_RELAY:
+      if (inputC > maxC) maxC = inputC;
+      if (inputC < minC) minC = inputC;
+      if (relayHigh && inputC > targetC + config.hysteresisC) {
+        relayHigh = false;
+        highS = timeS - lastSwitchS;
+        lastSwitchS = timeS;
+      } else if (!relayHigh && inputC < targetC - config.hysteresisC) {
+        relayHigh = true;
+        completeCycle(timeS);
+        lastSwitchS = timeS;
+      }
+      if (state != AUTOTUNE_RELAY) {
+        return 0.0f;
+      }
+      return relayHigh ? bias + amplitude : bias - amplitude;
+
+    default:
+      return 0.0f;
+  }
+}
+
+void RelayAutotuner::completeCycle(float timeS) {
+  // A cycle runs from one low -> high switch to the next
+  if (cycleStartS >= 0.0f) {
+    float period = timeS - cycleStartS;
+    float lowS = timeS - lastSwitchS;
+    cycle++;
+    // The first cycle still carries the approach transient
+    if (cycle > 1) {
+      periodSum += period;
+      amplitudeSum += (maxC - minC) / 2.0f;
+      biasSum += bias;
+      relaySum += amplitude;
+    }
+    // Shift the bias towards equal heating and cooling times
+    if (highS + lowS > 0.0f) {
+      bias += amplitude * (highS - lowS) / (highS + lowS) / 2.0f;
+      if (bias < config.outputMax * 0.05f) bias = config.outputMax * 0.05f;
+      if (bias > config.outputMax * 0.95f) bias = config.outputMax * 0.95f;
+      amplitude = bias < config.outputMax - bias ? bias : config.outputMax - bias;
+    }
+    if (cycle > config.cycles) {
+      finish();
+      return;
+    }
+  }
+  cycleStartS = timeS;
+  maxC = -1000.0f;
+  minC = 1000.0f;
+}
+
+void RelayAutotuner::finish() {
+  uint8_t n = cycle - 1;
+  result.pu = periodSum / n;
+  result.amplitudeC = amplitudeSum / n;
+  result.bias = biasSum / n;
+
+  // Describing function of a relay with hysteresis
+  float a = result.amplitudeC;
+  float e = config.hysteresisC;
+  float effective = a > e ? sqrtf(a * a - e * e) : a;
+  if (effective <= 0.0f || result.pu <= 0.0f) {
+    state = AUTOTUNE_FAILED;
+    return;
+  }
+  result.ku = 4.0f * (relaySum / n) / (AUTOTUNE_PI * effective);
+
+  float ti, td;
+  switch (config.rule) {
+    case AUTOTUNE_RULE_ZIEGLER_NICHOLS:
+      result.gains.kp = 0.6f * result.ku;
+      ti = result.pu / 2.0f;
+      td = result.pu / 8.0f;
+      break;
+    case AUTOTUNE_RULE_NO_OVERSHOOT:
+      result.gains.kp = 0.2f * result.ku;
+      ti = result.pu / 2.0f;
+      td = result.pu / 3.0f;
+      break;
+    case AUTOTUNE_RULE_TYREUS_LUYBEN:
+    default:
+      result.gains.kp = result.ku / 2.2f;
+      ti = 2.2f * result.pu;
+      td = result.pu / 6.3f;
+      break;
+  }
+  result.gains.ki = result.gains.kp / ti;
+  result.gains.kd = result.gains.kp * td;
+  state = AUTOTUNE_DONE;
+}
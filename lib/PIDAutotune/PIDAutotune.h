@@ -0,0 +1,88 @@
+#ifndef PID_AUTOTUNE_H
+#define PID_AUTOTUNE_H
+
+#include <stdint.h>
+#include "PIDController.h"
+
+enum AutotuneState {
+  AUTOTUNE_IDLE,
+  AUTOTUNE_APPROACH,   // Full power up to the operating temperature
+  AUTOTUNE_RELAY,      // Relay oscillation around the operating temperature
+  AUTOTUNE_DONE,
+  AUTOTUNE_FAILED
+};
+
+enum AutotuneRule {
+  AUTOTUNE_RULE_ZIEGLER_NICHOLS,   // Kp = 0.6 Ku, Ti = Pu / 2, Td = Pu / 8
+  AUTOTUNE_RULE_TYREUS_LUYBEN,     // Kp = Ku / 2.2, Ti = 2.2 Pu, Td = Pu / 6.3
+  AUTOTUNE_RULE_NO_OVERSHOOT       // Kp = 0.2 Ku, Ti = Pu / 2, Td = Pu / 3
+};
+
+struct AutotuneConfig {
+  float outputMax;        // Full heater output (PID output range is 0 - outputMax)
+  float hysteresisC;      // Relay hysteresis around the operating temperature
+  uint8_t cycles;         // Oscillation cycles averaged after the first one
+  float timeoutS;         // Abort if the experiment takes longer
+  float maxTemperatureC;  // Abort above this temperature
+  AutotuneRule rule;
+};
+
+struct AutotuneResult {
+  float ku;               // Ultimate gain (output units per C)
+  float pu;               // Ultimate period in seconds
+  float amplitudeC;       // Average oscillation amplitude
+  float bias;             // Output holding the operating temperature
+  PIDGains gains;
+};
+
+// Astrom-Hagglund relay feedback experiment. The heater output switches
+// between bias +- d whenever the temperature crosses the operating point
+// +- hysteresis; the resulting limit cycle gives the ultimate gain and period,
+// from which the PID gains are derived. The bias is adapted every cycle so
+// the heating and cooling half-periods become equal.
+class RelayAutotuner {
+private:
+  AutotuneConfig config;
+  AutotuneState state;
+  AutotuneResult result;
+  float targetC;
+  float bias;
+  float amplitude;        // Relay amplitude d
+  bool relayHigh;
+  float startS;
+  float lastSwitchS;
+  float cycleStartS;
+  float highS;            // Duration of the last high half-period
+  float maxC;
+  float minC;
+  uint8_t cycle;
+  float periodSum;
+  float amplitudeSum;
+  float biasSum;
+  float relaySum;
+
+  void completeCycle(float timeS);
+  void finish();
+
+public:
+  RelayAutotuner(const AutotuneConfig& config);
+
+  static AutotuneConfig defaultConfig(float outputMax);
+  void setConfig(const AutotuneConfig& config);
+  const AutotuneConfig& getConfig() const { return config; }
+
+  // Begin an experiment around targetC
+  void start(float targetC, float timeS);
+
+  // Feed the measured temperature, returns the heater output
+  float update(float inputC, float timeS);
+
+  void cancel();
+
+  AutotuneState getState() const { return state; }
+  bool isRunning() const { return state == AUTOTUNE_APPROACH || state == AUTOTUNE_RELAY; }
+  uint8_t getCycle() const { return cycle; }
+  const AutotuneResult& getResult() const { return result; }
+};
+
+#endif // PID_AUTOTUNE_H
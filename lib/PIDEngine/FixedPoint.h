@@ -0,0 +1,56 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Signed Q16.16 fixed point number with saturating arithmetic. Range is
+// +-32768 with 1/65536 resolution; overflow clamps instead of wrapping so a
+// large error times a large gain still drives the output to its limit.
+class Fixed16 {
+private:
+  int32_t raw;
+
+  static int32_t saturate(int64_t value) {
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+  }
+
+public:
+  static const int32_t ONE = 65536;
+
+  Fixed16() : raw(0) {}
+  explicit Fixed16(float value) : raw(saturate((int64_t)(value * ONE + (value >= 0.0f ? 0.5f : -0.5f)))) {}
+  explicit Fixed16(int value) : raw(saturate((int64_t)value * ONE)) {}
+
+  static Fixed16 fromRaw(int32_t raw) {
+    Fixed16 f;
+    f.raw = raw;
+    return f;
+  }
+
+  int32_t getRaw() const { return raw; }
+  explicit operator float() const { return (float)raw / ONE; }
+
+  Fixed16 operator+(Fixed16 other) const { return fromRaw(saturate((int64_t)raw + other.raw)); }
+  Fixed16 operator-(Fixed16 other) const { return fromRaw(saturate((int64_t)raw - other.raw)); }
+  Fixed16 operator-() const { return fromRaw(saturate(-(int64_t)raw)); }
+  Fixed16 operator*(Fixed16 other) const { return fromRaw(saturate(((int64_t)raw * other.raw) >> 16)); }
+  Fixed16 operator/(Fixed16 other) const {
+    if (other.raw == 0) return fromRaw(raw >= 0 ? INT32_MAX : INT32_MIN);
+    return fromRaw(saturate(((int64_t)raw << 16) / other.raw));
+  }
+
+  Fixed16& operator+=(Fixed16 other) { return *this = *this + other; }
+  Fixed16& operator-=(Fixed16 other) { return *this = *this - other; }
+  Fixed16& operator*=(Fixed16 other) { return *this = *this * other; }
+
+  bool operator<(Fixed16 other) const { return raw < other.raw; }
+  bool operator>(Fixed16 other) const { return raw > other.raw; }
+  bool operator<=(Fixed16 other) const { return raw <= other.raw; }
+  bool operator>=(Fixed16 other) const { return raw >= other.raw; }
+  bool operator==(Fixed16 other) const { return raw == other.raw; }
+  bool operator!=(Fixed16 other) const { return raw != other.raw; }
+};
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,150 @@
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+// PID gains in PID_v1 units (Ki per second, Kd in seconds)
+struct PIDGains {
+  float kp;
+  float ki;
+  float kd;
+};
+
+// PID controller templated on the numeric type (float or Fixed16).
+//
+// Gains use the same units as the br3ttb PID_v1 library (Ki per second, Kd in
+// seconds) so the existing constants keep their meaning. Compared to PID_v1:
+// - compute() is called by the owner at the sample time, no millis() inside
+// - the integrator stops while the output is saturated in the error direction
+//   (conditional integration) instead of relying on clamping alone
+// - the derivative acts on the measurement, optionally from an external rate
+// - setTunings() shifts the integral so the output does not jump
+template <typename T>
+class PIDController {
+private:
+  T kp;
+  T ki;            // Ki * sample time
+  T kd;            // Kd / sample time
+  float kpValue, kiValue, kdValue;
+  float sampleTimeS;
+  T outMin;
+  T outMax;
+  T integral;
+  T lastInput;
+  T lastError;
+  T lastDerivative;  // Last measurement change per sample
+  T output;
+  bool initialized;
+
+  T clamp(T value) const {
+    if (value > outMax) return outMax;
+    if (value < outMin) return outMin;
+    return value;
+  }
+
+  // The integral may leave the output range by one span so a tuning change
+  // can be absorbed; conditional integration keeps it from winding up
+  T clampIntegral(T value) const {
+    T span = outMax - outMin;
+    if (value > outMax + span) return outMax + span;
+    if (value < outMin - span) return outMin - span;
+    return value;
+  }
+
+  void scaleGains() {
+    kp = T(kpValue);
+    ki = T(kiValue * sampleTimeS);
+    kd = T(kdValue / sampleTimeS);
+  }
+
+  T step(T setpoint, T input, T inputChange) {
+    T error = setpoint - input;
+    if (!initialized) {
+      reset(input, output);
+    }
+
+    // Conditional integration: freeze the integrator while saturated in the error direction
+    T proportional = kp * error;
+    T derivative = kd * inputChange;
+    T unclamped = proportional + integral - derivative;
+    bool saturatedHigh = unclamped >= outMax && error > T(0);
+    bool saturatedLow = unclamped <= outMin && error < T(0);
+    if (!saturatedHigh && !saturatedLow) {
+      integral = clampIntegral(integral + ki * error);
+    }
+
+    output = clamp(proportional + integral - derivative);
+    lastInput = input;
+    lastError = error;
+    lastDerivative = inputChange;
+    return output;
+  }
+
+public:
+  PIDController()
+    : kpValue(0.0f), kiValue(0.0f), kdValue(0.0f), sampleTimeS(1.0f), outMin(T(0)), outMax(T(1)),
+      integral(T(0)), lastInput(T(0)), lastError(T(0)), lastDerivative(T(0)), output(T(0)), initialized(false) {
+    scaleGains();
+  }
+
+  void setSampleTime(float sampleTimeS) {
+    if (sampleTimeS > 0.0f) {
+      this->sampleTimeS = sampleTimeS;
+      scaleGains();
+    }
+  }
+
+  void setOutputLimits(float min, float max) {
+    if (min >= max) return;
+    outMin = T(min);
+    outMax = T(max);
+    integral = clampIntegral(integral);
+    output = clamp(output);
+  }
+
+  // Bumpless: the integral absorbs the change of the P and D contributions
+  void setTunings(float kp, float ki, float kd) {
+    if (kp < 0.0f || ki < 0.0f || kd < 0.0f) return;
+    T before = this->kp * lastError - this->kd * lastDerivative;
+    kpValue = kp;
+    kiValue = ki;
+    kdValue = kd;
+    scaleGains();
+    if (initialized) {
+      T after = this->kp * lastError - this->kd * lastDerivative;
+      integral = clampIntegral(integral + before - after);
+    }
+  }
+
+  void setTunings(const PIDGains& gains) {
+    setTunings(gains.kp, gains.ki, gains.kd);
+  }
+
+  // Start from the given input and output without a bump
+  void reset(T input, T currentOutput) {
+    lastInput = input;
+    lastError = T(0);
+    lastDerivative = T(0);
+    output = clamp(currentOutput);
+    integral = output;
+    initialized = true;
+  }
+
+  // Derivative from the change of the measurement since the last call
+  T compute(T setpoint, T input) {
+    T change = initialized ? input - lastInput : T(0);
+    return step(setpoint, input, change);
+  }
+
+  // Derivative from an external measurement rate in units per second
+  T compute(T setpoint, T input, T inputRate) {
+    return step(setpoint, input, inputRate * T(sampleTimeS));
+  }
+
+  T getOutput() const { return output; }
+  T getIntegral() const { return integral; }
+  float getKp() const { return kpValue; }
+  float getKi() const { return kiValue; }
+  float getKd() const { return kdValue; }
+  float getSampleTime() const { return sampleTimeS; }
+};
+
+#endif // PID_CONTROLLER_H
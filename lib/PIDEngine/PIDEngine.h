@@ -0,0 +1,9 @@
+#ifndef PID_ENGINE_H
+#define PID_ENGINE_H
+
+// In-tree PID engine: PIDController<float> uses the ESP32 single precision
+// FPU, PIDController<Fixed16> runs in Q16.16 integer arithmetic.
+#include "FixedPoint.h"
+#include "PIDController.h"
+
+#endif // PID_ENGINE_H
@@ -0,0 +1,76 @@
+/*
+ * PIDEngine cycle-count benchmark
+ *
+ * Runs the same closed loop through the PID_v1 (double) path used by the
+ * reflow controller before, PIDController<float> and PIDController<Fixed16>
+ * and prints the CPU cycles per compute. Needs the br3ttb/PID library
+ * (PID_v1.h) in addition to PIDEngine.
+ */
+
+#include <Arduino.h>
+#include <PID_v1.h>
+#include "PIDEngine.h"
+
+#define ITERATIONS 2000
+
+// Reflow gains
+#define KP 300.0
+#define KI 0.05
+#define KD 350.0
+
+// Simple first-order oven so the three controllers see realistic inputs
+static float plant(float temperature, float output) {
+  return temperature + (output / 2000.0f * 2.0f - (temperature - 25.0f) * 0.0073f) * 1.0f;
+}
+
+uint32_t benchmarkPIDv1() {
+  double input = 25.0, output = 0.0, setpoint = 217.0;
+  PID pid(&input, &output, &setpoint, KP, KI, KD, DIRECT);
+  pid.SetOutputLimits(0, 2000);
+  pid.SetSampleTime(1);
+  pid.SetMode(AUTOMATIC);
+
+  uint32_t cycles = 0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    // PID_v1 only computes once per sample time
+    delay(1);
+    uint32_t start = ESP.getCycleCount();
+    pid.Compute();
+    cycles += ESP.getCycleCount() - start;
+    input = plant(input, output);
+  }
+  return cycles / ITERATIONS;
+}
+
+template <typename T>
+uint32_t benchmarkEngine() {
+  float input = 25.0f;
+  PIDController<T> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, 2000);
+  pid.setTunings(KP, KI, KD);
+  pid.reset(T(input), T(0));
+
+  uint32_t cycles = 0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    T in = T(input);
+    uint32_t start = ESP.getCycleCount();
+    T out = pid.compute(T(217.0f), in);
+    cycles += ESP.getCycleCount() - start;
+    input = plant(input, (float)out);
+  }
+  return cycles / ITERATIONS;
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println("PID compute cost (cycles per call)");
+  Serial.println("PID_v1 double:           " + String(benchmarkPIDv1()));
+  Serial.println("PIDController<float>:    " + String(benchmarkEngine<float>()));
+  Serial.println("PIDController<Fixed16>:  " + String(benchmarkEngine<Fixed16>()));
+}
+
+void loop() {
+}
@@ -0,0 +1,240 @@
+#include "PlantModel.h"
+#include <math.h>
+
+float PlantModel::steadyStateDuty(float temperatureC) const {
+  if (!valid || gainC <= 0.0f) return 0.0f;
+  float duty = (temperatureC - ambientC) / gainC;
+  return duty > 0.0f ? duty : 0.0f;
+}
+
+float PlantModel::maxRate(float temperatureC) const {
+  if (!valid || tauS <= 0.0f) return 0.0f;
+  return (gainC - (temperatureC - ambientC)) / tauS;
+}
+
+float PlantModel::feedForwardDuty(float temperatureC, float rateCPerS) const {
+  if (!valid || gainC <= 0.0f) return 0.0f;
+  float duty = ((temperatureC - ambientC) + tauS * rateCPerS) / gainC;
+  if (duty < 0.0f) return 0.0f;
+  if (duty > 1.0f) return 1.0f;
+  return duty;
+}
+
+// ***** PlantModelFit *****
+
+PlantModelFit::PlantModelFit(float samplePeriodS, float maxDeadTimeS) : samplePeriodS(samplePeriodS) {
+  int delay = (int)(maxDeadTimeS / samplePeriodS + 0.5f);
+  if (delay < 0) delay = 0;
+  if (delay > PLANT_FIT_MAX_DELAY) delay = PLANT_FIT_MAX_DELAY;
+  maxDelay = (uint8_t)delay;
+  reset();
+}
+
+void PlantModelFit::reset() {
+  history = 0;
+  started = false;
+  origin = 0.0;
+  lastT = 0.0;
+  for (uint8_t d = 0; d <= PLANT_FIT_MAX_DELAY; d++) {
+    rows[d] = 0;
+    for (uint8_t i = 0; i < 6; i++) xx[d][i] = 0.0;
+    for (uint8_t i = 0; i < 3; i++) xy[d][i] = 0.0;
+    yy[d] = 0.0;
+    dutyHistory[d] = 0.0f;
+  }
+}
+
+void PlantModelFit::addSample(float temperatureC, float duty) {
+  if (!started) {
+    origin = temperatureC;
+    started = true;
+  } else {
+    double y = temperatureC - origin;
+    double x0 = lastT - origin;
+    for (uint8_t d = 0; d <= maxDelay && d < history; d++) {
+      double x1 = dutyHistory[d];
+      xx[d][0] += x0 * x0;
+      xx[d][1] += x0 * x1;
+      xx[d][2] += x0;
+      xx[d][3] += x1 * x1;
+      xx[d][4] += x1;
+      xx[d][5] += 1.0;
+      xy[d][0] += x0 * y;
+      xy[d][1] += x1 * y;
+      xy[d][2] += y;
+      yy[d] += y * y;
+      rows[d]++;
+    }
+  }
+
+  for (uint8_t i = maxDelay; i > 0; i--) {
+    dutyHistory[i] = dutyHistory[i - 1];
+  }
+  dutyHistory[0] = duty;
+  if (history <= maxDelay) history++;
+  lastT = temperatureC;
+}
+
+// Solve the 3x3 normal equations by Gaussian elimination with partial pivoting
+static bool solve3(double m[3][4], double x[3]) {
+  for (int col = 0; col < 3; col++) {
+    int pivot = col;
+    for (int r = col + 1; r < 3; r++) {
+      if (fabs(m[r][col]) > fabs(m[pivot][col])) pivot = r;
+    }
+    if (fabs(m[pivot][col]) < 1e-12) return false;
+    if (pivot != col) {
+      for (int c = 0; c < 4; c++) {
+        double t = m[col][c];
+        m[col][c] = m[pivot][c];
+        m[pivot][c] = t;
+      }
+    }
+    for (int r = col + 1; r < 3; r++) {
+      double f = m[r][col] / m[col][col];
+      for (int c = col; c < 4; c++) m[r][c] -= f * m[col][c];
+    }
+  }
+  for (int r = 2; r >= 0; r--) {
+    double s = m[r][3];
+    for (int c = r + 1; c < 3; c++) s -= m[r][c] * x[c];
+    x[r] = s / m[r][r];
+  }
+  return true;
+}
+
+PlantModel PlantModelFit::fit() const {
+  PlantModel best;
+  best.valid = 0;
+  best.gainC = 0.0f;
+  best.tauS = 0.0f;
+  best.deadTimeS = 0.0f;
+  best.ambientC = 0.0f;
+  best.rmsErrorC = 0.0f;
+  double bestMse = -1.0;
+
+  for (uint8_t d = 0; d <= maxDelay; d++) {
+    if (rows[d] < 10) continue;
+    double m[3][4] = {
+      {xx[d][0], xx[d][1], xx[d][2], xy[d][0]},
+      {xx[d][1], xx[d][3], xx[d][4], xy[d][1]},
+      {xx[d][2], xx[d][4], xx[d][5], xy[d][2]},
+    };
+    double theta[3];
+    if (!solve3(m, theta)) continue;
+    double a = theta[0];
+    double b = theta[1];
+    double c = theta[2];
+    // Only a stable plant heated by the SSR is meaningful
+    if (a <= 0.0 || a >= 1.0 || b <= 0.0) continue;
+
+    double sse = yy[d] - (theta[0] * xy[d][0] + theta[1] * xy[d][1] + theta[2] * xy[d][2]);
+    double mse = sse > 0.0 ? sse / rows[d] : 0.0;
+    if (bestMse >= 0.0 && mse >= bestMse) continue;
+
+    bestMse = mse;
+    best.valid = 1;
+    best.tauS = (float)(-samplePeriodS / log(a));
+    best.gainC = (float)(b / (1.0 - a));
+    best.ambientC = (float)(origin + c / (1.0 - a));
+    best.deadTimeS = d * samplePeriodS;
+    best.rmsErrorC = (float)sqrt(mse);
+  }
+  return best;
+}
+
+// ***** OvenCharacterizer *****
+
+OvenCharacterizer::OvenCharacterizer(const CharacterizeConfig& config)
+  : config(config), state(CHARACTERIZE_IDLE), fitter(config.samplePeriodS, config.maxDeadTimeS),
+    startS(0.0f), stepStartS(0.0f), duty(0.0f) {
+  model.valid = 0;
+}
+
+CharacterizeConfig OvenCharacterizer::defaultConfig() {
+  CharacterizeConfig c;
+  c.samplePeriodS = 1.0f;
+  c.baselineS = 30.0f;
+  c.stepDuty = 1.0f;
+  c.peakC = 150.0f;
+  c.coolDropC = 30.0f;
+  c.holdDuty = 0.35f;
+  c.holdS = 300.0f;
+  c.maxDeadTimeS = 20.0f;
+  c.timeoutS = 1800.0f;
+  c.maxTemperatureC = 250.0f;
+  return c;
+}
+
+void OvenCharacterizer::setConfig(const CharacterizeConfig& config) {
+  this->config = config;
+  fitter = PlantModelFit(config.samplePeriodS, config.maxDeadTimeS);
+}
+
+void OvenCharacterizer::start(float timeS) {
+  fitter.reset();
+  model.valid = 0;
+  startS = timeS;
+  enter(CHARACTERIZE_BASELINE, timeS);
+}
+
+void OvenCharacterizer::cancel() {
+  if (isRunning()) {
+    enter(CHARACTERIZE_FAILED, 0.0f);
+  }
+}
+
+void OvenCharacterizer::enter(CharacterizeState next, float timeS) {
+  state = next;
+  stepStartS = timeS;
+  switch (next) {
+    case CHARACTERIZE_HEAT: duty = config.stepDuty; break;
+    case CHARACTERIZE_HOLD: duty = config.holdDuty; break;
+    default:                duty = 0.0f; break;
+  }
+}
+
+float OvenCharacterizer::update(float temperatureC, float timeS) {
+  if (!isRunning()) return 0.0f;
+  if (temperatureC > config.maxTemperatureC || timeS - startS > config.timeoutS) {
+    enter(CHARACTERIZE_FAILED, timeS);
+    return 0.0f;
+  }
+
+  float inStep = timeS - stepStartS;
+  switch (state) {
+    case CHARACTERIZE_BASELINE:
+      if (inStep >= config.baselineS) enter(CHARACTERIZE_HEAT, timeS);
+      break;
+    case CHARACTERIZE_HEAT:
+      if (temperatureC >= config.peakC) enter(CHARACTERIZE_COOL, timeS);
+      break;
+    case CHARACTERIZE_COOL:
+      if (temperatureC <= config.peakC - config.coolDropC) enter(CHARACTERIZE_HOLD, timeS);
+      break;
+    case CHARACTERIZE_HOLD:
+      if (inStep >= config.holdS) {
+        model = fitter.fit();
+        enter(model.valid ? CHARACTERIZE_DONE : CHARACTERIZE_FAILED, timeS);
+      }
+      break;
+    default:
+      break;
+  }
+
+  fitter.addSample(temperatureC, duty);
+  return duty;
+}
+
+const char* OvenCharacterizer::stateName(CharacterizeState state) {
+  switch (state) {
+    case CHARACTERIZE_IDLE:     return "idle";
+    case CHARACTERIZE_BASELINE: return "baseline";
+    case CHARACTERIZE_HEAT:     return "heat step";
+    case CHARACTERIZE_COOL:     return "cool";
+    case CHARACTERIZE_HOLD:     return "hold step";
+    case CHARACTERIZE_DONE:     return "done";
+    case CHARACTERIZE_FAILED:   return "failed";
+  }
+  return "";
+}
@@ -0,0 +1,119 @@
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include <stdint.h>
+
+// First-order-plus-dead-time model of the oven as seen by the thermocouple:
+//   tau * dT/dt = K * u(t - deadTime) - (T - ambient)
+// with u the heater duty (0 - 1). Stored in NVS as bytes.
+struct PlantModel {
+  uint8_t valid;
+  float gainC;          // K: steady-state rise above ambient at full power
+  float tauS;           // Time constant
+  float deadTimeS;      // Transport delay from SSR to thermocouple
+  float ambientC;
+  float rmsErrorC;      // One-step prediction error of the fit
+
+  // Duty that holds the temperature (feed-forward), may exceed 1 if unreachable
+  float steadyStateDuty(float temperatureC) const;
+  // Fastest possible heating rate in C/s at the temperature
+  float maxRate(float temperatureC) const;
+  // Duty that covers the loss at the temperature and heats at the rate (0 - 1)
+  float feedForwardDuty(float temperatureC, float rateCPerS) const;
+};
+
+// Least-squares fit of the discrete model
+//   T[k+1] = a * T[k] + b * u[k-d] + c
+// for every dead time d up to maxDeadTimeS, keeping the d with the smallest
+// residual. Only the normal equations are accumulated, so no samples are
+// stored and any excitation sequence can be used.
+#define PLANT_FIT_MAX_DELAY 30
+
+class PlantModelFit {
+private:
+  float samplePeriodS;
+  uint8_t maxDelay;
+  uint8_t history;          // Valid entries in dutyHistory
+  float dutyHistory[PLANT_FIT_MAX_DELAY + 1];   // [0] is the latest duty
+  double origin;            // First temperature, improves conditioning
+  double lastT;
+  bool started;
+  uint32_t rows[PLANT_FIT_MAX_DELAY + 1];
+  // Per delay: sums of x*x (6), x*y (3) and y*y
+  double xx[PLANT_FIT_MAX_DELAY + 1][6];
+  double xy[PLANT_FIT_MAX_DELAY + 1][3];
+  double yy[PLANT_FIT_MAX_DELAY + 1];
+
+public:
+  PlantModelFit(float samplePeriodS, float maxDeadTimeS);
+
+  void reset();
+
+  // Measured temperature and the duty applied until the next sample
+  void addSample(float temperatureC, float duty);
+
+  uint32_t getSamples() const { return rows[0]; }
+
+  // Best model, valid = 0 if the data does not identify a stable plant
+  PlantModel fit() const;
+};
+
+enum CharacterizeState {
+  CHARACTERIZE_IDLE,
+  CHARACTERIZE_BASELINE,    // Heater off, records the starting drift
+  CHARACTERIZE_HEAT,        // Step up to the peak temperature
+  CHARACTERIZE_COOL,        // Heater off until the temperature has dropped
+  CHARACTERIZE_HOLD,        // Partial duty step
+  CHARACTERIZE_DONE,
+  CHARACTERIZE_FAILED
+};
+
+struct CharacterizeConfig {
+  float samplePeriodS;      // update() interval
+  float baselineS;
+  float stepDuty;
+  float peakC;              // Heat step ends here
+  float coolDropC;          // Cool step ends this far below the peak
+  float holdDuty;
+  float holdS;
+  float maxDeadTimeS;
+  float timeoutS;
+  float maxTemperatureC;
+};
+
+// Guided characterization run: off, heat step to the peak, cool, partial
+// duty step. Every sample goes into a PlantModelFit, the model is fitted
+// when the sequence ends.
+class OvenCharacterizer {
+private:
+  CharacterizeConfig config;
+  CharacterizeState state;
+  PlantModelFit fitter;
+  PlantModel model;
+  float startS;
+  float stepStartS;
+  float duty;
+
+  void enter(CharacterizeState next, float timeS);
+
+public:
+  OvenCharacterizer(const CharacterizeConfig& config);
+
+  static CharacterizeConfig defaultConfig();
+  void setConfig(const CharacterizeConfig& config);
+
+  void start(float timeS);
+
+  // Feed the measured temperature every sample period, returns the duty (0 - 1)
+  float update(float temperatureC, float timeS);
+
+  void cancel();
+
+  CharacterizeState getState() const { return state; }
+  bool isRunning() const { return state > CHARACTERIZE_IDLE && state < CHARACTERIZE_DONE; }
+  const PlantModel& getModel() const { return model; }
+
+  static const char* stateName(CharacterizeState state);
+};
+
+#endif // PLANT_MODEL_H
@@ -0,0 +1,42 @@
+#include "SmithPredictor.h"
+#include <math.h>
+
+SmithPredictor::SmithPredictor() : a(0.0f), delay(0), predictedC(0.0f), head(0), enabled(false) {
+  model.valid = 0;
+  for (uint8_t i = 0; i <= SMITH_MAX_DELAY; i++) history[i] = 0.0f;
+}
+
+void SmithPredictor::configure(const PlantModel& model, float samplePeriodS) {
+  this->model = model;
+  enabled = false;
+  if (!model.valid || model.tauS <= 0.0f || samplePeriodS <= 0.0f) return;
+
+  int samples = (int)(model.deadTimeS / samplePeriodS + 0.5f);
+  if (samples < 1) return;
+  if (samples > SMITH_MAX_DELAY) samples = SMITH_MAX_DELAY;
+  delay = (uint8_t)samples;
+  a = expf(-samplePeriodS / model.tauS);
+  enabled = true;
+}
+
+void SmithPredictor::reset(float temperatureC) {
+  predictedC = temperatureC;
+  for (uint8_t i = 0; i <= SMITH_MAX_DELAY; i++) history[i] = temperatureC;
+  head = 0;
+}
+
+float SmithPredictor::correct(float measuredC) const {
+  if (!enabled) return measuredC;
+  // history[head] is the model output delay samples ago
+  return measuredC + predictedC - history[head];
+}
+
+void SmithPredictor::update(float duty) {
+  if (!enabled) return;
+  if (duty < 0.0f) duty = 0.0f;
+  if (duty > 1.0f) duty = 1.0f;
+  predictedC = a * predictedC + (1.0f - a) * (model.ambientC + model.gainC * duty);
+  // Ring of the last delay + 1 outputs: overwrite the oldest, advance to the next oldest
+  history[head] = predictedC;
+  head = (head + 1) % (delay + 1);
+}
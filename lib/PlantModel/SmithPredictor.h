@@ -0,0 +1,45 @@
+#ifndef SMITH_PREDICTOR_H
+#define SMITH_PREDICTOR_H
+
+#include "PlantModel.h"
+
+// Longest dead time the predictor can compensate, in samples
+#define SMITH_MAX_DELAY 64
+
+// Smith predictor around the PID. An internal copy of the plant model runs
+// with and without the dead time; the PID acts on
+//   measurement + (undelayed model - delayed model)
+// i.e. on the temperature the thermocouple will show once the heat already
+// applied has arrived. In steady state both model outputs are equal, so a
+// gain or ambient error of the model does not offset the controlled value.
+class SmithPredictor {
+private:
+  PlantModel model;
+  float a;                  // Discrete pole exp(-Ts / tau)
+  uint8_t delay;            // Dead time in samples
+  float predictedC;         // Undelayed model output
+  float history[SMITH_MAX_DELAY + 1];
+  uint8_t head;
+  bool enabled;
+
+public:
+  SmithPredictor();
+
+  // Enabled only for a valid model with a dead time of at least one sample
+  void configure(const PlantModel& model, float samplePeriodS);
+  bool isEnabled() const { return enabled; }
+
+  // Start from a steady oven at the temperature
+  void reset(float temperatureC);
+
+  // Temperature the controller should act on
+  float correct(float measuredC) const;
+
+  // Advance the internal model by one sample with the applied duty (0 - 1)
+  void update(float duty);
+
+  float getPrediction() const { return predictedC; }
+  float getDeadTime() const { return enabled ? model.deadTimeS : 0.0f; }
+};
+
+#endif // SMITH_PREDICTOR_H
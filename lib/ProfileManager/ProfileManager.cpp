@@ -15,16 +15,6 @@ ProfileManager::~ProfileManager() {
   // Cleanup if needed
 }
 
-// Helper function to convert data to bytes
-template <typename T> 
-unsigned int ProfileManager::convert_to_byte(const T& value, uint8_t output[sizeof(profile_t)], int multiplier) {
-  const byte * p = (const byte*) &value;
-  unsigned int i;
-  for (i = 0; i < sizeof value; i++)
-    output[multiplier * i] = (*p++);
-  return i;
-}
-
 // Parse JSON profile from file
 void ProfileManager::parseJsonProfile(fs::FS &fs, String fileName, int profileIndex, profile_t* profile) {
   StaticJsonDocument<500> newDoc;
@@ -41,7 +31,7 @@ void ProfileManager::parseJsonProfile(fs::FS &fs, String fileName, int profileIn
   }
 
   // Allocate a temporary JsonDocument
-  StaticJsonDocument<1280> doc;
+  StaticJsonDocument<2048> doc;
 
   // Deserialize the JSON document
   DeserializationError error = deserializeJson(doc, file);
@@ -81,6 +71,28 @@ void ProfileManager::parseJsonProfile(fs::FS &fs, String fileName, int profileIn
   profile[profileIndex].stages_cool_0    = stages["cool"][0];    // 240
   profile[profileIndex].stages_cool_1    = stages["cool"][1];    // 183
 
+  // Optional heating rate limit in C/s, stored in 0.1 C/s
+  float maxRampRate = doc["max_ramp_rate"] | 0.0f;
+  profile[profileIndex].max_ramp_rate = (uint8_t)constrain(maxRampRate * 10.0f + 0.5f, 0.0f, 255.0f);
+
+  // Optional gain schedule: [{"temperature": 150, "phase": "soak", "kp": 300, "ki": 0.05, "kd": 250}, ...]
+  JsonArray schedule = doc["gain_schedule"];
+  uint8_t points = 0;
+  for (JsonObject point : schedule) {
+    if (points >= GAIN_SCHEDULE_SIZE) {
+      Serial.println("Gain schedule truncated to " + String(GAIN_SCHEDULE_SIZE) + " entries");
+      break;
+    }
+    GainPoint& p = profile[profileIndex].gain_schedule[points];
+    p.temperature = point["temperature"];
+    p.phase = GainSchedule::phaseFromName(point["phase"].as<const char*>());
+    p.gains.kp = point["kp"];
+    p.gains.ki = point["ki"];
+    p.gains.kd = point["kd"];
+    points++;
+  }
+  profile[profileIndex].gain_points = points;
+
   file.close();
 
   // Print profile data for debugging
@@ -100,7 +112,8 @@ void ProfileManager::parseJsonProfile(fs::FS &fs, String fileName, int profileIn
                  + String(profile[profileIndex].stages_reflow_0) + ","
                  + String(profile[profileIndex].stages_reflow_1) + ","
                  + String(profile[profileIndex].stages_cool_0) + ","
-                 + String(profile[profileIndex].stages_cool_1));
+                 + String(profile[profileIndex].stages_cool_1) + ","
+                 + String(profile[profileIndex].gain_points) + " gain points");
 
   // Build array for serialization
   array.add(profile[profileIndex].title);
@@ -136,13 +149,14 @@ void ProfileManager::saveProfiles(int profileIndex, profile_t profile) {
   preferences.begin(spaceName);
 
   uint8_t content[sizeof(profile_t)];
-  convert_to_byte(profile, content, 0);
+  memcpy(content, &profile, sizeof(profile_t));
 
   // Get the possible length of saved array
   size_t schLen = sizeof(profile_t);
   
-  // Put all bytes into "profiles"
+  // Put all bytes into "profiles", with the layout they were written in
   preferences.putBytes(spaceName, content, schLen);
+  preferences.putUChar("version", PROFILE_STORE_VERSION);
   
   // Test read the data back and test their correct number
   char buffer[schLen];
@@ -178,6 +192,14 @@ void ProfileManager::loadProfiles(int profileIndex, profile_t* profile) {
   
   // Check, that Preferences are not empty
   if (schLen > 0) {
+    // Blobs of another profile_t layout are ignored, the JSON profile is used
+    uint8_t version = preferences.getUChar("version", 1);
+    if (version != PROFILE_STORE_VERSION) {
+      Serial.println("Saved profile " + String(profileIndex) + " has layout v" + String(version)
+                     + ", expected v" + String(PROFILE_STORE_VERSION) + ": ignored");
+      preferences.end();
+      return;
+    }
     if (schLen % sizeof(profile_t)) {
       Serial.println("Data is not correct size!");
       preferences.end();
@@ -258,6 +280,14 @@ void ProfileManager::printProfileInfo(profile_t profile, int profileIndex) {
   Serial.println("Soak: " + String(profile.stages_soak_0) + "°C - " + String(profile.stages_soak_1) + "°C");
   Serial.println("Reflow: " + String(profile.stages_reflow_0) + "°C - " + String(profile.stages_reflow_1) + "°C");
   Serial.println("Cool: " + String(profile.stages_cool_0) + "°C - " + String(profile.stages_cool_1) + "°C");
+  if (profile.max_ramp_rate > 0) {
+    Serial.println("Max ramp rate: " + String(profile.max_ramp_rate / 10.0f) + "°C/s");
+  }
+  for (int i = 0; i < profile.gain_points && i < GAIN_SCHEDULE_SIZE; i++) {
+    const GainPoint& p = profile.gain_schedule[i];
+    Serial.println("Gains at " + String(p.temperature) + "°C (" + GainSchedule::phaseName(p.phase) + "): "
+                   + String(p.gains.kp) + "/" + String(p.gains.ki, 4) + "/" + String(p.gains.kd));
+  }
   Serial.println("========================");
 }
 
@@ -6,7 +6,7 @@
 #include <Preferences.h>
 #include <FS.h>
 #include <Wire.h>
-#include <Adafruit_MCP9600.h>
+#include "GainSchedule.h"
 
 // Profile structure definition
 typedef struct {
@@ -26,16 +26,21 @@ typedef struct {
   uint16_t stages_reflow_1;    // Reflow stage end temperature
   uint16_t stages_cool_0;      // Cool stage start temperature
   uint16_t stages_cool_1;      // Cool stage end temperature
+  uint8_t max_ramp_rate;       // Max heating rate in 0.1 C/s (0 = controller default)
+  uint8_t gain_points;         // Entries used in gain_schedule (0 = oven-wide gains)
+  GainPoint gain_schedule[GAIN_SCHEDULE_SIZE]; // Temperature-scheduled PID gains
 } profile_t;
 
+// Layout of profile_t saved in NVS, stored next to each profile blob.
+// Bump it whenever profile_t changes; loadProfiles() ignores blobs of any
+// other version and the profile is taken from its JSON file again.
+// 1: original layout (no version key), 2: max_ramp_rate and gain schedule
+#define PROFILE_STORE_VERSION 2
+
 class ProfileManager {
 private:
   Preferences preferences;
   char spaceName[16];
-  
-  // Helper function to convert data to bytes
-  template <typename T> 
-  unsigned int convert_to_byte(const T& value, uint8_t output[sizeof(profile_t)], int multiplier);
 
 public:
   ProfileManager();
@@ -57,6 +62,6 @@ public:
   void printProfileInfo(profile_t profile, int profileIndex);
 };
 
-// MCP9600Manager removed - using Adafruit library directly
+// MCP9600Manager removed - thermocouples are read by the MCP9600Sensor library
 
 #endif // PROFILE_MANAGER_H
@@ -0,0 +1,423 @@
+#ifndef REFLOW_SEQUENCER_H
+#define REFLOW_SEQUENCER_H
+
+#include <stdint.h>
+#include "PIDEngine.h"
+#include "PlantModel.h"
+#include "SmithPredictor.h"
+#include "SetpointTrajectory.h"
+#include "GainSchedule.h"
+#include "BoardObserver.h"
+#include "IterativeLearning.h"
+#include "ModelPredictive.h"
+#include "ControlClock.h"
+
+// Stage of a profile run
+enum SequencerStage {
+  SEQUENCER_IDLE,
+  SEQUENCER_PREHEAT,
+  SEQUENCER_SOAK,
+  SEQUENCER_REFLOW,
+  SEQUENCER_COOL,
+  SEQUENCER_COMPLETE
+};
+
+// Temperature a phase regulates on
+enum ControlVariable {
+  CONTROL_VARIABLE_AIR,     // Thermocouple (oven air)
+  CONTROL_VARIABLE_BOARD    // Board observer estimate
+};
+
+// PID gains per reflow phase, loaded from NVS and written by the autotuner
+struct OvenGains {
+  PIDGains preheat;
+  PIDGains soak;
+  PIDGains reflow;
+};
+
+// The part of a paste profile a run needs
+struct SequencerProfile {
+  float preheatC;           // End of preheat
+  float soakC;              // End of soak
+  float peakC;              // Reflow peak
+  float coolC;              // End of the trajectory's cooling segment
+  float durationS;          // Time budget of the profile
+  float maxRampRate;        // C/s heating limit of the model-predictive controller
+  const GainPoint* gainSchedule;  // Temperature-scheduled gains (0 points = phase gains)
+  uint8_t gainPoints;
+};
+
+struct SequencerConfig {
+  float samplePeriodS;      // Control period
+  float windowSize;         // Output at full duty (SSR window in ms)
+  TrajectoryRates rates;
+  float maxLagC;            // The trajectory clock holds while the oven lags by more
+  float coolEndC;           // The run completes at or below this
+  bool feedForward;
+  PlantModel fallbackModel; // Feed-forward model until the oven is characterized
+  float lookaheadS;         // Feed-forward slope lookahead without a model dead time
+  bool deadTimeCompensation;
+  float peakMarginC;        // REFLOW cut-off below the peak, uncompensated
+  float peakMarginCompensatedC;
+  BoardModel board;
+  bool exitOnBoard;         // Cut off on the board observer's predicted peak, characterized ovens only
+  float boardPeakHorizonS;
+  float peakHoldMaxS;       // Longest hold at the peak once the trajectory is cooling
+  float reflowMaxS;         // Longest REFLOW stage from its start, trajectory paused or not
+  uint8_t controlVariable[3];  // ControlVariable of PREHEAT, SOAK and REFLOW
+  bool modelPredictive;
+  float mpcMoveWeight;
+};
+
+// Profile run of the reflow state machine without the hardware: advances the
+// setpoint trajectory, switches the phase gains, decides the REFLOW cut-off
+// and the end of cooling, and computes the heater output (PID with
+// feed-forward, dead-time compensation or the board estimate, or the
+// model-predictive controller). The firmware calls it from the control task
+// with the ArduinoClock, the native tests with a VirtualClock.
+//
+// Templated on the numeric type of the PID and MPC like PIDController.
+template <typename T>
+class ReflowSequencer {
+private:
+  SequencerConfig config;
+  OvenGains gains;
+  SequencerProfile profile;
+  PIDController<T> pid;
+  MPCController<T> mpc;
+  bool mpcActive;
+  bool boardExit;
+  SmithPredictor smithPredictor;
+  SetpointTrajectory trajectory;
+  GainSchedule gainSchedule;
+  BoardObserver boardObserver;
+  PlantModel feedForwardModel;
+  IterativeLearning* learning;
+
+  SequencerStage stage;
+  float trajectoryTimeS;
+  bool holding;
+  uint32_t holdStartMs;
+  uint32_t reflowStartMs;
+  uint32_t trajectoryLastMs;
+  uint32_t nextComputeMs;
+  uint32_t sampleMs;
+  float setpoint;
+  float output;
+  float feedForward;
+  float boardTemperature;
+
+  static float clamp(float value, float low, float high) {
+    return value < low ? low : (value > high ? high : value);
+  }
+
+  // Advance the trajectory clock and setpoint, returns the trajectory phase
+  TrajectoryPhase advanceTrajectory(uint32_t nowMs, float temperatureC) {
+    float dt = timeElapsed(nowMs, trajectoryLastMs) / 1000.0f;
+    trajectoryLastMs = nowMs;
+    // Hold the clock while the oven cannot follow so the ramp resumes where it was
+    if (setpoint - temperatureC < config.maxLagC) {
+      trajectoryTimeS += dt;
+    }
+    setpoint = trajectory.evaluate(trajectoryTimeS);
+    return (TrajectoryPhase)trajectory.phaseAt(trajectoryTimeS);
+  }
+
+  // REFLOW heater cut-off. The board observer cuts once the joints will reach
+  // the peak with the heat already in the oven; its estimate is only trusted
+  // on a characterized oven. Without it the heater is cut early to absorb the
+  // transport lag; the Smith predictor knows the heat still on its way and
+  // cuts at the peak itself
+  bool peakReached(float temperatureC) const {
+    if (boardExit && boardObserver.isConfigured()) {
+      return boardObserver.predictBoardPeak(config.boardPeakHorizonS) >= profile.peakC;
+    }
+    if (smithPredictor.isEnabled()) {
+      return smithPredictor.correct(temperatureC) >= profile.peakC - config.peakMarginCompensatedC;
+    }
+    return temperatureC >= profile.peakC - config.peakMarginC;
+  }
+
+  // Heater on-time (output units) that covers the loss at the current
+  // temperature and follows the trajectory slope ahead by the oven's dead time
+  float computeFeedForward(float temperatureC) {
+    if (!config.feedForward || stage < SEQUENCER_PREHEAT || stage > SEQUENCER_REFLOW) {
+      return 0;
+    }
+    float slope = 0;
+    float lookahead = feedForwardModel.deadTimeS > 0 ? feedForwardModel.deadTimeS : config.lookaheadS;
+    // REFLOW holds the peak once the trajectory, or the lookahead, has moved on to
+    // cooling: the cooling slope would drop the feed-forward before the cut-off
+    if (trajectory.phaseAt(trajectoryTimeS + lookahead) < TRAJECTORY_COOL) {
+      trajectory.lookahead(trajectoryTimeS, lookahead, &slope);
+    }
+    float duty = feedForwardModel.feedForwardDuty(temperatureC, slope);
+    if (learning) {
+      // Correction learned from the previous runs of this profile
+      duty = clamp(duty + learning->correctionAt(trajectoryTimeS), 0.0f, 1.0f);
+    }
+    return duty * config.windowSize;
+  }
+
+  // Heater on-time from the model-predictive controller: the reference is the
+  // trajectory one dead time and 1..MPC_HORIZON samples ahead, held at the
+  // peak once the trajectory moves on to cooling
+  float computeModelPredictive(float temperatureC) {
+    float reference[MPC_HORIZON];
+    for (int i = 0; i < MPC_HORIZON; i++) {
+      float ahead = mpc.getDeadTime() + (i + 1) * config.samplePeriodS;
+      bool cooling = trajectory.phaseAt(trajectoryTimeS + ahead) >= TRAJECTORY_COOL;
+      reference[i] = cooling ? profile.peakC : trajectory.lookahead(trajectoryTimeS, ahead);
+    }
+    return mpc.compute(reference, temperatureC) * config.windowSize;
+  }
+
+  // One control period
+  void compute(float temperatureC, float rateCPerS, float airC) {
+    // Board estimate from the air and the duty applied over the last sample
+    boardObserver.update(airC, output / config.windowSize);
+    boardTemperature = boardObserver.getBoard();
+    if (mpcActive && stage != SEQUENCER_COOL) {
+      // The predictive controller covers the loss, the ramp and the dead time itself
+      output = computeModelPredictive(temperatureC);
+      smithPredictor.update(output / config.windowSize);
+      return;
+    }
+    // Plant gain changes with temperature: follow the schedule between phase transitions
+    PIDGains scheduled;
+    if (gainSchedule.lookup(temperatureC, gainPhase(), &scheduled)) {
+      pid.setTunings(scheduled);
+    }
+    // The PID only has to correct what the feed-forward leaves
+    feedForward = computeFeedForward(temperatureC);
+    pid.setOutputLimits(-feedForward, config.windowSize - feedForward);
+    if (getControlVariable() == CONTROL_VARIABLE_BOARD) {
+      // PID on the estimated board temperature, the observer already accounts for the dead time
+      output = (float)pid.compute(T(setpoint), T(boardTemperature));
+    } else if (smithPredictor.isEnabled()) {
+      // PID on the temperature the thermocouple will show once the applied heat has arrived
+      output = (float)pid.compute(T(setpoint), T(smithPredictor.correct(temperatureC)));
+    } else {
+      // Derivative on measurement from the filter's timestamp-aware rate estimate
+      output = (float)pid.compute(T(setpoint), T(temperatureC), T(rateCPerS));
+    }
+    output += feedForward;
+    smithPredictor.update(output / config.windowSize);
+    if (learning && stage != SEQUENCER_COOL) {
+      learning->record(trajectoryTimeS, setpoint - getControlledTemperature(temperatureC));
+    }
+  }
+
+  // Phase key of the gain schedule
+  uint8_t gainPhase() const {
+    switch (stage) {
+      case SEQUENCER_PREHEAT: return GAIN_PHASE_PREHEAT;
+      case SEQUENCER_SOAK:    return GAIN_PHASE_SOAK;
+      case SEQUENCER_REFLOW:  return GAIN_PHASE_REFLOW;
+      case SEQUENCER_COOL:    return GAIN_PHASE_COOL;
+      default:                return GAIN_PHASE_ANY;
+    }
+  }
+
+public:
+  ReflowSequencer() : mpcActive(false), boardExit(false), learning(0), stage(SEQUENCER_IDLE), trajectoryTimeS(0),
+                      holding(false), holdStartMs(0), reflowStartMs(0), trajectoryLastMs(0), nextComputeMs(0), sampleMs(1000), setpoint(0),
+                      output(0), feedForward(0), boardTemperature(0) {
+    setConfig(defaultConfig());
+    profile = SequencerProfile();
+    gains = OvenGains();
+  }
+
+  // Firmware defaults (Reflow_logic.h)
+  static SequencerConfig defaultConfig() {
+    SequencerConfig c;
+    c.samplePeriodS = 1.0f;
+    c.windowSize = 2000.0f;
+    c.rates = SetpointTrajectory::defaultRates();
+    c.maxLagC = 10.0f;
+    c.coolEndC = 50.0f;
+    c.feedForward = true;
+    c.fallbackModel = {1, 270.0f, 140.0f, 0.0f, 25.0f, 0.0f};
+    c.lookaheadS = 5.0f;
+    c.deadTimeCompensation = true;
+    c.peakMarginC = 5.0f;
+    c.peakMarginCompensatedC = 0.0f;
+    c.board = {15.0f, 0.3f, 0.5f, 0.05f};
+    c.exitOnBoard = true;
+    c.boardPeakHorizonS = 120.0f;
+    c.peakHoldMaxS = 60.0f;
+    c.reflowMaxS = 180.0f;
+    c.controlVariable[0] = c.controlVariable[1] = c.controlVariable[2] = CONTROL_VARIABLE_AIR;
+    c.modelPredictive = false;
+    c.mpcMoveWeight = 0.02f;
+    return c;
+  }
+
+  void setConfig(const SequencerConfig& config) {
+    this->config = config;
+    sampleMs = (uint32_t)(config.samplePeriodS * 1000.0f + 0.5f);
+  }
+  const SequencerConfig& getConfig() const { return config; }
+
+  // Learned feed-forward correction applied and recorded during the run (0 = none)
+  void setLearning(IterativeLearning* learning) { this->learning = learning; }
+
+  // Start a run from the current temperature. The model drives the
+  // feed-forward, the dead-time compensation, the board observer and the
+  // model-predictive controller; an invalid model falls back to the
+  // configured feed-forward constants.
+  void start(uint32_t nowMs, float temperatureC, float airC, const SequencerProfile& profile,
+             const PlantModel& model, const OvenGains& gains) {
+    this->profile = profile;
+    this->gains = gains;
+    // Continuous setpoint curve from the current temperature through the profile stages
+    trajectory.buildFromStages(temperatureC, profile.preheatC, profile.soakC, profile.peakC, profile.coolC,
+                               profile.durationS, config.rates);
+    trajectoryTimeS = 0;
+    holding = false;
+    trajectoryLastMs = nowMs;
+    setpoint = trajectory.evaluate(0);
+    pid.setOutputLimits(0, config.windowSize);
+    pid.setSampleTime(config.samplePeriodS);
+    // Every run starts with the preheat gains
+    pid.setTunings(gains.preheat);
+    // A profile with a gain schedule overrides the phase gains every control step
+    gainSchedule.setTable(profile.gainSchedule,
+                          profile.gainPoints < GAIN_SCHEDULE_SIZE ? profile.gainPoints : GAIN_SCHEDULE_SIZE);
+    // Turn the PID on from the current temperature with the heater off
+    pid.reset(T(temperatureC), T(0));
+    // Stays disabled without a model or with a dead time below one sample
+    PlantModel none = {0, 0, 0, 0, 0, 0};
+    smithPredictor.configure(config.deadTimeCompensation ? model : none, config.samplePeriodS);
+    smithPredictor.reset(temperatureC);
+    feedForwardModel = model.valid ? model : config.fallbackModel;
+    feedForward = 0;
+    // Board estimate from the same oven model
+    boardObserver.configure(feedForwardModel, config.board, config.samplePeriodS);
+    boardObserver.reset(airC);
+    // The fallback constants are not a measured oven: the air decides the cut-off
+    boardExit = config.exitOnBoard && model.valid;
+    boardTemperature = temperatureC;
+    // Hard limits from the profile: nothing above the peak, no ramp steeper than allowed
+    mpcActive = config.modelPredictive && mpc.configure(model, config.samplePeriodS, config.mpcMoveWeight);
+    if (mpcActive) {
+      mpc.setConstraints(profile.peakC, profile.maxRampRate);
+      mpc.reset(temperatureC, 0);
+    }
+    output = 0;
+    nextComputeMs = nowMs;
+    stage = SEQUENCER_PREHEAT;
+  }
+
+  // Call every control tick with the filtered temperature, its rate and the
+  // air probe. Moves through the stages and recomputes the output every
+  // sample period; returns the output (0 - windowSize), 0 outside a run.
+  float update(uint32_t nowMs, float temperatureC, float rateCPerS, float airC) {
+    switch (stage) {
+      case SEQUENCER_PREHEAT:
+        // Preheat ends when the trajectory reaches the soak segment
+        if (advanceTrajectory(nowMs, temperatureC) >= TRAJECTORY_SOAK) {
+          // Less agressive gains for the soak ramp
+          pid.setTunings(gains.soak);
+          stage = SEQUENCER_SOAK;
+        }
+        break;
+      case SEQUENCER_SOAK:
+        // The setpoint ramps continuously through the soak instead of in steps
+        if (advanceTrajectory(nowMs, temperatureC) >= TRAJECTORY_REFLOW) {
+          pid.setTunings(gains.reflow);
+          reflowStartMs = nowMs;
+          stage = SEQUENCER_REFLOW;
+        }
+        break;
+      case SEQUENCER_REFLOW: {
+        // Ramp to the peak and hold it there until the cut-off below
+        bool held = advanceTrajectory(nowMs, temperatureC) >= TRAJECTORY_COOL;
+        if (held) {
+          setpoint = profile.peakC;
+          if (!holding) {
+            holding = true;
+            holdStartMs = nowMs;
+          }
+        }
+        // Avoid hovering at the peak for too long. The MPC settles on the
+        // peak from below and may never trip the predicted cut-off, so once
+        // the time at peak is spent and the oven stopped rising the plain
+        // margin applies. In every mode the hold ends after peakHoldMaxS, an
+        // estimate that stays below the peak cannot keep the heater on. An
+        // oven that levels off more than maxLagC below the peak stops the
+        // trajectory before the hold starts, so the stage as a whole ends
+        // after reflowMaxS
+        bool settled = mpcActive && held && rateCPerS <= 0.0f && temperatureC >= profile.peakC - config.peakMarginC;
+        bool holdSpent = holding && timeElapsed(nowMs, holdStartMs) >= (uint32_t)(config.peakHoldMaxS * 1000.0f);
+        bool reflowSpent = timeElapsed(nowMs, reflowStartMs) >= (uint32_t)(config.reflowMaxS * 1000.0f);
+        if (peakReached(temperatureC) || settled || holdSpent || reflowSpent) {
+          setpoint = config.coolEndC;
+          stage = SEQUENCER_COOL;
+        }
+        break;
+      }
+      case SEQUENCER_COOL:
+        if (temperatureC <= config.coolEndC) {
+          output = 0;
+          stage = SEQUENCER_COMPLETE;
+        }
+        break;
+      default:
+        return 0;
+    }
+    if (stage == SEQUENCER_COMPLETE) {
+      return 0;
+    }
+    if (timeReached(nowMs, nextComputeMs)) {
+      nextComputeMs += sampleMs;
+      compute(temperatureC, rateCPerS, airC);
+    }
+    return output;
+  }
+
+  // Abandon the run (fault or stop), the output drops to 0
+  void stop() {
+    stage = SEQUENCER_IDLE;
+    output = 0;
+    feedForward = 0;
+  }
+
+  bool isRunning() const { return stage >= SEQUENCER_PREHEAT && stage <= SEQUENCER_COOL; }
+  SequencerStage getStage() const { return stage; }
+  float getSetpoint() const { return setpoint; }
+  float getOutput() const { return output; }
+  float getFeedForward() const { return feedForward; }
+  float getTrajectoryTime() const { return trajectoryTimeS; }
+  float getBoardTemperature() const { return boardTemperature; }
+  bool isModelPredictive() const { return mpcActive; }
+  const SetpointTrajectory& getTrajectory() const { return trajectory; }
+  const SmithPredictor& getSmithPredictor() const { return smithPredictor; }
+  const PlantModel& getFeedForwardModel() const { return feedForwardModel; }
+
+  // Temperature the PID regulates on in the current stage
+  ControlVariable getControlVariable() const {
+    if (stage >= SEQUENCER_PREHEAT && stage <= SEQUENCER_REFLOW) {
+      return (ControlVariable)config.controlVariable[stage - SEQUENCER_PREHEAT];
+    }
+    return CONTROL_VARIABLE_AIR;
+  }
+
+  float getControlledTemperature(float temperatureC) const {
+    return getControlVariable() == CONTROL_VARIABLE_BOARD ? boardTemperature : temperatureC;
+  }
+
+  static const char* stageName(SequencerStage stage) {
+    switch (stage) {
+      case SEQUENCER_IDLE:     return "Idle";
+      case SEQUENCER_PREHEAT:  return "Preheat";
+      case SEQUENCER_SOAK:     return "Soak";
+      case SEQUENCER_REFLOW:   return "Reflow";
+      case SEQUENCER_COOL:     return "Cool";
+      case SEQUENCER_COMPLETE: return "Complete";
+      default:                 return "?";
+    }
+  }
+};
+
+#endif // REFLOW_SEQUENCER_H
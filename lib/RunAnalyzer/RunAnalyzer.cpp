@@ -0,0 +1,100 @@
+#include "RunAnalyzer.h"
+#include <string.h>
+
+RunAnalyzer::RunAnalyzer() {
+  memset(&spec, 0, sizeof(spec));
+  begin(spec, 0);
+}
+
+void RunAnalyzer::begin(const RunSpec& spec, uint8_t profile) {
+  this->spec = spec;
+  memset(&report, 0, sizeof(report));
+  report.version = RUN_REPORT_VERSION;
+  report.profile = profile;
+  head = 0;
+  count = 0;
+  lastTimeS = 0.0f;
+  lastTempC = 0.0f;
+  lastStage = RUN_STAGE_PREHEAT;
+  started = false;
+}
+
+void RunAnalyzer::addSample(float timeS, float temperatureC, uint8_t stage) {
+  if (!started) {
+    started = true;
+    report.peakC = temperatureC;
+  } else {
+    float dt = timeS - lastTimeS;
+    if (dt <= 0.0f) return;
+
+    // Time above liquidus, crossings interpolated within the sample
+    bool wasAbove = lastTempC >= spec.liquidusC;
+    bool isAbove = temperatureC >= spec.liquidusC;
+    if (wasAbove && isAbove) {
+      report.talS += dt;
+    } else if (wasAbove != isAbove) {
+      float fraction = (spec.liquidusC - lastTempC) / (temperatureC - lastTempC);
+      report.talS += isAbove ? dt * (1.0f - fraction) : dt * fraction;
+    }
+
+    // The interval belongs to the stage that was in force during it
+    if (lastStage < RUN_STAGE_COUNT) report.stageS[lastStage] += dt;
+    if (lastStage <= RUN_STAGE_SOAK && temperatureC >= spec.soakLowC && temperatureC <= spec.soakHighC) {
+      report.soakS += dt;
+    }
+    if (!report.complete) {
+      report.durationS = timeS;
+      if (stage == RUN_STAGE_COOL && temperatureC <= spec.coolEndC) report.complete = 1;
+    }
+  }
+  if (temperatureC > report.peakC) report.peakC = temperatureC;
+
+  // Rates over the last RUN_RATE_SPAN samples
+  if (count == RUN_RATE_SPAN) {
+    float span = timeS - times[head];
+    if (span > 0.0f) {
+      float rate = (temperatureC - temps[head]) / span;
+      if (rate > report.maxRampRate) report.maxRampRate = rate;
+      if (-rate > report.maxCoolRate) report.maxCoolRate = -rate;
+    }
+  } else {
+    count++;
+  }
+  times[head] = timeS;
+  temps[head] = temperatureC;
+  head = (uint8_t)((head + 1) % RUN_RATE_SPAN);
+
+  lastTimeS = timeS;
+  lastTempC = temperatureC;
+  lastStage = stage;
+}
+
+const RunReport& RunAnalyzer::finish() {
+  uint8_t failed = 0;
+  if (report.talS < spec.talMinS || report.talS > spec.talMaxS) failed |= RUN_CHECK_TAL;
+  if (report.peakC < spec.peakMinC || report.peakC > spec.peakMaxC) failed |= RUN_CHECK_PEAK;
+  if (report.maxRampRate > spec.maxRampRate) failed |= RUN_CHECK_RAMP;
+  if (report.maxCoolRate > spec.maxCoolRate) failed |= RUN_CHECK_COOL;
+  if (report.soakS < spec.soakMinS || report.soakS > spec.soakMaxS) failed |= RUN_CHECK_SOAK;
+  if (!report.complete || report.durationS > spec.maxDurationS) failed |= RUN_CHECK_DURATION;
+  report.failed = failed;
+
+  int passedChecks = 0;
+  for (int i = 0; i < RUN_CHECK_COUNT; i++) {
+    if (!(failed & (1 << i))) passedChecks++;
+  }
+  report.score = (uint8_t)((passedChecks * 100 + RUN_CHECK_COUNT / 2) / RUN_CHECK_COUNT);
+  return report;
+}
+
+const char* RunAnalyzer::checkName(uint8_t check) {
+  switch (check) {
+    case RUN_CHECK_TAL: return "TAL";
+    case RUN_CHECK_PEAK: return "Peak";
+    case RUN_CHECK_RAMP: return "Ramp";
+    case RUN_CHECK_COOL: return "Cool";
+    case RUN_CHECK_SOAK: return "Soak";
+    case RUN_CHECK_DURATION: return "Duration";
+    default: return "?";
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef RUN_ANALYZER_H
+#define RUN_ANALYZER_H
+
+#include <stdint.h>
+
+// Samples the heating and cooling rates are measured over
+#define RUN_RATE_SPAN 10
+#define RUN_REPORT_VERSION 1
+
+// Stage of the run a sample belongs to
+enum RunStage {
+  RUN_STAGE_PREHEAT,
+  RUN_STAGE_SOAK,
+  RUN_STAGE_REFLOW,
+  RUN_STAGE_COOL,
+  RUN_STAGE_COUNT
+};
+
+// Conformance checks, bit set in RunReport::failed when violated
+enum RunCheck {
+  RUN_CHECK_TAL = 1,        // Time above liquidus within [talMinS, talMaxS]
+  RUN_CHECK_PEAK = 2,       // Peak within [peakMinC, peakMaxC]
+  RUN_CHECK_RAMP = 4,       // Heating never faster than maxRampRate
+  RUN_CHECK_COOL = 8,       // Cooling never faster than maxCoolRate
+  RUN_CHECK_SOAK = 16,      // Time in the soak window within [soakMinS, soakMaxS]
+  RUN_CHECK_DURATION = 32   // Start to the end of cooling within maxDurationS
+};
+#define RUN_CHECK_COUNT 6
+
+// Limits a run is scored against, built from the profile
+struct RunSpec {
+  float liquidusC;
+  float talMinS;
+  float talMaxS;
+  float peakMinC;
+  float peakMaxC;
+  float maxRampRate;        // C/s
+  float maxCoolRate;        // C/s, positive
+  float soakLowC;
+  float soakHighC;
+  float soakMinS;
+  float soakMaxS;
+  float coolEndC;           // Cooling ends below this temperature
+  float maxDurationS;
+};
+
+// Result of a run, stored in NVS
+struct RunReport {
+  uint16_t version;
+  uint8_t profile;
+  uint8_t score;            // Share of checks passed, 0 - 100
+  uint8_t failed;           // RunCheck bits
+  uint8_t complete;         // Run reached the end of cooling
+  float talS;
+  float peakC;
+  float maxRampRate;
+  float maxCoolRate;
+  float soakS;
+  float durationS;
+  float stageS[RUN_STAGE_COUNT];
+};
+
+// Incremental conformance analyzer: every sample updates running figures in
+// constant time (time above liquidus with interpolated crossings, peak,
+// heating and cooling rate over the last RUN_RATE_SPAN samples, time per
+// stage and in the soak window), so it can run inside the control tick.
+// finish() scores the run against the spec.
+class RunAnalyzer {
+private:
+  RunSpec spec;
+  RunReport report;
+  float times[RUN_RATE_SPAN];
+  float temps[RUN_RATE_SPAN];
+  uint8_t head;
+  uint8_t count;
+  float lastTimeS;
+  float lastTempC;
+  uint8_t lastStage;
+  bool started;
+
+public:
+  RunAnalyzer();
+
+  void begin(const RunSpec& spec, uint8_t profile);
+
+  // One sample: time since the start, temperature and RunStage
+  void addSample(float timeS, float temperatureC, uint8_t stage);
+
+  // Score the run, complete once cooling reached coolEndC
+  const RunReport& finish();
+
+  const RunReport& getReport() const { return report; }
+  const RunSpec& getSpec() const { return spec; }
+  bool passed() const { return report.complete && report.failed == 0; }
+
+  static const char* checkName(uint8_t check);
+};
+
+#endif // RUN_ANALYZER_H
@@ -0,0 +1,90 @@
+#include "RunReplay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RUN_LOG_HEADER "Time Setpoint Input Output"
+
+bool parseRunLogLine(const char* line, RunLogRow* row) {
+  // timerSeconds first: a positive integer
+  char* end;
+  long timeS = strtol(line, &end, 10);
+  if (end == line || timeS <= 0 || timeS > 0xFFFF || *end != ' ') return false;
+  float values[3];
+  const char* p = end;
+  for (int i = 0; i < 3; i++) {
+    values[i] = strtof(p, &end);
+    if (end == p) return false;
+    p = end;
+  }
+  // Nothing but the line ending after the output
+  while (*p == ' ' || *p == '\r') p++;
+  if (*p != '\0' && *p != '\n') return false;
+  row->timeS = (uint16_t)timeS;
+  row->setpointC = values[0];
+  row->inputC = values[1];
+  row->output = values[2];
+  return true;
+}
+
+uint16_t parseRunLog(const char* text, RunLogRow* rows, uint16_t capacity) {
+  uint16_t count = 0;
+  bool inRun = false;
+  const char* line = text;
+  while (*line) {
+    const char* next = strchr(line, '\n');
+    size_t length = next ? (size_t)(next - line) : strlen(line);
+    if (strncmp(line, RUN_LOG_HEADER, strlen(RUN_LOG_HEADER)) == 0) {
+      // The next header starts another run
+      if (inRun) break;
+      inRun = true;
+    } else if (inRun && count < capacity) {
+      char buffer[96];
+      if (length < sizeof(buffer)) {
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
+        if (parseRunLogLine(buffer, &rows[count])) count++;
+      }
+    }
+    if (!next) break;
+    line = next + 1;
+  }
+  return count;
+}
+
+static void putInt16(uint8_t* p, int32_t value) {
+  if (value < -32768) value = -32768;
+  if (value > 32767) value = 32767;
+  p[0] = (uint8_t)(value & 0xFF);
+  p[1] = (uint8_t)((value >> 8) & 0xFF);
+}
+
+static int16_t getInt16(const uint8_t* p) {
+  return (int16_t)(p[0] | (p[1] << 8));
+}
+
+void encodeRunLogRecord(const RunLogRow& row, uint8_t* record) {
+  record[0] = (uint8_t)(row.timeS & 0xFF);
+  record[1] = (uint8_t)(row.timeS >> 8);
+  putInt16(record + 2, (int32_t)lroundf(row.setpointC * 10.0f));
+  putInt16(record + 4, (int32_t)lroundf(row.inputC * 10.0f));
+  uint32_t output = row.output > 0.0f ? (uint32_t)lroundf(row.output) : 0;
+  if (output > 0xFFFF) output = 0xFFFF;
+  record[6] = (uint8_t)(output & 0xFF);
+  record[7] = (uint8_t)(output >> 8);
+}
+
+void decodeRunLogRecord(const uint8_t* record, RunLogRow* row) {
+  row->timeS = (uint16_t)(record[0] | (record[1] << 8));
+  row->setpointC = getInt16(record + 2) / 10.0f;
+  row->inputC = getInt16(record + 4) / 10.0f;
+  row->output = (float)(uint16_t)(record[6] | (record[7] << 8));
+}
+
+uint16_t parseRunLogBinary(const uint8_t* data, size_t length, RunLogRow* rows, uint16_t capacity) {
+  uint16_t count = 0;
+  for (size_t offset = 0; offset + RUN_LOG_RECORD_SIZE <= length && count < capacity;
+       offset += RUN_LOG_RECORD_SIZE) {
+    decodeRunLogRecord(data + offset, &rows[count++]);
+  }
+  return count;
+}
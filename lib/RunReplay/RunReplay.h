@@ -0,0 +1,201 @@
+#ifndef RUN_REPLAY_H
+#define RUN_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "ReflowSequencer.h"
+#include "ControlClock.h"
+
+// One row of a recorded run: the once-a-second serial log of reflow_main()
+// ("Time Setpoint Input Output")
+struct RunLogRow {
+  uint16_t timeS;           // timerSeconds, 1 for the first row
+  float setpointC;
+  float inputC;
+  float output;             // Heater on-time in output units (0 - window size)
+};
+
+// Binary form of a row, 8 bytes little-endian, 0.1 C resolution
+#define RUN_LOG_RECORD_SIZE 8
+
+// Parses one serial log line; false for the header and any other output
+// ("Float temp: ...", status messages)
+bool parseRunLogLine(const char* line, RunLogRow* row);
+
+// Rows of the first run in a serial capture: from the first
+// "Time Setpoint Input Output" header to the next one or the end. Returns the
+// number of rows stored (at most capacity).
+uint16_t parseRunLog(const char* text, RunLogRow* rows, uint16_t capacity);
+
+void encodeRunLogRecord(const RunLogRow& row, uint8_t* record);
+void decodeRunLogRecord(const uint8_t* record, RunLogRow* row);
+uint16_t parseRunLogBinary(const uint8_t* data, size_t length, RunLogRow* rows, uint16_t capacity);
+
+struct ReplayConfig {
+  uint32_t tickMs;          // Control task period of the recording firmware
+  float setpointTolC;       // A row differs when the setpoint is further off
+  float outputTol;          // or the output (output units). The log samples the
+                            // input once a second, so the PID's derivative
+                            // cannot be reproduced closer than a few percent
+};
+
+// Replayed decisions at a row's print time
+struct ReplayDecision {
+  float setpointC;
+  float output;
+  SequencerStage stage;
+};
+
+struct ReplayReport {
+  uint16_t rows;
+  uint16_t mismatches;      // Rows outside the tolerances
+  int16_t firstMismatch;    // Row index, -1 if none
+  float maxSetpointDiffC;
+  float rmsSetpointDiffC;
+  float maxOutputDiff;
+  float rmsOutputDiff;
+  bool completed;           // The replayed run reached COMPLETE
+  float completedS;         // When, from the start of the run
+  uint32_t phaseMs;         // Print time of row 1 after the start
+};
+
+// Replays a recorded run through the profile sequencer under a virtual clock
+// and diffs its decisions against the recording.
+//
+// The recorded input is fed back every control tick, interpolated between
+// the rows. The firmware prints a row at the start of a tick, before the
+// state machine runs, once a second from a timer that is not synchronised
+// with the run start; row k is printed at phaseMs + (k - 1) s. align() finds
+// that phase from the setpoints.
+//
+// The run is replayed with the settings the caller passes in, which should
+// be those of the recording firmware (profile, model, gains, configuration).
+template <typename T>
+class RunReplay {
+private:
+  ReplayConfig config;
+  SequencerConfig sequencerConfig;
+  SequencerProfile profile;
+  PlantModel model;
+  OvenGains gains;
+  ReflowSequencer<T> sequencer;
+
+  static uint32_t rowMs(uint16_t row, uint32_t phaseMs) { return phaseMs + row * 1000UL; }
+
+  // Recorded temperature at a time after the start and its rate
+  static float inputAt(const RunLogRow* rows, uint16_t count, uint32_t phaseMs, uint32_t ms, float* rate) {
+    *rate = 0.0f;
+    if (ms <= rowMs(0, phaseMs) || count < 2) return rows[0].inputC;
+    uint16_t i = (ms - phaseMs) / 1000UL;
+    if (i >= count - 1) return rows[count - 1].inputC;
+    float fraction = (ms - rowMs(i, phaseMs)) / 1000.0f;
+    *rate = rows[i + 1].inputC - rows[i].inputC;
+    return rows[i].inputC + fraction * *rate;
+  }
+
+  uint32_t bestPhaseIn(const RunLogRow* rows, uint16_t count, uint32_t fromMs, uint32_t toMs, uint32_t stepMs) {
+    uint32_t bestPhase = fromMs;
+    float bestDiff = INFINITY;
+    for (uint32_t phaseMs = fromMs; phaseMs <= toMs; phaseMs += stepMs) {
+      float diff = replay(rows, count, phaseMs).rmsSetpointDiffC;
+      if (diff < bestDiff) {
+        bestDiff = diff;
+        bestPhase = phaseMs;
+      }
+    }
+    return bestPhase;
+  }
+
+public:
+  RunReplay() : config(defaultConfig()), sequencerConfig(ReflowSequencer<T>::defaultConfig()) {
+    model = {0, 0, 0, 0, 0, 0};
+  }
+
+  static ReplayConfig defaultConfig() {
+    ReplayConfig c;
+    c.tickMs = 10;
+    c.setpointTolC = 0.5f;
+    c.outputTol = 50.0f;
+    return c;
+  }
+
+  void setConfig(const ReplayConfig& config) { this->config = config; }
+  const ReplayConfig& getConfig() const { return config; }
+
+  // Settings of the recorded run
+  void setRun(const SequencerConfig& sequencerConfig, const SequencerProfile& profile, const PlantModel& model,
+              const OvenGains& gains) {
+    this->sequencerConfig = sequencerConfig;
+    this->profile = profile;
+    this->model = model;
+    this->gains = gains;
+  }
+
+  // Runs the recording with row 1 printed phaseMs after the start. Fills
+  // decisions[row] when given (count entries).
+  ReplayReport replay(const RunLogRow* rows, uint16_t count, uint32_t phaseMs, ReplayDecision* decisions = 0) {
+    ReplayReport r = {count, 0, -1, 0.0f, 0.0f, 0.0f, 0.0f, false, 0.0f, phaseMs};
+    if (count == 0) return r;
+    VirtualClock clock;
+    float rate;
+    float input = inputAt(rows, count, phaseMs, 0, &rate);
+    sequencer.setConfig(sequencerConfig);
+    sequencer.start(clock.nowMs(), input, input, profile, model, gains);
+
+    float output = 0.0f, setpointSumSq = 0.0f, outputSumSq = 0.0f;
+    uint16_t row = 0;
+    uint32_t endMs = rowMs(count, phaseMs);
+    for (; timeReached(endMs, clock.nowMs()); clock.advanceMs(config.tickMs)) {
+      uint32_t now = clock.nowMs();
+      // The row printed this tick shows the state left by the previous one
+      while (row < count && timeReached(now, rowMs(row, phaseMs))) {
+        float setpointDiff = fabsf(sequencer.getSetpoint() - rows[row].setpointC);
+        float outputDiff = fabsf(output - rows[row].output);
+        if (setpointDiff > r.maxSetpointDiffC) r.maxSetpointDiffC = setpointDiff;
+        if (outputDiff > r.maxOutputDiff) r.maxOutputDiff = outputDiff;
+        setpointSumSq += setpointDiff * setpointDiff;
+        outputSumSq += outputDiff * outputDiff;
+        if (setpointDiff > config.setpointTolC || outputDiff > config.outputTol) {
+          if (r.firstMismatch < 0) r.firstMismatch = row;
+          r.mismatches++;
+        }
+        if (decisions) {
+          decisions[row].setpointC = sequencer.getSetpoint();
+          decisions[row].output = output;
+          decisions[row].stage = sequencer.getStage();
+        }
+        row++;
+      }
+      input = inputAt(rows, count, phaseMs, now, &rate);
+      output = sequencer.update(now, input, rate, input);
+      if (sequencer.getStage() == SEQUENCER_COMPLETE) {
+        r.completed = true;
+        r.completedS = now / 1000.0f;
+        break;
+      }
+    }
+    // Rows the replay did not reach count as different
+    if (row < count) {
+      if (r.firstMismatch < 0) r.firstMismatch = row;
+      r.mismatches += count - row;
+    }
+    if (row > 0) {
+      r.rmsSetpointDiffC = sqrtf(setpointSumSq / row);
+      r.rmsOutputDiff = sqrtf(outputSumSq / row);
+    }
+    return r;
+  }
+
+  // Finds the print phase whose setpoints match the recording best: every
+  // 100 ms over the second, then every 10 ms around the best
+  ReplayReport align(const RunLogRow* rows, uint16_t count, ReplayDecision* decisions = 0) {
+    uint32_t bestPhase = bestPhaseIn(rows, count, 100, 1000, 100);
+    bestPhase = bestPhaseIn(rows, count, bestPhase - 90, bestPhase < 1000 ? bestPhase + 90 : 1000, 10);
+    return replay(rows, count, bestPhase, decisions);
+  }
+
+  const ReflowSequencer<T>& getSequencer() const { return sequencer; }
+};
+
+#endif // RUN_REPLAY_H
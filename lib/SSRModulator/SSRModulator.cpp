@@ -0,0 +1,64 @@
+#include "SSRModulator.h"
+
+SSRModulator::SSRModulator(uint16_t windowSlots, uint16_t burstSlots)
+  : mode(SSR_MODULATION_WINDOWED), windowSlots(windowSlots ? windowSlots : 1), burstSlots(burstSlots ? burstSlots : 1),
+    duty(0), slot(0), onSlots(0), accumulator(0) {
+}
+
+void SSRModulator::setMode(SSRModulation mode) {
+  if (mode != this->mode) {
+    this->mode = mode;
+    reset();
+  }
+}
+
+void SSRModulator::setDuty(uint32_t duty) {
+  this->duty = duty > SSR_DUTY_ONE ? SSR_DUTY_ONE : duty;
+}
+
+void SSRModulator::reset() {
+  slot = 0;
+  onSlots = 0;
+  accumulator = 0;
+}
+
+bool IRAM_ATTR SSRModulator::nextSlot() {
+  bool on = false;
+
+  switch (mode) {
+    case SSR_MODULATION_WINDOWED:
+      if (slot == 0) {
+        onSlots = (uint16_t)(((uint64_t)duty * windowSlots + SSR_DUTY_ONE / 2) / SSR_DUTY_ONE);
+      }
+      on = slot < onSlots;
+      if (++slot >= windowSlots) slot = 0;
+      break;
+
+    case SSR_MODULATION_BURST_FIRE:
+      if (slot == 0) {
+        onSlots = (uint16_t)(((uint64_t)duty * burstSlots + SSR_DUTY_ONE / 2) / SSR_DUTY_ONE);
+      }
+      // Bresenham spread of onSlots over the burst period
+      on = ((uint32_t)(slot + 1) * onSlots) / burstSlots != ((uint32_t)slot * onSlots) / burstSlots;
+      if (++slot >= burstSlots) slot = 0;
+      break;
+
+    case SSR_MODULATION_SIGMA_DELTA:
+      accumulator += duty;
+      if (accumulator >= SSR_DUTY_ONE) {
+        accumulator -= SSR_DUTY_ONE;
+        on = true;
+      }
+      break;
+  }
+  return on;
+}
+
+const char* SSRModulator::modeName(SSRModulation mode) {
+  switch (mode) {
+    case SSR_MODULATION_WINDOWED:    return "windowed";
+    case SSR_MODULATION_BURST_FIRE:  return "burst-fire";
+    case SSR_MODULATION_SIGMA_DELTA: return "sigma-delta";
+  }
+  return "";
+}
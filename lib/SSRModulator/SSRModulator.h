@@ -0,0 +1,54 @@
+#ifndef SSR_MODULATOR_H
+#define SSR_MODULATOR_H
+
+#include <stdint.h>
+
+#if defined(ESP32)
+#include <esp_attr.h>
+#endif
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+// Full scale of the fixed-point duty (1.0)
+#define SSR_DUTY_ONE 65536UL
+
+// Heater power modulation schemes
+enum SSRModulation {
+  SSR_MODULATION_WINDOWED,     // Slow PWM: on for the first part of a long window
+  SSR_MODULATION_BURST_FIRE,   // Duty latched per short burst, on half-cycles spread evenly inside it
+  SSR_MODULATION_SIGMA_DELTA   // First-order sigma-delta, decides every half-cycle
+};
+
+// Decides for every mains half-cycle slot whether the heater is on. Integer
+// only, so it can be called from the SSR timer interrupt (no FPU in ISRs).
+class SSRModulator {
+private:
+  SSRModulation mode;
+  uint16_t windowSlots;     // Period of the windowed mode in slots
+  uint16_t burstSlots;      // Period of the burst-fire mode in slots
+  uint32_t duty;            // Requested duty, 0 - SSR_DUTY_ONE
+  uint16_t slot;            // Position inside the current period
+  uint16_t onSlots;         // On-slots latched for the current period
+  uint32_t accumulator;     // Sigma-delta error accumulator
+
+public:
+  SSRModulator(uint16_t windowSlots = 200, uint16_t burstSlots = 50);
+
+  // Mode change restarts the modulation period
+  void setMode(SSRModulation mode);
+  SSRModulation getMode() const { return mode; }
+
+  // Duty in SSR_DUTY_ONE units
+  void setDuty(uint32_t duty);
+  uint32_t getDuty() const { return duty; }
+
+  // Returns true if the heater is on for the next slot
+  bool nextSlot();
+
+  void reset();
+
+  static const char* modeName(SSRModulation mode);
+};
+
+#endif // SSR_MODULATOR_H
@@ -0,0 +1,196 @@
+#include "SSROutput.h"
+
+// Timer tick is 1 us (80 MHz APB clock / 80)
+#define SSR_TIMER_DIVIDER 80
+
+SSROutput* SSROutput::instance = nullptr;
+
+SSROutput::SSROutput(uint8_t pin, uint8_t timerNum)
+  : pin(pin), timerNum(timerNum), timer(nullptr), windowUs(0), slotUs(0), pendingDuty(0),
+    pendingMode(SSR_MODULATION_WINDOWED), forcedOff(true), tripped(false), mode(SSR_MODULATION_WINDOWED),
+    phase(PHASE_WINDOW_START), windowStart(0), nextEdge(0), riseCount(0), pinHigh(false) {
+  mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&stats, 0, sizeof(stats));
+}
+
+bool SSROutput::begin(uint32_t windowUs, uint32_t slotUs) {
+  if (timer != nullptr || windowUs == 0 || slotUs == 0) {
+    return false;
+  }
+  this->windowUs = windowUs;
+  this->slotUs = slotUs;
+  modulator = SSRModulator(windowUs / slotUs, windowUs / slotUs / 4);
+  instance = this;
+
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
+
+  timer = timerBegin(timerNum, SSR_TIMER_DIVIDER, true);
+  if (timer == nullptr) {
+    Serial.println("SSR timer allocation failed");
+    return false;
+  }
+  timerAttachInterrupt(timer, &SSROutput::onTimer, true);
+
+  windowStart = timerRead(timer);
+  nextEdge = windowStart + windowUs;
+  phase = PHASE_WINDOW_START;
+  timerAlarmWrite(timer, nextEdge, false);
+  timerAlarmEnable(timer);
+  return true;
+}
+
+void IRAM_ATTR SSROutput::onTimer() {
+  if (instance) {
+    instance->handleEdge();
+  }
+}
+
+void IRAM_ATTR SSROutput::setPin(bool high, uint64_t count) {
+  if (high == pinHigh) {
+    return;
+  }
+  digitalWrite(pin, high ? HIGH : LOW);
+  if (high) {
+    riseCount = count;
+  } else {
+    stats.deliveredOnUs += count - riseCount;
+  }
+  pinHigh = high;
+}
+
+void IRAM_ATTR SSROutput::handleEdge() {
+  uint64_t count = timerRead(timer);
+
+  portENTER_CRITICAL_ISR(&mux);
+  uint32_t latencyUs = (uint32_t)(count - nextEdge);
+  if (latencyUs > stats.maxEdgeLatencyUs) stats.maxEdgeLatencyUs = latencyUs;
+
+  if (phase == PHASE_WINDOW_START) {
+    // New window starts at the scheduled edge, not at the serviced time
+    windowStart = nextEdge;
+    if (pinHigh) {
+      // Output stays on across the boundary: close the previous window's on-time here
+      stats.deliveredOnUs += count - riseCount;
+      riseCount = count;
+    }
+    if (pendingMode != mode) {
+      mode = pendingMode;
+      modulator.setMode(mode);
+    }
+    uint32_t duty = (forcedOff || tripped) ? 0 : pendingDuty;
+
+    if (mode == SSR_MODULATION_WINDOWED) {
+      uint32_t onUs = (uint32_t)(((uint64_t)duty * windowUs) >> 16);
+      stats.windows++;
+      stats.elapsedUs += windowUs;
+      stats.requestedOnUs += onUs;
+
+      if (onUs == 0) {
+        setPin(false, count);
+        nextEdge = windowStart + windowUs;
+      } else if (onUs >= windowUs) {
+        setPin(true, count);
+        nextEdge = windowStart + windowUs;
+      } else {
+        setPin(true, count);
+        nextEdge = windowStart + onUs;
+        phase = PHASE_OFF_EDGE;
+      }
+    } else {
+      // One mains half-cycle per alarm, the modulator decides the slot
+      modulator.setDuty(duty);
+      stats.windows++;
+      stats.elapsedUs += slotUs;
+      stats.requestedOnUs += ((uint64_t)duty * slotUs) >> 16;
+      setPin(modulator.nextSlot(), count);
+      nextEdge = windowStart + slotUs;
+    }
+  } else {
+    setPin(false, count);
+    nextEdge = windowStart + windowUs;
+    phase = PHASE_WINDOW_START;
+  }
+  portEXIT_CRITICAL_ISR(&mux);
+
+  timerAlarmWrite(timer, nextEdge, false);
+  timerAlarmEnable(timer);
+}
+
+void SSROutput::setDuty(float duty) {
+  if (duty < 0.0f) duty = 0.0f;
+  if (duty > 1.0f) duty = 1.0f;
+  portENTER_CRITICAL(&mux);
+  pendingDuty = (uint32_t)(duty * SSR_DUTY_ONE + 0.5f);
+  forcedOff = false;
+  portEXIT_CRITICAL(&mux);
+}
+
+float SSROutput::getDuty() const {
+  return (float)pendingDuty / SSR_DUTY_ONE;
+}
+
+void SSROutput::setModulation(SSRModulation mode) {
+  portENTER_CRITICAL(&mux);
+  pendingMode = mode;
+  portEXIT_CRITICAL(&mux);
+}
+
+void SSROutput::off() {
+  portENTER_CRITICAL(&mux);
+  pendingDuty = 0;
+  forcedOff = true;
+  if (timer != nullptr) {
+    setPin(false, timerRead(timer));
+  } else {
+    digitalWrite(pin, LOW);
+  }
+  portEXIT_CRITICAL(&mux);
+}
+
+void IRAM_ATTR SSROutput::trip() {
+  // Pin first, bookkeeping after
+  digitalWrite(pin, LOW);
+  portENTER_CRITICAL_ISR(&mux);
+  tripped = true;
+  pendingDuty = 0;
+  forcedOff = true;
+  if (timer != nullptr) {
+    setPin(false, timerRead(timer));
+  }
+  portEXIT_CRITICAL_ISR(&mux);
+}
+
+void SSROutput::clearTrip() {
+  portENTER_CRITICAL(&mux);
+  tripped = false;
+  portEXIT_CRITICAL(&mux);
+}
+
+SSROutputStats SSROutput::getStats() {
+  SSROutputStats copy;
+  portENTER_CRITICAL(&mux);
+  copy = stats;
+  portEXIT_CRITICAL(&mux);
+  return copy;
+}
+
+void SSROutput::resetStats() {
+  portENTER_CRITICAL(&mux);
+  memset(&stats, 0, sizeof(stats));
+  if (pinHigh && timer != nullptr) {
+    riseCount = timerRead(timer);
+  }
+  portEXIT_CRITICAL(&mux);
+}
+
+void SSROutput::printStats() {
+  SSROutputStats s = getStats();
+  float requested = s.elapsedUs ? (float)s.requestedOnUs / s.elapsedUs * 100.0f : 0.0f;
+  float delivered = s.elapsedUs ? (float)s.deliveredOnUs / s.elapsedUs * 100.0f : 0.0f;
+  Serial.println("SSR output (" + String(SSRModulator::modeName(mode)) + "): "
+                 + String(s.windows) + " windows, requested duty "
+                 + String(requested, 2) + " %, delivered duty "
+                 + String(delivered, 2) + " %, max edge latency "
+                 + String(s.maxEdgeLatencyUs) + " us");
+}
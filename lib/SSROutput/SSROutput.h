@@ -0,0 +1,85 @@
+#ifndef SSR_OUTPUT_H
+#define SSR_OUTPUT_H
+
+#include <Arduino.h>
+#include "SSRModulator.h"
+
+// Requested vs delivered output counters
+struct SSROutputStats {
+  uint32_t windows;          // Completed windows (windowed mode) or half-cycle slots
+  uint64_t elapsedUs;        // Sum of the window and slot lengths
+  uint64_t requestedOnUs;    // Sum of latched on-times
+  uint64_t deliveredOnUs;    // Sum of on-times measured between the actual edges
+  uint32_t maxEdgeLatencyUs; // Worst delay between scheduled and serviced edge
+};
+
+// SSR driver backed by a hardware timer. In windowed mode the duty set by the
+// controller is latched at the start of each window and both edges of the
+// window are generated from the timer interrupt. In burst-fire and
+// sigma-delta modes the timer fires every mains half-cycle and the
+// SSRModulator decides each slot. Either way the delivered duty does not
+// depend on how often the caller runs.
+class SSROutput {
+private:
+  enum Phase {
+    PHASE_WINDOW_START,
+    PHASE_OFF_EDGE
+  };
+
+  uint8_t pin;
+  uint8_t timerNum;
+  hw_timer_t* timer;
+  portMUX_TYPE mux;
+
+  uint32_t windowUs;
+  uint32_t slotUs;
+  volatile uint32_t pendingDuty;   // SSR_DUTY_ONE units, written by setDuty(), latched by the ISR
+  volatile SSRModulation pendingMode;
+  volatile bool forcedOff;
+  volatile bool tripped;           // Hardware cut-off, only clearTrip() re-enables the output
+
+  // ISR state
+  SSRModulator modulator;
+  SSRModulation mode;
+  Phase phase;
+  uint64_t windowStart;            // Timer count at the start of the current window or slot
+  uint64_t nextEdge;               // Timer count of the next alarm
+  uint64_t riseCount;              // Timer count of the last rising edge
+  bool pinHigh;
+  SSROutputStats stats;
+
+  static SSROutput* instance;
+  static void IRAM_ATTR onTimer();
+  void IRAM_ATTR handleEdge();
+  void IRAM_ATTR setPin(bool high, uint64_t count);
+
+public:
+  SSROutput(uint8_t pin, uint8_t timerNum = 0);
+
+  // Start the timer with the given window and mains half-cycle lengths in microseconds
+  bool begin(uint32_t windowUs, uint32_t slotUs = 10000);
+
+  // Set the on-fraction (0.0 - 1.0) applied from the next window or slot
+  void setDuty(float duty);
+  float getDuty() const;
+
+  // Select the modulation scheme, applied at the next window or slot boundary
+  void setModulation(SSRModulation mode);
+  SSRModulation getModulation() const { return pendingMode; }
+
+  // Force the output off immediately; the next setDuty() re-enables it
+  void off();
+
+  // Cut the output from an interrupt handler and keep it off until clearTrip()
+  void IRAM_ATTR trip();
+  bool isTripped() const { return tripped; }
+  void clearTrip();
+
+  uint32_t getWindowUs() const { return windowUs; }
+
+  SSROutputStats getStats();
+  void resetStats();
+  void printStats();
+};
+
+#endif // SSR_OUTPUT_H
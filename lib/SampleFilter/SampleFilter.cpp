@@ -0,0 +1,181 @@
+#include "SampleFilter.h"
+#include <math.h>
+#include <string.h>
+
+SampleFilter::SampleFilter(const SampleFilterConfig& config) : costClock(nullptr) {
+  setConfig(config);
+  resetStats();
+}
+
+SampleFilterConfig SampleFilter::defaultConfig() {
+  SampleFilterConfig c;
+  c.medianWindow = 5;
+  c.smoother = FILTER_SMOOTHER_KALMAN;
+  c.iirTimeConstantS = 1.0f;
+  c.kalmanProcessNoise = 0.05f;
+  c.kalmanMeasurementNoise = 0.04f;
+  c.derivativeWindow = 12;
+  return c;
+}
+
+void SampleFilter::setConfig(const SampleFilterConfig& config) {
+  this->config = config;
+  if (this->config.medianWindow < 1) this->config.medianWindow = 1;
+  if (this->config.medianWindow > SAMPLE_FILTER_MAX_MEDIAN) this->config.medianWindow = SAMPLE_FILTER_MAX_MEDIAN;
+  if (this->config.medianWindow % 2 == 0) this->config.medianWindow--;
+  if (this->config.derivativeWindow < 2) this->config.derivativeWindow = 2;
+  if (this->config.derivativeWindow > SAMPLE_FILTER_MAX_DERIVATIVE) this->config.derivativeWindow = SAMPLE_FILTER_MAX_DERIVATIVE;
+  reset();
+}
+
+void SampleFilter::reset() {
+  medianCount = 0;
+  medianIndex = 0;
+  value = 0.0f;
+  variance = 0.0f;
+  lastTimestampUs = 0;
+  valid = false;
+  derivativeCount = 0;
+  derivativeIndex = 0;
+  derivative = 0.0f;
+}
+
+float SampleFilter::median(float sample) {
+  medianBuffer[medianIndex] = sample;
+  medianIndex = (medianIndex + 1) % config.medianWindow;
+  if (medianCount < config.medianWindow) medianCount++;
+
+  // Insertion sort of at most seven values
+  float sorted[SAMPLE_FILTER_MAX_MEDIAN];
+  for (uint8_t i = 0; i < medianCount; i++) {
+    float v = medianBuffer[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+  return sorted[medianCount / 2];
+}
+
+float SampleFilter::smooth(float sample, float dtS) {
+  if (!valid) {
+    variance = config.kalmanMeasurementNoise;
+    return sample;
+  }
+  switch (config.smoother) {
+    case FILTER_SMOOTHER_IIR: {
+      float alpha = dtS / (config.iirTimeConstantS + dtS);
+      return value + alpha * (sample - value);
+    }
+    case FILTER_SMOOTHER_KALMAN: {
+      variance += config.kalmanProcessNoise * dtS;
+      float gain = variance / (variance + config.kalmanMeasurementNoise);
+      variance *= 1.0f - gain;
+      return value + gain * (sample - value);
+    }
+    case FILTER_SMOOTHER_NONE:
+      break;
+  }
+  return sample;
+}
+
+void SampleFilter::updateDerivative(float sample, uint32_t timestampUs) {
+  derivativeValue[derivativeIndex] = sample;
+  derivativeTime[derivativeIndex] = timestampUs;
+  derivativeIndex = (derivativeIndex + 1) % config.derivativeWindow;
+  if (derivativeCount < config.derivativeWindow) derivativeCount++;
+  if (derivativeCount < 2) {
+    derivative = 0.0f;
+    return;
+  }
+
+  // Least-squares slope over the real timestamps, relative to the newest sample
+  float sumT = 0.0f, sumV = 0.0f, sumTT = 0.0f, sumTV = 0.0f;
+  for (uint8_t i = 0; i < derivativeCount; i++) {
+    float t = -(float)(uint32_t)(timestampUs - derivativeTime[i]) * 1e-6f;
+    float v = derivativeValue[i] - sample;
+    sumT += t;
+    sumV += v;
+    sumTT += t * t;
+    sumTV += t * v;
+  }
+  float n = derivativeCount;
+  float denominator = n * sumTT - sumT * sumT;
+  derivative = denominator > 1e-9f ? (n * sumTV - sumT * sumV) / denominator : 0.0f;
+}
+
+float SampleFilter::update(float sample, uint32_t timestampUs) {
+  uint32_t t0 = costClock ? costClock() : 0;
+  float despiked = median(sample);
+  uint32_t t1 = costClock ? costClock() : 0;
+
+  // Unsigned difference keeps the interval correct across a micros() rollover
+  float dtS = valid ? (float)(uint32_t)(timestampUs - lastTimestampUs) * 1e-6f : 0.0f;
+  value = smooth(despiked, dtS);
+  valid = true;
+  lastTimestampUs = timestampUs;
+  uint32_t t2 = costClock ? costClock() : 0;
+
+  updateDerivative(value, timestampUs);
+  uint32_t t3 = costClock ? costClock() : 0;
+
+  samples++;
+  medianCostSum += t1 - t0;
+  smootherCostSum += t2 - t1;
+  derivativeCostSum += t3 - t2;
+  if (t3 - t0 > maxTotalCost) maxTotalCost = t3 - t0;
+  inputNoise.add(sample);
+  outputNoise.add(value);
+  return value;
+}
+
+SampleFilterStats SampleFilter::getStats() const {
+  SampleFilterStats s;
+  s.samples = samples;
+  s.medianCost = samples ? medianCostSum / samples : 0;
+  s.smootherCost = samples ? smootherCostSum / samples : 0;
+  s.derivativeCost = samples ? derivativeCostSum / samples : 0;
+  s.maxTotalCost = maxTotalCost;
+  s.inputNoise = inputNoise.sigma();
+  s.outputNoise = outputNoise.sigma();
+  return s;
+}
+
+void SampleFilter::resetStats() {
+  samples = 0;
+  medianCostSum = 0;
+  smootherCostSum = 0;
+  derivativeCostSum = 0;
+  maxTotalCost = 0;
+  inputNoise.reset();
+  outputNoise.reset();
+}
+
+void SampleFilter::DifferenceNoise::reset() {
+  last = 0.0f;
+  count = 0;
+  mean = 0.0f;
+  m2 = 0.0f;
+}
+
+void SampleFilter::DifferenceNoise::add(float sample) {
+  if (count++ > 0) {
+    // Welford update on the successive difference, the slow trend only shifts the mean
+    float d = sample - last;
+    uint32_t n = count - 1;
+    float delta = d - mean;
+    mean += delta / n;
+    m2 += delta * (d - mean);
+  }
+  last = sample;
+}
+
+float SampleFilter::DifferenceNoise::sigma() const {
+  if (count < 3) {
+    return 0.0f;
+  }
+  // Var(x[n] - x[n-1]) = 2 Var(x) for white noise
+  return sqrtf(m2 / (count - 2) / 2.0f);
+}
@@ -0,0 +1,111 @@
+#ifndef SAMPLE_FILTER_H
+#define SAMPLE_FILTER_H
+
+#include <stdint.h>
+
+#define SAMPLE_FILTER_MAX_MEDIAN 7
+#define SAMPLE_FILTER_MAX_DERIVATIVE 32
+
+enum FilterSmoother {
+  FILTER_SMOOTHER_NONE,
+  FILTER_SMOOTHER_IIR,      // One-pole low pass, coefficient from the actual sample interval
+  FILTER_SMOOTHER_KALMAN    // Scalar Kalman filter with random-walk process model
+};
+
+struct SampleFilterConfig {
+  uint8_t medianWindow;          // Samples in the de-spiking median (1 = off, odd, max 7)
+  FilterSmoother smoother;
+  float iirTimeConstantS;        // IIR time constant
+  float kalmanProcessNoise;      // Kalman process noise q in C^2/s
+  float kalmanMeasurementNoise;  // Kalman measurement noise r in C^2
+  uint8_t derivativeWindow;      // Samples in the least-squares slope (2 - 32)
+};
+
+// Cost per stage in units of the cost clock, noise as high-frequency standard deviation
+struct SampleFilterStats {
+  uint32_t samples;
+  uint32_t medianCost;           // Average per sample
+  uint32_t smootherCost;
+  uint32_t derivativeCost;
+  uint32_t maxTotalCost;
+  float inputNoise;              // Estimated noise of the raw samples
+  float outputNoise;             // Estimated noise after the pipeline
+};
+
+// Sample processing between the thermocouple driver and the controller:
+// median de-spiking, IIR or Kalman smoothing and a derivative estimate fitted
+// over the real sample timestamps, so jitter in the acquisition does not show
+// up as derivative noise.
+class SampleFilter {
+private:
+  SampleFilterConfig config;
+
+  // Median stage
+  float medianBuffer[SAMPLE_FILTER_MAX_MEDIAN];
+  uint8_t medianCount;
+  uint8_t medianIndex;
+
+  // Smoother stage
+  float value;
+  float variance;               // Kalman error covariance
+  uint32_t lastTimestampUs;
+  bool valid;
+
+  // Derivative stage
+  float derivativeValue[SAMPLE_FILTER_MAX_DERIVATIVE];
+  uint32_t derivativeTime[SAMPLE_FILTER_MAX_DERIVATIVE];
+  uint8_t derivativeCount;
+  uint8_t derivativeIndex;
+  float derivative;
+
+  // Statistics
+  uint32_t (*costClock)();
+  uint32_t samples;
+  uint64_t medianCostSum;
+  uint64_t smootherCostSum;
+  uint64_t derivativeCostSum;
+  uint32_t maxTotalCost;
+
+  // High-frequency noise from the variance of successive differences
+  struct DifferenceNoise {
+    float last;
+    uint32_t count;
+    float mean;
+    float m2;
+    void reset();
+    void add(float sample);
+    float sigma() const;
+  };
+  DifferenceNoise inputNoise;
+  DifferenceNoise outputNoise;
+
+  float median(float sample);
+  float smooth(float sample, float dtS);
+  void updateDerivative(float sample, uint32_t timestampUs);
+
+public:
+  SampleFilter(const SampleFilterConfig& config);
+
+  static SampleFilterConfig defaultConfig();
+
+  void setConfig(const SampleFilterConfig& config);
+  const SampleFilterConfig& getConfig() const { return config; }
+
+  // Clock used to measure the per-stage cost (cycle counter or microseconds)
+  void setCostClock(uint32_t (*clock)()) { costClock = clock; }
+
+  // Feed one raw sample, returns the filtered temperature
+  float update(float sample, uint32_t timestampUs);
+
+  void reset();
+
+  bool isValid() const { return valid; }
+  float getValue() const { return value; }
+  float getDerivative() const { return derivative; }   // C/s
+  uint32_t getLastTimestampUs() const { return lastTimestampUs; }
+
+  SampleFilterStats getStats() const;
+  void resetStats();
+};
+
+#endif // SAMPLE_FILTER_H
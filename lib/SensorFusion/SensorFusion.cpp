@@ -0,0 +1,121 @@
+#include "SensorFusion.h"
+
+SensorFusion::SensorFusion(uint8_t channels) : config(defaultConfig()), value(0.0f), rate(0.0f), source(0) {
+  setChannels(channels);
+}
+
+FusionConfig SensorFusion::defaultConfig() {
+  FusionConfig c;
+  c.policy = FUSION_POLICY_PRIMARY;
+  for (uint8_t i = 0; i < FUSION_MAX_CHANNELS; i++) {
+    c.weights[i] = 1.0f;
+  }
+  for (uint8_t i = 0; i < FUSION_PHASES; i++) {
+    c.phaseChannel[i] = 0;
+  }
+  c.staleMs = 2000;
+  return c;
+}
+
+void SensorFusion::setChannels(uint8_t channels) {
+  if (channels < 1) channels = 1;
+  if (channels > FUSION_MAX_CHANNELS) channels = FUSION_MAX_CHANNELS;
+  this->channels = channels;
+  for (uint8_t i = 0; i < FUSION_MAX_CHANNELS; i++) {
+    values[i] = 0.0f;
+    rates[i] = 0.0f;
+    updatedMs[i] = 0;
+    valid[i] = false;
+  }
+}
+
+void SensorFusion::update(uint8_t channel, float valueC, float rateCPerS, uint32_t nowMs) {
+  if (channel >= channels) return;
+  values[channel] = valueC;
+  rates[channel] = rateCPerS;
+  updatedMs[channel] = nowMs;
+  valid[channel] = true;
+}
+
+void SensorFusion::invalidate(uint8_t channel) {
+  if (channel >= channels) return;
+  valid[channel] = false;
+}
+
+bool SensorFusion::isHealthy(uint8_t channel, uint32_t nowMs) const {
+  return channel < channels && valid[channel] && nowMs - updatedMs[channel] < config.staleMs;
+}
+
+uint8_t SensorFusion::getHealthyMask(uint32_t nowMs) const {
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < channels; i++) {
+    if (isHealthy(i, nowMs)) mask |= 1 << i;
+  }
+  return mask;
+}
+
+bool SensorFusion::pick(uint8_t channel) {
+  value = values[channel];
+  rate = rates[channel];
+  source = channel;
+  return true;
+}
+
+bool SensorFusion::fuse(uint8_t phase, uint32_t nowMs) {
+  uint8_t healthy = getHealthyMask(nowMs);
+  if (healthy == 0) {
+    return false;
+  }
+  // First healthy channel, the primary when it is available
+  uint8_t fallback = 0;
+  while (!(healthy & (1 << fallback))) fallback++;
+
+  switch (config.policy) {
+    case FUSION_POLICY_MAX: {
+      uint8_t hottest = fallback;
+      for (uint8_t i = fallback + 1; i < channels; i++) {
+        if ((healthy & (1 << i)) && values[i] > values[hottest]) hottest = i;
+      }
+      return pick(hottest);
+    }
+
+    case FUSION_POLICY_WEIGHTED: {
+      float sum = 0.0f;
+      float weightedValue = 0.0f;
+      float weightedRate = 0.0f;
+      for (uint8_t i = 0; i < channels; i++) {
+        if ((healthy & (1 << i)) && config.weights[i] > 0.0f) {
+          sum += config.weights[i];
+          weightedValue += config.weights[i] * values[i];
+          weightedRate += config.weights[i] * rates[i];
+        }
+      }
+      if (sum <= 0.0f) {
+        return pick(fallback);
+      }
+      value = weightedValue / sum;
+      rate = weightedRate / sum;
+      source = -1;
+      return true;
+    }
+
+    case FUSION_POLICY_PHASE: {
+      uint8_t selected = phase < FUSION_PHASES ? config.phaseChannel[phase] : 0;
+      return pick(selected < channels && (healthy & (1 << selected)) ? selected : fallback);
+    }
+
+    case FUSION_POLICY_PRIMARY:
+    default:
+      return pick(fallback);
+  }
+}
+
+const char* SensorFusion::policyName(FusionPolicy policy) {
+  switch (policy) {
+    case FUSION_POLICY_PRIMARY: return "Primary";
+    case FUSION_POLICY_MAX: return "Max";
+    case FUSION_POLICY_WEIGHTED: return "Weighted";
+    case FUSION_POLICY_PHASE: return "Per phase";
+  }
+  return "?";
+}
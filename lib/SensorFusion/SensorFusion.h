@@ -0,0 +1,76 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include <stdint.h>
+
+#define FUSION_MAX_CHANNELS 4
+// Phases with their own channel under FUSION_POLICY_PHASE (preheat, soak, reflow, cool)
+#define FUSION_PHASES 4
+// Phase argument outside the profile: the primary channel is used
+#define FUSION_PHASE_NONE 0xFF
+
+// How the probe readings become the controlled temperature
+enum FusionPolicy {
+  FUSION_POLICY_PRIMARY,    // Channel 0 only (oven air)
+  FUSION_POLICY_MAX,        // Hottest healthy probe, nothing on the board runs ahead of the control
+  FUSION_POLICY_WEIGHTED,   // Weighted average of the healthy probes
+  FUSION_POLICY_PHASE       // One channel per phase, e.g. air while preheating, board during reflow
+};
+
+struct FusionConfig {
+  FusionPolicy policy;
+  float weights[FUSION_MAX_CHANNELS];       // FUSION_POLICY_WEIGHTED, renormalised over healthy probes
+  uint8_t phaseChannel[FUSION_PHASES];      // FUSION_POLICY_PHASE
+  uint32_t staleMs;                         // A channel without a reading for this long is left out
+};
+
+// Fuses up to FUSION_MAX_CHANNELS temperature probes into one controlled
+// variable. Each channel carries a filtered value and its rate; a channel
+// that is invalid or stale drops out and the policy falls back to the
+// remaining probes, the primary channel (0) first. Platform independent.
+class SensorFusion {
+private:
+  FusionConfig config;
+  uint8_t channels;
+  float values[FUSION_MAX_CHANNELS];
+  float rates[FUSION_MAX_CHANNELS];
+  uint32_t updatedMs[FUSION_MAX_CHANNELS];
+  bool valid[FUSION_MAX_CHANNELS];
+
+  float value;
+  float rate;
+  int8_t source;
+
+  bool isHealthy(uint8_t channel, uint32_t nowMs) const;
+  bool pick(uint8_t channel);
+
+public:
+  SensorFusion(uint8_t channels = 1);
+
+  static FusionConfig defaultConfig();
+  void setConfig(const FusionConfig& config) { this->config = config; }
+  const FusionConfig& getConfig() const { return config; }
+
+  void setChannels(uint8_t channels);
+  uint8_t getChannels() const { return channels; }
+
+  // Latest filtered reading of a channel and its rate in C/s
+  void update(uint8_t channel, float valueC, float rateCPerS, uint32_t nowMs);
+  // Channel has no usable reading (open probe, bus error)
+  void invalidate(uint8_t channel);
+
+  // Fuse the healthy channels for the given phase (0 - FUSION_PHASES-1 or FUSION_PHASE_NONE),
+  // false if no channel is healthy and the previous result is kept
+  bool fuse(uint8_t phase, uint32_t nowMs);
+
+  float getValue() const { return value; }
+  float getRate() const { return rate; }
+  // Channel the value came from, -1 for a weighted blend
+  int8_t getSource() const { return source; }
+  // Bit n set if channel n is healthy
+  uint8_t getHealthyMask(uint32_t nowMs) const;
+
+  static const char* policyName(FusionPolicy policy);
+};
+
+#endif // SENSOR_FUSION_H
@@ -0,0 +1,105 @@
+#include "SetpointTrajectory.h"
+
+SetpointTrajectory::SetpointTrajectory() : count(0), cursor(0) {
+}
+
+TrajectoryRates SetpointTrajectory::defaultRates() {
+  TrajectoryRates r;
+  r.preheatRate = 1.5f;
+  r.reflowRate = 1.5f;
+  r.coolRate = 2.0f;
+  r.minSoakS = 30.0f;
+  return r;
+}
+
+void SetpointTrajectory::clear() {
+  count = 0;
+  cursor = 0;
+}
+
+bool SetpointTrajectory::addPoint(float timeS, float temperatureC, TrajectoryPhase phase) {
+  if (count >= TRAJECTORY_MAX_POINTS) return false;
+  if (count > 0 && timeS <= points[count - 1].timeS) return false;
+
+  points[count].timeS = timeS;
+  points[count].temperatureC = temperatureC;
+  points[count].phase = phase;
+  slopes[count] = 0.0f;
+  if (count > 0) {
+    const TrajectoryPoint& prev = points[count - 1];
+    slopes[count - 1] = (temperatureC - prev.temperatureC) / (timeS - prev.timeS);
+  }
+  count++;
+  return true;
+}
+
+void SetpointTrajectory::buildFromStages(float startC, float preheatEndC, float soakEndC, float peakC,
+                                         float coolEndC, float totalS, const TrajectoryRates& rates) {
+  clear();
+  float preheatS = preheatEndC > startC ? (preheatEndC - startC) / rates.preheatRate : 1.0f;
+  float reflowS = peakC > soakEndC ? (peakC - soakEndC) / rates.reflowRate : 1.0f;
+  float coolS = peakC > coolEndC ? (peakC - coolEndC) / rates.coolRate : 1.0f;
+  float soakS = totalS - preheatS - reflowS - coolS;
+  if (soakS < rates.minSoakS) soakS = rates.minSoakS;
+
+  float t = 0.0f;
+  addPoint(t, startC, TRAJECTORY_PREHEAT);
+  t += preheatS;
+  addPoint(t, preheatEndC, TRAJECTORY_SOAK);
+  t += soakS;
+  addPoint(t, soakEndC, TRAJECTORY_REFLOW);
+  t += reflowS;
+  addPoint(t, peakC, TRAJECTORY_COOL);
+  t += coolS;
+  addPoint(t, coolEndC, TRAJECTORY_END);
+}
+
+// Segment index containing the time, searching forward from start
+uint8_t SetpointTrajectory::segmentFrom(uint8_t start, float timeS) const {
+  uint8_t i = start;
+  while (i + 1 < count && timeS >= points[i + 1].timeS) i++;
+  return i;
+}
+
+float SetpointTrajectory::evaluate(float timeS, float* slope) {
+  if (count == 0) {
+    if (slope) *slope = 0.0f;
+    return 0.0f;
+  }
+  if (timeS < points[cursor].timeS) cursor = 0;
+  cursor = segmentFrom(cursor, timeS);
+
+  const TrajectoryPoint& p = points[cursor];
+  if (timeS < p.timeS || cursor + 1 >= count) {
+    // Before the first or after the last knot the curve is flat
+    if (slope) *slope = 0.0f;
+    return p.temperatureC;
+  }
+  if (slope) *slope = slopes[cursor];
+  return p.temperatureC + slopes[cursor] * (timeS - p.timeS);
+}
+
+float SetpointTrajectory::lookahead(float timeS, float horizonS, float* slope) const {
+  if (count == 0) {
+    if (slope) *slope = 0.0f;
+    return 0.0f;
+  }
+  float t = timeS + horizonS;
+  uint8_t start = t >= points[cursor].timeS ? cursor : 0;
+  uint8_t i = segmentFrom(start, t);
+  const TrajectoryPoint& p = points[i];
+  if (t < p.timeS || i + 1 >= count) {
+    if (slope) *slope = 0.0f;
+    return p.temperatureC;
+  }
+  if (slope) *slope = slopes[i];
+  return p.temperatureC + slopes[i] * (t - p.timeS);
+}
+
+TrajectoryPhase SetpointTrajectory::phaseAt(float timeS) const {
+  if (count == 0) return TRAJECTORY_END;
+  if (timeS < points[0].timeS) return (TrajectoryPhase)points[0].phase;
+  // Lookahead queries must not drag the cursor away from the control time
+  uint8_t start = timeS >= points[cursor].timeS ? cursor : 0;
+  return (TrajectoryPhase)points[segmentFrom(start, timeS)].phase;
+}
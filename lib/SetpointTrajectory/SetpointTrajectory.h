@@ -0,0 +1,72 @@
+#ifndef SETPOINT_TRAJECTORY_H
+#define SETPOINT_TRAJECTORY_H
+
+#include <stdint.h>
+
+#define TRAJECTORY_MAX_POINTS 8
+
+// Phase of the segment starting at a knot
+enum TrajectoryPhase {
+  TRAJECTORY_PREHEAT,
+  TRAJECTORY_SOAK,
+  TRAJECTORY_REFLOW,
+  TRAJECTORY_COOL,
+  TRAJECTORY_END
+};
+
+struct TrajectoryPoint {
+  float timeS;
+  float temperatureC;
+  uint8_t phase;            // TrajectoryPhase of the following segment
+};
+
+// Ramp rates used to place the knots of a profile in time
+struct TrajectoryRates {
+  float preheatRate;        // C/s up to the end of preheat
+  float reflowRate;         // C/s from the end of soak to the peak
+  float coolRate;           // C/s (positive) from the peak to the end of cooling
+  float minSoakS;           // Soak never gets less time than this
+};
+
+// Continuous piecewise-linear setpoint curve. Segment slopes are precomputed
+// and a cursor follows the (normally increasing) query time, so evaluate()
+// is O(1) per control tick; going back in time restarts the cursor.
+class SetpointTrajectory {
+private:
+  TrajectoryPoint points[TRAJECTORY_MAX_POINTS];
+  float slopes[TRAJECTORY_MAX_POINTS];
+  uint8_t count;
+  uint8_t cursor;
+
+  uint8_t segmentFrom(uint8_t start, float timeS) const;
+
+public:
+  SetpointTrajectory();
+
+  static TrajectoryRates defaultRates();
+
+  void clear();
+  // Knots must be added in increasing time, false when full or out of order
+  bool addPoint(float timeS, float temperatureC, TrajectoryPhase phase);
+
+  // Knots of a reflow profile: ramp from startC to the end of preheat, soak up
+  // to soakEndC, ramp to the peak, cool to coolEndC. Soak gets whatever the
+  // total time leaves after the ramps (at least minSoakS).
+  void buildFromStages(float startC, float preheatEndC, float soakEndC, float peakC, float coolEndC,
+                       float totalS, const TrajectoryRates& rates);
+
+  // Setpoint at the time, slope in C/s if requested
+  float evaluate(float timeS, float* slope = nullptr);
+
+  // Setpoint and slope horizonS ahead of the time, without moving the cursor
+  float lookahead(float timeS, float horizonS, float* slope = nullptr) const;
+
+  // Phase of the segment at the time, without moving the cursor
+  TrajectoryPhase phaseAt(float timeS) const;
+
+  uint8_t size() const { return count; }
+  const TrajectoryPoint& point(uint8_t i) const { return points[i]; }
+  float getDuration() const { return count ? points[count - 1].timeS : 0.0f; }
+};
+
+#endif // SETPOINT_TRAJECTORY_H
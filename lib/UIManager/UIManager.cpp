@@ -1,25 +1,10 @@
 #include "UIManager.h"
 #include "config.h"
 
-// Forward declaration of profile_t structure
-typedef struct {
-  char title[32];
-  char alloy[32];
-  uint16_t melting_point;
-  uint16_t temp_range_0;
-  uint16_t temp_range_1;
-  uint16_t time_range_0;
-  uint16_t time_range_1;
-  char reference[128];
-  uint16_t stages_preheat_0;
-  uint16_t stages_preheat_1;
-  uint16_t stages_soak_0;
-  uint16_t stages_soak_1;
-  uint16_t stages_reflow_0;
-  uint16_t stages_reflow_1;
-  uint16_t stages_cool_0;
-  uint16_t stages_cool_1;
-} profile_t;
+// Profile layout shared with main.cpp (includes the gain schedule)
+#include "ProfileManager.h"
+// Hardware cut-off log kept by main.cpp
+#include "CutoffLog.h"
 
 // Define NUM_OF_PROFILES if not already defined
 #ifndef NUM_OF_PROFILES
@@ -37,6 +22,11 @@ extern profile_t paste_profile[10];
 extern bool connected;
 extern bool isFault;
 extern int profileNum;
+extern bool autotuneRequested;
+extern bool characterizeRequested;
+extern RunReport lastRunReport;
+extern volatile bool runReportReady;
+extern CutoffLog cutoffLog;
 
 // Standalone function for TouchInterface to call
 void onProfileSelect(int profileIndex) {
@@ -72,7 +62,8 @@ void UIManager::update() {
   if (profileIsOn && currentScreen != SCREEN_REFLOW_RUNNING) {
     switchToScreen(SCREEN_REFLOW_RUNNING);
   } else if (!profileIsOn && currentScreen == SCREEN_REFLOW_RUNNING) {
-    switchToScreen(SCREEN_MAIN);
+    // A completed run shows its conformance score first
+    switchToScreen(runReportReady ? SCREEN_RUN_RESULT : SCREEN_MAIN);
   }
   
   // Update temperature display if on main or reflow screen
@@ -116,6 +107,9 @@ void UIManager::drawCurrentScreen() {
     case SCREEN_INFO:
       drawInfoScreen();
       break;
+    case SCREEN_RUN_RESULT:
+      drawRunResultScreen();
+      break;
   }
 }
 
@@ -229,6 +223,10 @@ void UIManager::drawSettingsScreen() {
   buttons.settings_buttons[0] = touchInterface->addButton(20, 50, 120, 30, "Fan: ON", ILI9341_BLUE, ILI9341_WHITE, nullptr);
   buttons.settings_buttons[1] = touchInterface->addButton(20, 90, 120, 30, "Buzzer: ON", ILI9341_BLUE, ILI9341_WHITE, nullptr);
   buttons.settings_buttons[2] = touchInterface->addButton(20, 130, 120, 30, "OTA: ON", ILI9341_BLUE, ILI9341_WHITE, nullptr);
+  // Relay autotune of the PID gains around the selected profile's phase temperatures
+  buttons.settings_autotune = touchInterface->addButton(180, 50, 120, 30, "Autotune", ILI9341_ORANGE, ILI9341_BLACK, onAutotune);
+  // Step-response run that identifies the oven model
+  buttons.settings_characterize = touchInterface->addButton(180, 90, 120, 30, "Characterize", ILI9341_ORANGE, ILI9341_BLACK, onCharacterize);
   
   // Add back button
   buttons.settings_back = touchInterface->addButton(120, 200, 80, 30, "Back", ILI9341_RED, ILI9341_WHITE, onBack);
@@ -264,6 +262,14 @@ void UIManager::drawInfoScreen() {
   display->print("Current Temp: ");
   display->print(input, 1);
   display->print("C");
+  display->setCursor(10, 130);
+  display->print("HW cut-off trips: ");
+  display->print(cutoffLog.trips);
+  if (cutoffLog.trips > 0) {
+    display->print(", last ");
+    display->print(cutoffLog.lastTemperatureC, 1);
+    display->print("C");
+  }
   
   // Add back button
   buttons.info_back = touchInterface->addButton(120, 200, 80, 30, "Back", ILI9341_RED, ILI9341_WHITE, onBack);
@@ -271,6 +277,40 @@ void UIManager::drawInfoScreen() {
   touchInterface->drawButtons();
 }
 
+void UIManager::drawRunResultScreen() {
+  const RunReport& r = lastRunReport;
+  bool pass = r.complete && r.failed == 0;
+  drawHeader("Run Complete");
+
+  display->setTextColor(pass ? ILI9341_GREEN : ILI9341_RED);
+  display->setTextSize(3);
+  display->setCursor(20, 45);
+  display->print(pass ? "PASS" : "FAIL");
+  display->setCursor(160, 45);
+  display->print(r.score);
+  display->print("%");
+
+  // One line per check, failed ones in red
+  const uint8_t checks[RUN_CHECK_COUNT] = {RUN_CHECK_TAL, RUN_CHECK_PEAK, RUN_CHECK_RAMP,
+                                           RUN_CHECK_COOL, RUN_CHECK_SOAK, RUN_CHECK_DURATION};
+  const String values[RUN_CHECK_COUNT] = {
+    String(r.talS, 0) + " s", String(r.peakC, 1) + " C", String(r.maxRampRate, 2) + " C/s",
+    String(r.maxCoolRate, 2) + " C/s", String(r.soakS, 0) + " s", String(r.durationS, 0) + " s"
+  };
+  display->setTextSize(1);
+  for (int i = 0; i < RUN_CHECK_COUNT; i++) {
+    display->setTextColor((r.failed & checks[i]) ? ILI9341_RED : ILI9341_WHITE);
+    display->setCursor(20, 85 + i * 16);
+    display->print(RunAnalyzer::checkName(checks[i]));
+    display->setCursor(100, 85 + i * 16);
+    display->print(values[i]);
+  }
+
+  buttons.result_ok = touchInterface->addButton(120, 200, 80, 30, "OK", ILI9341_BLUE, ILI9341_WHITE, onRunResultOk);
+
+  touchInterface->drawButtons();
+}
+
 // Static callback functions
 void UIManager::onStartReflow() {
   if (uiManager) {
@@ -313,6 +353,31 @@ void UIManager::onStopReflow() {
   }
 }
 
+void UIManager::onAutotune() {
+  autotuneRequested = true;
+  profileIsOn = true;
+  disableMenu = true;
+  if (uiManager) {
+    uiManager->switchToScreen(SCREEN_REFLOW_RUNNING);
+  }
+}
+
+void UIManager::onCharacterize() {
+  characterizeRequested = true;
+  profileIsOn = true;
+  disableMenu = true;
+  if (uiManager) {
+    uiManager->switchToScreen(SCREEN_REFLOW_RUNNING);
+  }
+}
+
+void UIManager::onRunResultOk() {
+  runReportReady = false;
+  if (uiManager) {
+    uiManager->switchToScreen(SCREEN_MAIN);
+  }
+}
+
 void UIManager::onSettingToggle(int settingIndex) {
   // Handle setting toggles
   // This would need to be implemented based on your specific settings
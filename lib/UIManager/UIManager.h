@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "TouchInterface.h"
 #include "LCD.h"
+#include "RunAnalyzer.h"
 
 
 // Screen states
@@ -12,7 +13,8 @@ enum ScreenState {
   SCREEN_PROFILE_SELECT,
   SCREEN_SETTINGS,
   SCREEN_REFLOW_RUNNING,
-  SCREEN_INFO
+  SCREEN_INFO,
+  SCREEN_RUN_RESULT
 };
 
 class UIManager {
@@ -35,8 +37,11 @@ public:
     int profile_select_buttons[10]; // Up to 10 profiles
     int settings_back;
     int settings_buttons[5]; // Various settings
+    int settings_autotune;
+    int settings_characterize;
     int reflow_stop;
     int info_back;
+    int result_ok;
   } buttons;
   
   // Screen drawing functions
@@ -45,6 +50,7 @@ public:
   void drawSettingsScreen();
   void drawReflowRunningScreen();
   void drawInfoScreen();
+  void drawRunResultScreen();
   
   // Button callback functions
   static void onStartReflow();
@@ -54,6 +60,9 @@ public:
   static void onProfileSelect(int profileIndex);
   static void onStopReflow();
   static void onSettingToggle(int settingIndex);
+  static void onAutotune();
+  static void onCharacterize();
+  static void onRunResultOk();
   
   // Helper functions
   void clearScreen();
@@ -10,10 +10,17 @@
 #include "OTA.h"
 #include "ProfileManager.h"
 #include "reflow_logic.h"
-#include <Adafruit_MCP9600.h>
+#include "MCP9600Sensor.h"
+#include "SampleFilter.h"
+#include "MCP9600Scheduler.h"
+#include "SensorFusion.h"
 #include <XPT2046_Touchscreen.h>
 #include "TouchInterface.h"
 #include "UIManager.h"
+#include "ControlTask.h"
+#include "SSROutput.h"
+#include "GainSchedule.h"
+#include "ControlClock.h"
 
 // Function prototypes
 void updatePreferences();
@@ -21,9 +28,65 @@ void processButtons();
 void listDir(fs::FS &fs, const char * dirname, uint8_t levels);
 void readFile(fs::FS & fs, String path, const char * type);
 void wifiSetup();
-
-// MCP9600 Thermocouple sensor (I2C)
-Adafruit_MCP9600 mcp9600;
+void controlTick();
+void uiTask(void* arg);
+uint32_t cycleCount();
+void printFilterStats();
+void loadOvenGains();
+void saveOvenGains();
+void startAutotunePhase();
+void applyAutotuneResults();
+void finishCalibration();
+void enterFault();
+void setCutoffLimit(float limitC);
+void IRAM_ATTR onCutoffAlert();
+void handleCutoffTrip();
+void loadCutoffLog();
+void saveCutoffLog();
+void loadPlantModel();
+void savePlantModel();
+void loadLearning();
+void saveLearning(int profile);
+void clearLearning();
+void saveRunReport();
+float profileMaxRampRate(const profile_t& profile);
+RunSpec runSpecFromProfile(const profile_t& profile);
+uint8_t runStage(ReflowState state);
+uint8_t fusionPhase(ReflowState state);
+void readProbes();
+SequencerConfig sequencerConfig();
+SequencerProfile sequencerProfile(profile_t& profile);
+ReflowState reflowStateOf(SequencerStage stage);
+SSRModulation stateModulation(ReflowState state);
+
+// MCP9600 Thermocouple sensors (I2C): oven air, optional board top and bottom probes,
+// sampled round-robin by one acquisition task
+MCP9600Sensor thermocouple;
+MCP9600Sensor boardTopProbe(MCP9600_BOARD_TOP_ADDRESS);
+MCP9600Sensor boardBottomProbe(MCP9600_BOARD_BOTTOM_ADDRESS);
+MCP9600Scheduler sensorScheduler;
+
+// Oversampled thermocouple readings pass through this pipeline before the PID
+SampleFilter sampleFilter(SampleFilter::defaultConfig());
+SampleFilter boardTopFilter(SampleFilter::defaultConfig());
+SampleFilter boardBottomFilter(SampleFilter::defaultConfig());
+
+MCP9600Sensor* probes[SENSOR_PROBE_COUNT] = {&thermocouple, &boardTopProbe, &boardBottomProbe};
+SampleFilter* probeFilters[SENSOR_PROBE_COUNT] = {&sampleFilter, &boardTopFilter, &boardBottomFilter};
+bool probeFound[SENSOR_PROBE_COUNT];
+
+// Probe readings into the controlled temperature (input) and its rate
+SensorFusion sensorFusion(SENSOR_PROBES);
+float inputRate;
+// Air probe alone, for the oven models (observer, characterization)
+float airTemperature;
+// Thermal-runaway and sensor-plausibility checks, a latched fault forces the SSR off
+FaultEngine faultEngine(FaultEngine::defaultConfig());
+// Set by the MCP9600 alert interrupt after it cut the SSR
+volatile bool cutoffTripped = 0;
+volatile unsigned long cutoffTripUs;
+bool cutoffHandled = 0;
+CutoffLog cutoffLog = {0, 0, 0};
 
 // Use hardware SPI
 //Adafruit_ILI9341 display = Adafruit_ILI9341(display_cs, display_dc, display_rst);
@@ -112,22 +175,23 @@ String readVersion;
 OTA ota("", "", ""); // TODO: Add proper URLs
 ProfileManager profileManager;
 
+// Time source of the control path; simulations and replays substitute a VirtualClock
+ArduinoClock arduinoClock;
+ControlClock* controlClock = &arduinoClock;
+
 // Variables for reflow logic
 int windowSize;
-unsigned long nextCheck;
-unsigned long nextRead;
+// Control path schedules, rollover-safe on the control clock
+PeriodicTimer checkTimer;
+PeriodicTimer readTimer;
+PeriodicTimer computeTimer;
 
 // PID control variables
-double setpoint;
-double input;
-double output;
-double kp = PID_KP_PREHEAT;
-double ki = PID_KI_PREHEAT;
-double kd = PID_KD_PREHEAT;
+float setpoint;
+float input;
+float output;
 int inputInt;
-unsigned long windowStartTime;
-unsigned long timerSoak;
-unsigned long buzzerPeriod;
+uint32_t buzzerPeriod;
 
 // Reflow state variables
 ReflowState reflowState;
@@ -137,8 +201,57 @@ long lastDebounceTime;
 Switch switchStatus;
 int timerSeconds;
 
-// PID control object
-PID reflowOvenPID(&input, &output, &setpoint, kp, ki, kd, DIRECT);
+// Profile run: trajectory, phase changes and the PID/MPC (single precision or
+// Q16.16, see PID_NUMERIC_TYPE), the same code the native simulation runs
+ReflowSequencer<PID_NUMERIC_TYPE> sequencer;
+
+// Per-phase PID gains, defaults until an autotune result is stored in NVS
+OvenGains ovenGains = {
+  {PID_KP_PREHEAT, PID_KI_PREHEAT, PID_KD_PREHEAT},
+  {PID_KP_SOAK, PID_KI_SOAK, PID_KD_SOAK},
+  {PID_KP_REFLOW, PID_KI_REFLOW, PID_KD_REFLOW}
+};
+
+// Learned feed-forward correction per profile (NVS), the running profile's is in learning
+IterativeLearning learning(IterativeLearning::defaultConfig(0));
+ILCStore learningStore[NUM_OF_PROFILES];
+int learningProfile = 0;
+
+// Conformance of the running profile, scored at completion and kept in NVS
+RunAnalyzer runAnalyzer;
+RunReport lastRunReport;
+volatile bool runReportReady = 0;
+uint32_t runStartMs;
+
+// Relay autotuner, runs one experiment per phase (preheat, soak, reflow)
+RelayAutotuner autotuner(RelayAutotuner::defaultConfig(0));
+// Start of the current autotune phase or characterization; the experiments
+// get seconds since then so their timeouts and periods survive the rollover
+uint32_t calibrationStartMs;
+bool autotuneRequested = 0;
+byte autotunePhase = 0;
+// Operating point of each finished phase, applied once all three succeed
+GainPoint autotunePoints[3];
+// Set by the control task, NVS is written from the UI task
+volatile bool saveGainsPending = 0;
+volatile bool saveProfilePending = 0;
+volatile bool savePlantPending = 0;
+volatile bool saveLearningPending = 0;
+volatile bool clearLearningPending = 0;
+volatile bool saveRunPending = 0;
+volatile bool saveCutoffPending = 0;
+
+// Identified oven model (NVS), filled by the characterization wizard
+PlantModel plantModel = {0, 0, 0, 0, 0, 0};
+OvenCharacterizer characterizer(OvenCharacterizer::defaultConfig());
+bool characterizeRequested = 0;
+
+// Fixed-rate control task (sensor, PID and SSR), UI runs in its own task on the other core
+ControlTask controlTask(controlTick, CONTROL_TASK_PERIOD_MS, CONTROL_TASK_CORE, CONTROL_TASK_PRIORITY);
+TaskHandle_t uiTaskHandle = nullptr;
+
+// Hardware-timer driven SSR output, latches the PID duty once per window
+SSROutput ssr(SSR_PIN, SSR_TIMER);
 
 void setup() {
   WiFi.mode(WIFI_STA); // explicitly set mode, esp defaults to STA+AP
@@ -159,6 +272,11 @@ void setup() {
   useSPIFFS = preferences.getBool("useSPIFFS", 0);
   preferences.end();
 
+  loadOvenGains();
+  loadPlantModel();
+  loadLearning();
+  loadCutoffLog();
+
   Serial.println();
   Serial.println("Buttons: " + String(buttons));
   Serial.println("Fan is: " + String(fan));
@@ -193,8 +311,9 @@ void setup() {
   // lcd.startScreen(); // TODO: Fix LCD compatibility
 
   if ( !SPIFFS.begin(FORMAT_SPIFFS_IF_FAILED)) {
+    // Keep going: the SSR still has to be initialised and the control task started
     Serial.println("Error mounting SPIFFS");
-    return;
+    useSPIFFS = 0;
   }
 
   // SSR pin initialization to ensure reflow oven is off
@@ -244,20 +363,100 @@ void setup() {
   }
 
   // Initialize MCP9600 thermocouple sensor
-  if (!mcp9600.begin()) {
-    Serial.println("MCP9600 sensor not found!");
-  } else {
-    Serial.println("MCP9600 sensor initialized successfully");
-    mcp9600.setThermocoupleType(MCP9600_TYPE_K);
-    mcp9600.setADCresolution(MCP9600_ADCRESOLUTION_18);
+  Wire.begin(I2C_SDA, I2C_SCL, I2C_FREQUENCY);
+  for (int i = 0; i < SENSOR_PROBES; i++) {
+    probeFound[i] = probes[i]->begin(MCP9600_TC_K, SENSOR_RESOLUTION);
+    if (!probeFound[i]) {
+      Serial.println("MCP9600 sensor " + String(i) + " not found!");
+    } else {
+      Serial.println("MCP9600 sensor " + String(i) + " initialized successfully");
+      sensorScheduler.add(*probes[i]);
+    }
+  }
+  // Fusion of the probes into the controlled temperature
+  FusionConfig fusionConfig = SensorFusion::defaultConfig();
+  fusionConfig.policy = SENSOR_FUSION_POLICY;
+  fusionConfig.weights[SENSOR_PROBE_AIR] = SENSOR_WEIGHT_AIR;
+  fusionConfig.weights[SENSOR_PROBE_BOARD_TOP] = SENSOR_WEIGHT_BOARD_TOP;
+  fusionConfig.weights[SENSOR_PROBE_BOARD_BOTTOM] = SENSOR_WEIGHT_BOARD_BOTTOM;
+  fusionConfig.phaseChannel[0] = SENSOR_PROBE_PREHEAT;
+  fusionConfig.phaseChannel[1] = SENSOR_PROBE_SOAK;
+  fusionConfig.phaseChannel[2] = SENSOR_PROBE_REFLOW;
+  fusionConfig.phaseChannel[3] = SENSOR_PROBE_COOL;
+  fusionConfig.staleMs = SENSOR_STALE_TIME;
+  sensorFusion.setConfig(fusionConfig);
+  Serial.println("Sensor fusion: " + String(SensorFusion::policyName(SENSOR_FUSION_POLICY)));
+
+  // Configure the sample filter pipeline
+  SampleFilterConfig filterConfig;
+  filterConfig.medianWindow = FILTER_MEDIAN_WINDOW;
+  filterConfig.smoother = FILTER_SMOOTHER;
+  filterConfig.iirTimeConstantS = FILTER_IIR_TIME_CONSTANT;
+  filterConfig.kalmanProcessNoise = FILTER_KALMAN_Q;
+  filterConfig.kalmanMeasurementNoise = FILTER_KALMAN_R;
+  filterConfig.derivativeWindow = FILTER_DERIVATIVE_WINDOW;
+  for (int i = 0; i < SENSOR_PROBES; i++) {
+    probeFilters[i]->setConfig(filterConfig);
   }
+  sampleFilter.setCostClock(cycleCount);
+
+  // Configure the fault engine
+  FaultConfig faultConfig = FaultEngine::defaultConfig();
+  faultConfig.minPlausibleC = FAULT_MIN_TEMPERATURE;
+  faultConfig.maxPlausibleC = FAULT_MAX_TEMPERATURE;
+  faultConfig.overTemperatureC = FAULT_OVER_TEMPERATURE;
+  faultConfig.staleMs = SENSOR_STALE_TIME;
+  faultConfig.sensorDebounce = FAULT_SENSOR_DEBOUNCE;
+  faultConfig.jumpC = FAULT_JUMP;
+  faultConfig.jumpConfirm = FAULT_JUMP_CONFIRM;
+  faultConfig.flatlineMs = FAULT_FLATLINE_TIME;
+  faultConfig.flatlineBandC = FAULT_FLATLINE_BAND;
+  faultConfig.flatlineMinDuty = FAULT_FLATLINE_DUTY;
+  faultConfig.heatingWindowMs = FAULT_HEATING_WINDOW;
+  faultConfig.heatingFullDuty = FAULT_HEATING_DUTY;
+  faultConfig.heatingMinRiseC = FAULT_HEATING_RISE;
+  faultConfig.stuckGraceMs = FAULT_STUCK_GRACE;
+  faultConfig.stuckCoastC = FAULT_STUCK_COAST;
+  faultConfig.stuckRiseC = FAULT_STUCK_RISE;
+  faultEngine.setConfig(faultConfig);
 
   // Set window size
   windowSize = 2000;
-  // Initialize time keeping variable
-  nextCheck = millis();
-  // Initialize thermocouple reading variable
-  nextRead = millis();
+  AutotuneConfig autotuneConfig = RelayAutotuner::defaultConfig(windowSize);
+  autotuneConfig.hysteresisC = AUTOTUNE_HYSTERESIS;
+  autotuneConfig.cycles = AUTOTUNE_CYCLES;
+  autotuneConfig.timeoutS = AUTOTUNE_TIMEOUT;
+  autotuneConfig.maxTemperatureC = TEMPERATURE_REFLOW_MAX;
+  autotuneConfig.rule = AUTOTUNE_RULE;
+  autotuner.setConfig(autotuneConfig);
+  CharacterizeConfig characterizeConfig = OvenCharacterizer::defaultConfig();
+  characterizeConfig.samplePeriodS = PID_SAMPLE_TIME / 1000.0f;
+  characterizeConfig.baselineS = CHARACTERIZE_BASELINE_TIME;
+  characterizeConfig.stepDuty = CHARACTERIZE_STEP_DUTY;
+  characterizeConfig.peakC = CHARACTERIZE_PEAK;
+  characterizeConfig.coolDropC = CHARACTERIZE_COOL_DROP;
+  characterizeConfig.holdDuty = CHARACTERIZE_HOLD_DUTY;
+  characterizeConfig.holdS = CHARACTERIZE_HOLD_TIME;
+  characterizeConfig.maxDeadTimeS = CHARACTERIZE_MAX_DEAD_TIME;
+  characterizeConfig.timeoutS = CHARACTERIZE_TIMEOUT;
+  characterizeConfig.maxTemperatureC = TEMPERATURE_REFLOW_MAX;
+  characterizer.setConfig(characterizeConfig);
+  // Start the SSR timer, output stays off until the PID sets a duty
+  ssr.begin((uint32_t)windowSize * 1000, 1000000UL / (2 * MAINS_FREQUENCY));
+  // Independent over-temperature cut-off from the MCP9600 alert output
+  if (!probeFound[SENSOR_PROBE_AIR]) {
+    Serial.println("Hardware cut-off not programmed: air probe not found");
+  }
+  setCutoffLimit(TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN);
+  pinMode(MCP9600_ALERT_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(MCP9600_ALERT_PIN), onCutoffAlert, FALLING);
+  if (digitalRead(MCP9600_ALERT_PIN) == LOW) {
+    // Already over the limit at boot
+    onCutoffAlert();
+  }
+  // Initialize time keeping and thermocouple reading schedules
+  checkTimer.start(controlClock->nowMs(), 1000);
+  readTimer.start(controlClock->nowMs(), SENSOR_SAMPLING_TIME);
   
   // Initialize reflow state variables
   reflowState = REFLOW_STATE_IDLE;
@@ -312,6 +511,11 @@ void setup() {
     Serial.println(paste_profile[i].alloy);
   }
   Serial.println();
+
+  // Start control on its own core, UI, networking and sensor acquisition on the other one
+  sensorScheduler.start(SENSOR_POLL_PERIOD_MS, SENSOR_TASK_CORE, SENSOR_TASK_PRIORITY);
+  controlTask.begin(CONTROL_TASK_STACK);
+  xTaskCreatePinnedToCore(uiTask, "ui", 8192, nullptr, UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
 }
 
 void updatePreferences() {
@@ -344,17 +548,57 @@ void processButtons() {
 }
 
 void loop() {
-  wm.process();
-  if (state != 9) { // if we are in test menu, disable LED & SSR control in loop
+  // All work is done by the control and UI tasks, the Arduino loop task is not needed
+  vTaskDelete(NULL);
+}
+
+void controlTick() {
+  if (state != 9) { // if we are in test menu, disable LED & SSR control
     reflow_main();
   }
-  processButtons();
-  
-  // Update UI with current temperature and status
-  if (uiManager) {
-    uiManager->updateTemperature(input);
-    uiManager->updateStatus(activeStatus);
-    uiManager->setLCDData();  // Keep LCD data in sync
+}
+
+void uiTask(void* arg) {
+  for (;;) {
+    wm.process();
+    processButtons();
+
+    if (saveGainsPending) {
+      saveGainsPending = 0;
+      saveOvenGains();
+    }
+    if (savePlantPending) {
+      savePlantPending = 0;
+      savePlantModel();
+    }
+    if (saveProfilePending) {
+      saveProfilePending = 0;
+      profileManager.saveProfiles(profileUsed, paste_profile[profileUsed]);
+    }
+    if (clearLearningPending) {
+      clearLearningPending = 0;
+      clearLearning();
+    }
+    if (saveLearningPending) {
+      saveLearningPending = 0;
+      saveLearning(learningProfile);
+    }
+    if (saveRunPending) {
+      saveRunPending = 0;
+      saveRunReport();
+    }
+    if (saveCutoffPending) {
+      saveCutoffPending = 0;
+      saveCutoffLog();
+    }
+
+    // Update UI with current temperature and status
+    if (uiManager) {
+      uiManager->updateTemperature(input);
+      uiManager->updateStatus(reflowStateName(reflowState));
+      uiManager->setLCDData();  // Keep LCD data in sync
+    }
+    vTaskDelay(pdMS_TO_TICKS(UI_TASK_PERIOD_MS));
   }
 }
 
@@ -417,22 +661,415 @@ void wifiSetup() {
   }
 }
 
-// Reflow main function implementation
+uint32_t cycleCount() {
+  return ESP.getCycleCount();
+}
+
+void printFilterStats() {
+  SampleFilterStats s = sampleFilter.getStats();
+  Serial.println("Sample filter: " + String(s.samples) + " samples, cycles per sample median "
+                 + String(s.medianCost) + ", smoother " + String(s.smootherCost)
+                 + ", derivative " + String(s.derivativeCost) + ", max total " + String(s.maxTotalCost));
+  Serial.println("Sample filter noise: input " + String(s.inputNoise, 3) + " C, output "
+                 + String(s.outputNoise, 3) + " C");
+  MCP9600BusStats b = thermocouple.getBusStats();
+  Serial.println("MCP9600 bus: " + String(b.transactions) + " transactions, " + String(b.retries) + " retries, "
+                 + String(b.failures) + " failed, mean " + String(b.transactions ? (uint32_t)(b.totalUs / b.transactions) : 0)
+                 + " us, max " + String(b.maxUs) + " us");
+}
+
+void loadOvenGains() {
+  OvenGains stored;
+  preferences.begin("gains", true);
+  size_t len = preferences.getBytes("oven", &stored, sizeof(stored));
+  preferences.end();
+  // Keep the compiled-in defaults until a complete set has been tuned
+  if (len == sizeof(stored)) {
+    ovenGains = stored;
+  }
+  Serial.println("PID gains (" + String(len == sizeof(stored) ? "tuned" : "default") + "): preheat "
+                 + String(ovenGains.preheat.kp) + "/" + String(ovenGains.preheat.ki, 4) + "/" + String(ovenGains.preheat.kd)
+                 + ", soak " + String(ovenGains.soak.kp) + "/" + String(ovenGains.soak.ki, 4) + "/" + String(ovenGains.soak.kd)
+                 + ", reflow " + String(ovenGains.reflow.kp) + "/" + String(ovenGains.reflow.ki, 4) + "/" + String(ovenGains.reflow.kd));
+}
+
+void saveOvenGains() {
+  preferences.begin("gains", false);
+  preferences.putBytes("oven", &ovenGains, sizeof(ovenGains));
+  preferences.end();
+  Serial.println("PID gains saved");
+}
+
+void loadPlantModel() {
+  PlantModel stored;
+  preferences.begin("plant", true);
+  size_t len = preferences.getBytes("model", &stored, sizeof(stored));
+  preferences.end();
+  if (len == sizeof(stored) && stored.valid) {
+    plantModel = stored;
+    Serial.println("Oven model: K " + String(plantModel.gainC) + " C, tau " + String(plantModel.tauS)
+                   + " s, dead time " + String(plantModel.deadTimeS) + " s, ambient " + String(plantModel.ambientC) + " C");
+  } else {
+    Serial.println("Oven model: not characterized");
+  }
+}
+
+void savePlantModel() {
+  preferences.begin("plant", false);
+  preferences.putBytes("model", &plantModel, sizeof(plantModel));
+  preferences.end();
+  Serial.println("Oven model saved");
+}
+
+// Learned corrections of all profiles, a missing or stale entry starts empty
+void loadLearning() {
+  IterativeLearning empty(IterativeLearning::defaultConfig(0));
+  preferences.begin("ilc", true);
+  for (int i = 0; i < NUM_OF_PROFILES; i++) {
+    String key = "p" + String(i);
+    size_t len = preferences.getBytes(key.c_str(), &learningStore[i], sizeof(ILCStore));
+    if (len != sizeof(ILCStore) || learningStore[i].version != ILC_STORE_VERSION) {
+      learningStore[i] = empty.getStore();
+    }
+  }
+  preferences.end();
+}
+
+void saveLearning(int profile) {
+  String key = "p" + String(profile);
+  preferences.begin("ilc", false);
+  preferences.putBytes(key.c_str(), &learningStore[profile], sizeof(ILCStore));
+  preferences.end();
+  Serial.println("Learned correction saved, profile " + String(profile) + ", " + String(learningStore[profile].runs) + " runs");
+}
+
+// What was learned compensates the old oven model, start over with a new one
+void clearLearning() {
+  IterativeLearning empty(IterativeLearning::defaultConfig(0));
+  for (int i = 0; i < NUM_OF_PROFILES; i++) {
+    learningStore[i] = empty.getStore();
+  }
+  preferences.begin("ilc", false);
+  preferences.clear();
+  preferences.end();
+  Serial.println("Learned corrections cleared");
+}
+
+// Append the last run report to the NVS ring
+void saveRunReport() {
+  preferences.begin("runs", false);
+  uint8_t next = preferences.getUChar("next", 0) % RUN_HISTORY_SIZE;
+  String key = "r" + String(next);
+  preferences.putBytes(key.c_str(), &lastRunReport, sizeof(lastRunReport));
+  preferences.putUChar("next", (next + 1) % RUN_HISTORY_SIZE);
+  preferences.end();
+  Serial.println("Run report saved as " + key);
+}
+
+void loadCutoffLog() {
+  preferences.begin("safety", true);
+  if (preferences.getBytesLength("cutoff") == sizeof(CutoffLog)) {
+    preferences.getBytes("cutoff", &cutoffLog, sizeof(CutoffLog));
+  }
+  preferences.end();
+  if (cutoffLog.trips > 0) {
+    Serial.println("Hardware cut-off trips: " + String(cutoffLog.trips) + ", last at "
+                   + String(cutoffLog.lastTemperatureC) + " C (limit " + String(cutoffLog.lastLimitC) + " C)");
+  }
+}
+
+void saveCutoffLog() {
+  preferences.begin("safety", false);
+  preferences.putBytes("cutoff", &cutoffLog, sizeof(CutoffLog));
+  preferences.end();
+}
+
+// Program the MCP9600 alert, the acquisition task writes it at its next poll.
+// A probe that was not found is not in the scheduler: setAlert() would write
+// it directly from the control task while the acquisition task owns the bus
+void setCutoffLimit(float limitC) {
+  if (!probeFound[SENSOR_PROBE_AIR]) {
+    return;
+  }
+  if (limitC > TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN) {
+    limitC = TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN;
+  }
+  if (limitC != thermocouple.getAlertLimit(HW_CUTOFF_ALERT)) {
+    thermocouple.setAlert(HW_CUTOFF_ALERT, limitC, HW_CUTOFF_HYSTERESIS);
+  }
+}
+
+// ALERT pin went low: the SSR is cut here, logging waits for the control task
+void IRAM_ATTR onCutoffAlert() {
+  ssr.trip();
+  if (!cutoffTripped) {
+    cutoffTripUs = micros();
+    cutoffTripped = 1;
+  }
+}
+
+// Log the trip and latch it as a fault, the SSR stays tripped until restart
+void handleCutoffTrip() {
+  cutoffHandled = 1;
+  cutoffLog.trips++;
+  cutoffLog.lastLimitC = thermocouple.getAlertLimit(HW_CUTOFF_ALERT);
+  cutoffLog.lastTemperatureC = input;
+  saveCutoffPending = 1;
+  Serial.println("Hardware cut-off tripped at " + String(input) + " C (limit " + String(cutoffLog.lastLimitC)
+                 + " C), seen " + String(micros() - cutoffTripUs) + " us after the alert");
+  faultEngine.raise(FAULT_HARDWARE_CUTOFF, controlClock->nowMs(), input);
+  if (reflowState != REFLOW_STATE_ERROR) {
+    enterFault();
+  }
+}
+
+// Operating temperature of the current autotune phase, taken from the selected profile
+void startAutotunePhase() {
+  profile_t& profile = paste_profile[profileUsed];
+  float target;
+  switch (autotunePhase) {
+    case 0:
+      target = profile.stages_preheat_1;
+      ssr.setModulation(SSR_MODULATION_PREHEAT);
+      break;
+    case 1:
+      target = (profile.stages_soak_0 + profile.stages_soak_1) / 2.0f;
+      ssr.setModulation(SSR_MODULATION_SOAK);
+      break;
+    default:
+      target = (profile.stages_reflow_0 + profile.stages_reflow_1) / 2.0f;
+      ssr.setModulation(SSR_MODULATION_REFLOW);
+      break;
+  }
+  setpoint = target;
+  calibrationStartMs = controlClock->nowMs();
+  autotuner.start(target, 0.0f);
+  Serial.println("Autotune phase " + String(autotunePhase + 1) + "/3 at " + String(target) + " C");
+}
+
+// All three phases succeeded: the phase gains and the profile's gain schedule.
+// The operating points replace entries at the same temperature or are added,
+// the rest of a schedule loaded from JSON stays as it was
+void applyAutotuneResults() {
+  ovenGains.preheat = autotunePoints[0].gains;
+  ovenGains.soak = autotunePoints[1].gains;
+  ovenGains.reflow = autotunePoints[2].gains;
+  profile_t& profile = paste_profile[profileUsed];
+  for (int i = 0; i < 3; i++) {
+    bool stored;
+    profile.gain_points = GainSchedule::merge(profile.gain_schedule, profile.gain_points, autotunePoints[i], &stored);
+    if (!stored) {
+      Serial.println("Gain schedule full, " + String(autotunePoints[i].temperature) + " C point not added");
+    }
+  }
+}
+
+void finishCalibration() {
+  setCutoffLimit(TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN);
+  reflowStatus = REFLOW_STATUS_OFF;
+  reflowState = REFLOW_STATE_IDLE;
+  autotuneRequested = 0;
+  characterizeRequested = 0;
+  profileIsOn = 0;
+  disableMenu = 0;
+}
+
+// Latched fault: heater off and the run abandoned, the ERROR state waits for recovery
+void enterFault() {
+  ssr.off();
+  if (reflowStatus == REFLOW_STATUS_ON && reflowState != REFLOW_STATE_AUTOTUNE && reflowState != REFLOW_STATE_CHARACTERIZE) {
+    learning.discardRun();
+  }
+  sequencer.stop();
+  finishCalibration();
+  reflowState = REFLOW_STATE_ERROR;
+  isFault = 1;
+  Serial.println("Fault: " + String(FaultEngine::faultName(faultEngine.getFault())) + " at "
+                 + String(faultEngine.getFaultTemperature()) + " C");
+}
+
+// Heating rate limit of a profile, J-STD-020 default without max_ramp_rate
+float profileMaxRampRate(const profile_t& profile) {
+  return profile.max_ramp_rate > 0 ? profile.max_ramp_rate / 10.0f : MPC_MAX_RAMP_RATE;
+}
+
+// Sequencer settings from Reflow_logic.h
+SequencerConfig sequencerConfig() {
+  SequencerConfig config = ReflowSequencer<PID_NUMERIC_TYPE>::defaultConfig();
+  config.samplePeriodS = PID_SAMPLE_TIME / 1000.0f;
+  config.windowSize = windowSize;
+  config.rates.preheatRate = TRAJECTORY_PREHEAT_RATE;
+  config.rates.reflowRate = TRAJECTORY_REFLOW_RATE;
+  config.rates.coolRate = TRAJECTORY_COOL_RATE;
+  config.rates.minSoakS = TRAJECTORY_MIN_SOAK;
+  config.maxLagC = TRAJECTORY_MAX_LAG;
+  config.coolEndC = TEMPERATURE_COOL_MIN;
+  config.feedForward = FEEDFORWARD_ENABLED;
+  config.fallbackModel = {1, FEEDFORWARD_GAIN, FEEDFORWARD_TAU, 0, FEEDFORWARD_AMBIENT, 0};
+  config.lookaheadS = FEEDFORWARD_LOOKAHEAD;
+  config.deadTimeCompensation = PID_DEAD_TIME_COMPENSATION;
+  config.peakMarginC = REFLOW_PEAK_MARGIN;
+  config.peakMarginCompensatedC = REFLOW_PEAK_MARGIN_COMPENSATED;
+  config.peakHoldMaxS = REFLOW_PEAK_HOLD_MAX;
+  config.reflowMaxS = REFLOW_MAX_TIME;
+  config.board = {BOARD_TAU, BOARD_MASS_RATIO, BOARD_AIR_CORRECTION, BOARD_BOARD_CORRECTION};
+  config.exitOnBoard = REFLOW_EXIT_ON_BOARD;
+  config.boardPeakHorizonS = BOARD_PEAK_HORIZON;
+  config.controlVariable[0] = CONTROL_VARIABLE_PREHEAT;
+  config.controlVariable[1] = CONTROL_VARIABLE_SOAK;
+  config.controlVariable[2] = CONTROL_VARIABLE_REFLOW;
+  config.modelPredictive = MPC_ENABLED;
+  config.mpcMoveWeight = MPC_MOVE_WEIGHT;
+  return config;
+}
+
+// The part of a profile the sequencer runs
+SequencerProfile sequencerProfile(profile_t& profile) {
+  SequencerProfile run;
+  run.preheatC = profile.stages_preheat_1;
+  run.soakC = profile.stages_soak_1;
+  run.peakC = profile.stages_reflow_1;
+  run.coolC = profile.stages_cool_1;
+  run.durationS = profile.time_range_1 - profile.time_range_0;
+  run.maxRampRate = profileMaxRampRate(profile);
+  run.gainSchedule = profile.gain_schedule;
+  run.gainPoints = profile.gain_points;
+  return run;
+}
+
+// State machine state of a sequencer stage
+ReflowState reflowStateOf(SequencerStage stage) {
+  switch (stage) {
+    case SEQUENCER_PREHEAT:  return REFLOW_STATE_PREHEAT;
+    case SEQUENCER_SOAK:     return REFLOW_STATE_SOAK;
+    case SEQUENCER_REFLOW:   return REFLOW_STATE_REFLOW;
+    case SEQUENCER_COOL:     return REFLOW_STATE_COOL;
+    case SEQUENCER_COMPLETE: return REFLOW_STATE_COMPLETE;
+    default:                 return REFLOW_STATE_IDLE;
+  }
+}
+
+// SSR modulation of a profile state
+SSRModulation stateModulation(ReflowState state) {
+  switch (state) {
+    case REFLOW_STATE_SOAK:   return SSR_MODULATION_SOAK;
+    case REFLOW_STATE_REFLOW: return SSR_MODULATION_REFLOW;
+    case REFLOW_STATE_COOL:   return SSR_MODULATION_COOL;
+    default:                  return SSR_MODULATION_PREHEAT;
+  }
+}
+
+// Conformance limits of a profile
+RunSpec runSpecFromProfile(const profile_t& profile) {
+  RunSpec spec;
+  spec.liquidusC = profile.melting_point;
+  spec.talMinS = RUN_TAL_MIN;
+  spec.talMaxS = RUN_TAL_MAX;
+  spec.peakMinC = profile.stages_reflow_1 - RUN_PEAK_TOLERANCE;
+  spec.peakMaxC = max(profile.temp_range_1, profile.stages_reflow_1);
+  spec.maxRampRate = profileMaxRampRate(profile);
+  spec.maxCoolRate = RUN_MAX_COOL_RATE;
+  spec.soakLowC = profile.stages_soak_0;
+  spec.soakHighC = profile.stages_soak_1;
+  spec.soakMinS = RUN_SOAK_MIN;
+  spec.soakMaxS = RUN_SOAK_MAX;
+  spec.coolEndC = profile.stages_cool_1;
+  spec.maxDurationS = profile.time_range_1 + RUN_DURATION_MARGIN;
+  return spec;
+}
+
+// Stage of the conformance analysis for a state machine state
+uint8_t runStage(ReflowState state) {
+  switch (state) {
+    case REFLOW_STATE_PREHEAT: return RUN_STAGE_PREHEAT;
+    case REFLOW_STATE_SOAK: return RUN_STAGE_SOAK;
+    case REFLOW_STATE_REFLOW: return RUN_STAGE_REFLOW;
+    default: return RUN_STAGE_COOL;
+  }
+}
+
+// Fusion phase of a state, outside a profile the primary (air) probe is used
+uint8_t fusionPhase(ReflowState state) {
+  switch (state) {
+    case REFLOW_STATE_PREHEAT: return 0;
+    case REFLOW_STATE_SOAK: return 1;
+    case REFLOW_STATE_REFLOW: return 2;
+    case REFLOW_STATE_COOL: return 3;
+    default: return FUSION_PHASE_NONE;
+  }
+}
+
+// Drain the probes' FIFOs into their filters; the air probe also feeds the fault engine
+void readProbes() {
+  ThermocoupleSample sample;
+  while (thermocouple.receive(&sample)) {
+    faultEngine.addSample(controlClock->nowMs(), sample.temperature, sample.valid, sample.status & MCP9600_STATUS_INPUT_RANGE,
+                          sample.status & MCP9600_STATUS_SHORT_CIRCUIT);
+    // A NaN would stay in the filter state; the fault engine latches it as out of range
+    if (sample.valid && !isnan(sample.temperature)) {
+      sampleFilter.update(sample.temperature, sample.timestampUs);
+    }
+  }
+  for (int i = 1; i < SENSOR_PROBES; i++) {
+    while (probes[i]->receive(&sample)) {
+      if (sample.valid && !isnan(sample.temperature)) {
+        probeFilters[i]->update(sample.temperature, sample.timestampUs);
+      }
+    }
+  }
+}
+
+// Status text shown by the UI task; the control task only publishes reflowState
+const char* reflowStateName(ReflowState state) {
+  switch (state) {
+    case REFLOW_STATE_IDLE:     return "Idle";
+    case REFLOW_STATE_PREHEAT:  return "Preheat";
+    case REFLOW_STATE_SOAK:     return "Soak";
+    case REFLOW_STATE_REFLOW:   return "Reflow";
+    case REFLOW_STATE_COOL:     return "Cool";
+    case REFLOW_STATE_COMPLETE: return "Complete";
+    case REFLOW_STATE_TOO_HOT:  return "Too hot";
+    case REFLOW_STATE_ERROR:    return FaultEngine::faultName(faultEngine.getFault());
+    case REFLOW_STATE_AUTOTUNE: return "Autotune";
+    case REFLOW_STATE_CHARACTERIZE: return "Characterize";
+  }
+  return "";
+}
+
+// Reflow main function implementation (runs in the control task)
 void reflow_main() {
-  // Current time
-  unsigned long now;
+  // One reading of the control clock per tick, every decision below uses it
+  uint32_t now = controlClock->nowMs();
+
+  if (cutoffTripped && !cutoffHandled) {
+    handleCutoffTrip();
+  }
+
+  // Feed every oversampled reading through the filter pipelines
+  readProbes();
 
   // Time to read thermocouple?
-  if (millis() > nextRead) {
-    // Read thermocouple next sampling period
-    nextRead += SENSOR_SAMPLING_TIME;
-    // Read current temperature
-    input = mcp9600.readThermocouple();
-    // Check for reading errors (simple range check)
-    if (input < -200.0 || input > 1000.0) {
-      Serial.println("MCP9600 reading out of range: " + String(input));
-      isFault = 1;
+  if (readTimer.due(now)) {
+    // Use the filtered temperatures, the acquisition task keeps the I2C bus out of this path
+    for (int i = 0; i < SENSOR_PROBES; i++) {
+      SampleFilter* filter = probeFilters[i];
+      uint32_t ageUs = timeElapsed(controlClock->nowUs(), filter->getLastTimestampUs());
+      if (filter->isValid() && ageUs < SENSOR_STALE_TIME * 1000UL) {
+        sensorFusion.update(i, filter->getValue(), filter->getDerivative(), now);
+        if (i == SENSOR_PROBE_AIR) airTemperature = filter->getValue();
+      } else {
+        // No fresh valid conversion: the probe drops out of the fusion (the fault engine
+        // reports the air probe), restart the filter from the first good sample after recovery
+        sensorFusion.invalidate(i);
+        filter->reset();
+      }
+    }
+    if (sensorFusion.fuse(fusionPhase(reflowState), now)) {
+      input = sensorFusion.getValue();
+      inputRate = sensorFusion.getRate();
     }
+    // Plausibility and thermal-runaway checks against the duty the SSR was given
+    faultEngine.update(now, input, reflowStatus == REFLOW_STATUS_ON ? output / windowSize : 0.0f);
     inputInt = input / 1;
 
     if (oldTemp != inputInt) {
@@ -445,18 +1082,17 @@ void reflow_main() {
         Serial.println("Integer temp: " + String(inputInt));
       }
     }
-    // If thermocouple problem detected
-    if (input == -999.0) { // MCP9600 error value
-      // Illegal operation
-      reflowState = REFLOW_STATE_ERROR;
-      reflowStatus = REFLOW_STATUS_OFF;
-    }
     oldTemp = inputInt;
   }
 
-  if (millis() > nextCheck) {
-    // Check input in the next seconds
-    nextCheck += 1000;
+  // Any latched fault stops the run and drops SSR_PIN in this tick, also one
+  // latched by a conversion in readProbes() between two sensor reads
+  if (faultEngine.isFaulted() && reflowState != REFLOW_STATE_ERROR) {
+    enterFault();
+  }
+
+  // Check input every second
+  if (checkTimer.due(now)) {
     // If reflow process is on going
     if (reflowStatus == REFLOW_STATUS_ON) {
       // Toggle red LED as system heart beat
@@ -477,35 +1113,89 @@ void reflow_main() {
     }
     // If currently in error state
     if (reflowState == REFLOW_STATE_ERROR) {
-      // No thermocouple wire connected
-      Serial.println("TC Error!");
+      Serial.println("Fault: " + String(FaultEngine::faultName(faultEngine.getFault())));
     }
   }
 
   // Reflow oven controller state machine
   switch (reflowState) {
     case REFLOW_STATE_IDLE:
-      activeStatus = "Idle";
       // If oven temperature is still above room temperature
       if (input >= TEMPERATURE_ROOM) {
         reflowState = REFLOW_STATE_TOO_HOT;
         Serial.println("Status: Too hot to start");
       } else {
+        // Autotune requested from the settings screen
+        if (profileIsOn != 0 && autotuneRequested) {
+          Serial.println("Time Setpoint Input Output");
+          timerSeconds = 0;
+          autotunePhase = 0;
+          output = 0;
+          computeTimer.start(now, PID_SAMPLE_TIME);
+          startAutotunePhase();
+          reflowState = REFLOW_STATE_AUTOTUNE;
+        }
+        // Oven characterization requested from the settings screen
+        else if (profileIsOn != 0 && characterizeRequested) {
+          Serial.println("Time Setpoint Input Output");
+          timerSeconds = 0;
+          setpoint = CHARACTERIZE_PEAK;
+          output = 0;
+          computeTimer.start(now, PID_SAMPLE_TIME);
+          ssr.setModulation(SSR_MODULATION_PREHEAT);
+          calibrationStartMs = now;
+          characterizer.start(0.0f);
+          reflowState = REFLOW_STATE_CHARACTERIZE;
+        }
         // If switch is pressed to start reflow process
-        if (profileIsOn != 0) {
+        else if (profileIsOn != 0) {
           // Send header for CSV file
           Serial.println("Time Setpoint Input Output");
           // Intialize seconds timer for serial debug information
           timerSeconds = 0;
-          // Initialize PID control window starting time
-          windowStartTime = millis();
-          // Ramp up to minimum soaking temperature
-          setpoint = paste_profile[profileUsed].stages_preheat_1;
-          // Tell the PID to range between 0 and the full window size
-          reflowOvenPID.SetOutputLimits(0, windowSize);
-          reflowOvenPID.SetSampleTime(PID_SAMPLE_TIME);
-          // Turn the PID on
-          reflowOvenPID.SetMode(AUTOMATIC);
+          profile_t& profile = paste_profile[profileUsed];
+          ssr.setModulation(SSR_MODULATION_PREHEAT);
+          // Trajectory from the current temperature, preheat gains, feed-forward, dead-time
+          // compensation, board observer and MPC from the oven model
+          sequencer.setConfig(sequencerConfig());
+#if ILC_ENABLED
+          sequencer.setLearning(&learning);
+#endif
+          sequencer.start(now, input, airTemperature, sequencerProfile(profile), plantModel, ovenGains);
+          setpoint = sequencer.getSetpoint();
+          runAnalyzer.begin(runSpecFromProfile(profile), profileUsed);
+          setCutoffLimit(max(profile.stages_reflow_1, profile.temp_range_1) + HW_CUTOFF_MARGIN);
+          runStartMs = now;
+          runReportReady = 0;
+          if (sequencer.isModelPredictive()) {
+            Serial.println("Model-predictive control, peak " + String(profile.stages_reflow_1) + " C, ramp "
+                           + String(profileMaxRampRate(profile)) + " C/s");
+          }
+          // Learn over the trajectory up to the peak, the hold and cut-off differ from run to run
+          const PlantModel& model = sequencer.getFeedForwardModel();
+          ILCConfig ilcConfig = IterativeLearning::defaultConfig(0);
+          ilcConfig.binS = ILC_BIN_TIME;
+          ilcConfig.learningGain = ILC_LEARNING_GAIN;
+          ilcConfig.leadS = model.deadTimeS > 0 ? model.deadTimeS : FEEDFORWARD_LOOKAHEAD;
+          ilcConfig.forgetting = ILC_FORGETTING;
+          ilcConfig.limit = ILC_LIMIT;
+          learning.setConfig(ilcConfig);
+          learningProfile = profileUsed;
+          learning.load(&learningStore[learningProfile]);
+          learning.begin(sequencer.getTrajectory().point(3).timeS);
+          if (learning.getRuns() > 0) {
+            Serial.println("Learned correction from " + String(learning.getRuns()) + " runs");
+          }
+          if (sequencer.getSmithPredictor().isEnabled()) {
+            Serial.println("Dead-time compensation on, " + String(sequencer.getSmithPredictor().getDeadTime()) + " s");
+          }
+          output = 0;
+          computeTimer.start(now, PID_SAMPLE_TIME);
+          // Start fresh control timing and output statistics for this run
+          controlTask.resetStats();
+          ssr.resetStats();
+          sampleFilter.resetStats();
+          thermocouple.resetBusStats();
           // Proceed to preheat stage
           reflowState = REFLOW_STATE_PREHEAT;
         }
@@ -513,71 +1203,56 @@ void reflow_main() {
       break;
 
     case REFLOW_STATE_PREHEAT:
-      activeStatus = "Preheat";
+    case REFLOW_STATE_SOAK:
+    case REFLOW_STATE_REFLOW:
+    case REFLOW_STATE_COOL: {
       reflowStatus = REFLOW_STATUS_ON;
-      // If minimum soak temperature is achieve
-      if (input >= paste_profile[profileUsed].stages_preheat_1) {
-        // Chop soaking period into smaller sub-period
-        timerSoak = millis() + SOAK_MICRO_PERIOD;
-        // Set less agressive PID parameters for soaking ramp
-        reflowOvenPID.SetTunings(PID_KP_SOAK, PID_KI_SOAK, PID_KD_SOAK);
-        // Ramp up to first section of soaking temperature
-        setpoint = paste_profile[profileUsed].stages_preheat_1 + SOAK_TEMPERATURE_STEP;
-        // Proceed to soaking state
-        reflowState = REFLOW_STATE_SOAK;
+      // Trajectory, phase gains, the peak cut-off and the control output every PID_SAMPLE_TIME
+      output = sequencer.update(now, input, inputRate, airTemperature);
+      setpoint = sequencer.getSetpoint();
+      ReflowState next = reflowStateOf(sequencer.getStage());
+      if (next == reflowState) {
+        break;
       }
-      break;
-
-    case REFLOW_STATE_SOAK:
-      activeStatus = "Soak";
-      // If micro soak temperature is achieved
-      if (millis() > timerSoak) {
-        timerSoak = millis() + SOAK_MICRO_PERIOD;
-        // Increment micro setpoint
-        setpoint += SOAK_TEMPERATURE_STEP;
-        if (setpoint > paste_profile[profileUsed].stages_soak_1) {
-          // Set agressive PID parameters for reflow ramp
-          reflowOvenPID.SetTunings(PID_KP_REFLOW, PID_KI_REFLOW, PID_KD_REFLOW);
-          // Ramp up to first section of soaking temperature
-          setpoint = paste_profile[profileUsed].stages_reflow_1;
-          // Proceed to reflowing state
-          reflowState = REFLOW_STATE_REFLOW;
-        }
+      reflowState = next;
+      if (next != REFLOW_STATE_COMPLETE) {
+        ssr.setModulation(stateModulation(next));
+        break;
       }
-      break;
-
-    case REFLOW_STATE_REFLOW:
-      activeStatus = "Reflow";
-      // We need to avoid hovering at peak temperature for too long
-      // Crude method that works like a charm and safe for the components
-      if (input >= (paste_profile[profileUsed].stages_reflow_1 - 5)) {
-        // Set PID parameters for cooling ramp
-        reflowOvenPID.SetTunings(PID_KP_REFLOW, PID_KI_REFLOW, PID_KD_REFLOW);
-        // Ramp down to minimum cooling temperature
-        setpoint = TEMPERATURE_COOL_MIN;
-        // Proceed to cooling state
-        reflowState = REFLOW_STATE_COOL;
+      // Minimum cooling temperature reached
+      // Retrieve current time for buzzer usage
+      buzzerPeriod = now + 1000;
+      // Turn on buzzer and green LED to indicate completion
+      digitalWrite(RGB_LED_B, HIGH);
+      // Turn off reflow process
+      reflowStatus = REFLOW_STATUS_OFF;
+#if ILC_ENABLED
+      // Only completed runs teach the next one
+      if (learning.finishRun()) {
+        Serial.println("Run tracking error " + String(learning.getRunRmsError()) + " C rms");
+        learningStore[learningProfile] = learning.getStore();
+        saveLearningPending = 1;
       }
-      break;
-
-    case REFLOW_STATE_COOL:
-      activeStatus = "Cool";
-      // If minimum cool temperature is achieve
-      if (input <= TEMPERATURE_COOL_MIN) {
-        // Retrieve current time for buzzer usage
-        buzzerPeriod = millis() + 1000;
-        // Turn on buzzer and green LED to indicate completion
-        digitalWrite(RGB_LED_B, HIGH);
-        // Turn off reflow process
-        reflowStatus = REFLOW_STATUS_OFF;
-        // Proceed to reflow Completion state
-        reflowState = REFLOW_STATE_COMPLETE;
+#endif
+      // Score the run and show it on the completion screen
+      lastRunReport = runAnalyzer.finish();
+      Serial.print("Run score " + String(lastRunReport.score) + (runAnalyzer.passed() ? " PASS" : " FAIL") + ":");
+      Serial.print(" TAL " + String(lastRunReport.talS, 1) + " s, peak " + String(lastRunReport.peakC, 1) + " C");
+      Serial.print(", ramp " + String(lastRunReport.maxRampRate, 2) + " C/s, cool " + String(lastRunReport.maxCoolRate, 2));
+      Serial.println(" C/s, soak " + String(lastRunReport.soakS, 0) + " s, " + String(lastRunReport.durationS, 0) + " s");
+      for (uint8_t check = 1; check < (1 << RUN_CHECK_COUNT); check <<= 1) {
+        if (lastRunReport.failed & check) Serial.println("  failed: " + String(RunAnalyzer::checkName(check)));
       }
+      runReportReady = 1;
+      saveRunPending = 1;
+      controlTask.printStats();
+      ssr.printStats();
+      printFilterStats();
       break;
+    }
 
     case REFLOW_STATE_COMPLETE:
-      activeStatus = "Complete";
-      if (millis() > buzzerPeriod) {
+      if (timeReached(now, buzzerPeriod)) {
         // Turn off buzzer and green LED
         digitalWrite(RGB_LED_B, LOW);
         digitalWrite(RGB_LED_G, HIGH);
@@ -585,6 +1260,7 @@ void reflow_main() {
         reflowState = REFLOW_STATE_IDLE;
         profileIsOn = 0;
         disableMenu = 0;
+        setCutoffLimit(TEMPERATURE_REFLOW_MAX + HW_CUTOFF_MARGIN);
         Serial.println("Profile is OFF");
       }
       break;
@@ -597,12 +1273,60 @@ void reflow_main() {
       }
       break;
 
+    case REFLOW_STATE_AUTOTUNE:
+      reflowStatus = REFLOW_STATUS_ON;
+      // Stopped from the UI
+      if (profileIsOn == 0) {
+        autotuner.cancel();
+      }
+      if (autotuner.getState() == AUTOTUNE_DONE) {
+        const AutotuneResult& r = autotuner.getResult();
+        Serial.println("Autotune: Ku " + String(r.ku) + ", Pu " + String(r.pu) + " s, Kp " + String(r.gains.kp)
+                       + ", Ki " + String(r.gains.ki, 4) + ", Kd " + String(r.gains.kd));
+        GainPoint& point = autotunePoints[autotunePhase];
+        point.temperature = (uint16_t)setpoint;
+        point.phase = GAIN_PHASE_ANY;
+        point.gains = r.gains;
+        autotunePhase++;
+        if (autotunePhase < 3) {
+          startAutotunePhase();
+        } else {
+          Serial.println("Autotune complete");
+          applyAutotuneResults();
+          saveGainsPending = 1;
+          saveProfilePending = 1;
+          finishCalibration();
+        }
+      } else if (autotuner.getState() == AUTOTUNE_FAILED) {
+        Serial.println("Autotune aborted, gains unchanged");
+        finishCalibration();
+      }
+      break;
+
+    case REFLOW_STATE_CHARACTERIZE:
+      reflowStatus = REFLOW_STATUS_ON;
+      if (profileIsOn == 0) {
+        characterizer.cancel();
+      }
+      if (characterizer.getState() == CHARACTERIZE_DONE) {
+        plantModel = characterizer.getModel();
+        Serial.println("Characterization: K " + String(plantModel.gainC) + " C, tau " + String(plantModel.tauS)
+                       + " s, dead time " + String(plantModel.deadTimeS) + " s, ambient " + String(plantModel.ambientC)
+                       + " C, fit error " + String(plantModel.rmsErrorC, 3) + " C");
+        savePlantPending = 1;
+        clearLearningPending = 1;
+        finishCalibration();
+      } else if (characterizer.getState() == CHARACTERIZE_FAILED) {
+        Serial.println("Characterization aborted, model unchanged");
+        finishCalibration();
+      }
+      break;
+
     case REFLOW_STATE_ERROR:
-      // If thermocouple problem is still present
-      if (input == -999.0) {
-        // Wait until thermocouple wire is connected
-        reflowState = REFLOW_STATE_ERROR;
-      } else {
+      // Sensor faults clear once the thermocouple delivers again, thermal faults need a restart
+      if (faultEngine.isRecoverable() && faultEngine.isSensorHealthy(now) && sampleFilter.isValid()) {
+        faultEngine.clear();
+        isFault = 0;
         // Clear to perform reflow process
         reflowState = REFLOW_STATE_IDLE;
       }
@@ -662,18 +1386,24 @@ void reflow_main() {
   //     break;
   // }
 
-  // PID computation and SSR control
+  // Run sampling, calibration outputs and SSR control; the profile states get their output from the sequencer
   if (reflowStatus == REFLOW_STATUS_ON) {
-    now = millis();
-    reflowOvenPID.Compute();
-    if ((now - windowStartTime) > windowSize) {
-      // Time to shift the Relay Window
-      windowStartTime += windowSize;
+    if (computeTimer.due(now)) {
+      if (reflowState >= REFLOW_STATE_PREHEAT && reflowState <= REFLOW_STATE_COOL) {
+        runAnalyzer.addSample(timeElapsed(now, runStartMs) / 1000.0f, input, runStage(reflowState));
+      }
+      if (reflowState == REFLOW_STATE_AUTOTUNE) {
+        // Relay output while the autotuner is identifying the oven
+        output = autotuner.update(input, timeElapsed(now, calibrationStartMs) / 1000.0f);
+      } else if (reflowState == REFLOW_STATE_CHARACTERIZE) {
+        // Open-loop heater steps, every sample goes into the model fit
+        output = characterizer.update(airTemperature, timeElapsed(now, calibrationStartMs) / 1000.0f) * windowSize;
+      }
     }
-    if (output > (now - windowStartTime)) digitalWrite(SSR_PIN, HIGH);
-    else digitalWrite(SSR_PIN, LOW);
+    // PID output is the on-time in ms of one window, the timer latches it at the next window start
+    ssr.setDuty(faultEngine.isFaulted() ? 0.0f : output / windowSize);
   } else {
     // Reflow oven process is off, ensure oven is off
-    digitalWrite(SSR_PIN, LOW);
+    ssr.off();
   }
 }
\ No newline at end of file
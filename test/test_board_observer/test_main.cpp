@@ -0,0 +1,145 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "BoardObserver.h"
+#include "PlantModel.h"
+#include "SetpointTrajectory.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+#define PEAK_C 217.0f
+
+void setUp() {}
+void tearDown() {}
+
+// Oven with a 4 s dead time and a board of 30% of its heat capacity lagging it by 15 s
+static OvenParameters boardOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 4.0f;
+  p.boardMassJPerK = 225.0f;
+  p.boardTransferWPerK = 15.0f;
+  return p;
+}
+
+static PlantModel ovenModel() {
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  return m;
+}
+
+static BoardModel boardModel(float boardTauS) {
+  BoardModel b = BoardObserver::defaultBoard();
+  b.boardTauS = boardTauS;
+  b.massRatio = 0.3f;
+  return b;
+}
+
+struct RunResult {
+  float worstEstimateC;     // Largest |estimated - true board| while heating
+  float worstRawC;          // Largest |air measurement - true board|
+  float boardPeakC;         // Highest true board temperature
+  float cutoffAirC;         // Air measurement at the heater cut-off
+};
+
+// SAC305 ramp on the air with the repo's PID and feed-forward, heater cut at the peak either
+// when the air reaches peak - 5 C (REFLOW_PEAK_MARGIN) or when the observer
+// predicts the board will reach the peak
+static RunResult runReflow(float observerTauS, bool cutOnBoard) {
+  OvenSimulator oven(boardOven());
+  SetpointTrajectory trajectory;
+  TrajectoryRates rates = SetpointTrajectory::defaultRates();
+  rates.preheatRate = 1.0f;
+  rates.reflowRate = 0.4f;
+  trajectory.buildFromStages(25, 150, 180, PEAK_C, 150, 300, rates);
+  float peakTimeS = trajectory.point(3).timeS;
+
+  BoardObserver observer;
+  observer.configure(ovenModel(), boardModel(observerTauS), 1.0f);
+  observer.reset(25.0f);
+
+  PlantModel model = ovenModel();
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(25.0f, 0.0f);
+
+  RunResult r = {0.0f, 0.0f, 0.0f, 0.0f};
+  bool heating = true;
+  float duty = 0.0f;
+  for (int s = 0; s < 900; s++) {
+    float measured = oven.getSensorTemperature();
+    observer.update(measured, duty);
+    if (heating) {
+      float slope = 0.0f;
+      float setpoint = s >= peakTimeS ? PEAK_C : trajectory.evaluate(s);
+      if (s < peakTimeS) trajectory.lookahead(s, model.deadTimeS, &slope);
+      float ff = model.feedForwardDuty(measured, slope) * WINDOW_SIZE;
+      pid.setOutputLimits(-ff, WINDOW_SIZE - ff);
+      duty = (ff + pid.compute(setpoint, measured)) / WINDOW_SIZE;
+      bool cut = cutOnBoard ? observer.predictBoardPeak(120.0f) >= PEAK_C : measured >= PEAK_C - 5.0f;
+      if (cut) {
+        heating = false;
+        duty = 0.0f;
+        r.cutoffAirC = measured;
+      }
+      float board = oven.getBoardTemperature();
+      if (fabsf(observer.getBoard() - board) > r.worstEstimateC) r.worstEstimateC = fabsf(observer.getBoard() - board);
+      if (fabsf(measured - board) > r.worstRawC) r.worstRawC = fabsf(measured - board);
+    }
+    for (int i = 0; i < 10; i++) oven.step(duty, STEP_S);
+    if (oven.getBoardTemperature() > r.boardPeakC) r.boardPeakC = oven.getBoardTemperature();
+  }
+  return r;
+}
+
+void test_board_lags_air_at_steady_state_gain() {
+  BoardObserver observer;
+  TEST_ASSERT_FALSE(observer.configure(PlantModel{0, 0, 0, 0, 0, 0}, BoardObserver::defaultBoard(), 1.0f));
+  // Unconfigured, the board is the air
+  observer.update(80.0f, 0.5f);
+  TEST_ASSERT_EQUAL_FLOAT(80.0f, observer.getBoard());
+
+  TEST_ASSERT_TRUE(observer.configure(ovenModel(), boardModel(15.0f), 1.0f));
+  observer.reset(25.0f);
+  PlantModel m = ovenModel();
+  float duty = 0.4f;
+  // Feed the model's own air response: both nodes settle at ambient + gain * duty
+  float air = 25.0f;
+  for (int s = 0; s < 3000; s++) {
+    observer.update(air, duty);
+    air = observer.getAir();
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, m.ambientC + m.gainC * duty, observer.getBoard());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, observer.getLag());
+}
+
+void test_estimate_tracks_board_during_reflow() {
+  RunResult exact = runReflow(15.0f, false);
+  RunResult mismatched = runReflow(10.0f, false);
+  printf("\nBoard estimate during a SAC305 run, worst error\n");
+  printf("%-28s %8.2f C\n", "air measurement", exact.worstRawC);
+  printf("%-28s %8.2f C\n", "observer, board tau 15 s", exact.worstEstimateC);
+  printf("%-28s %8.2f C\n", "observer, board tau 10 s", mismatched.worstEstimateC);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.25f * exact.worstRawC, exact.worstEstimateC);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.5f * exact.worstRawC, mismatched.worstEstimateC);
+}
+
+void test_board_cutoff_reaches_peak() {
+  RunResult air = runReflow(15.0f, false);
+  RunResult board = runReflow(15.0f, true);
+  printf("\nREFLOW cut-off, peak %.0f C\n", PEAK_C);
+  printf("%-26s %12s %14s\n", "exit test", "cut-off air", "board peak C");
+  printf("%-26s %12.2f %14.2f\n", "air >= peak - 5", air.cutoffAirC, air.boardPeakC);
+  printf("%-26s %12.2f %14.2f\n", "predicted board >= peak", board.cutoffAirC, board.boardPeakC);
+  TEST_ASSERT_FLOAT_WITHIN(1.5f, PEAK_C, board.boardPeakC);
+  TEST_ASSERT_LESS_THAN_FLOAT(fabsf(air.boardPeakC - PEAK_C), fabsf(board.boardPeakC - PEAK_C));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_board_lags_air_at_steady_state_gain);
+  RUN_TEST(test_estimate_tracks_board_during_reflow);
+  RUN_TEST(test_board_cutoff_reaches_peak);
+  return UNITY_END();
+}
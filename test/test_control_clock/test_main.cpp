@@ -0,0 +1,122 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "ControlClock.h"
+#include "ReflowSequencer.h"
+#include "OvenSimulator.h"
+
+#define TICK_MS 10
+#define WINDOW_SIZE 2000.0f
+
+void setUp() {}
+void tearDown() {}
+
+void test_virtual_clock_steps() {
+  VirtualClock clock;
+  TEST_ASSERT_EQUAL(0, clock.nowMs());
+  clock.advanceMs(1500);
+  clock.advanceUs(250);
+  TEST_ASSERT_EQUAL(1500, clock.nowMs());
+  TEST_ASSERT_EQUAL(1500250UL, clock.nowUs());
+  // Both wrap like millis() and micros()
+  clock.setMs(0xFFFFFFFFUL);
+  clock.advanceMs(2);
+  TEST_ASSERT_EQUAL(1, clock.nowMs());
+  VirtualClock us(4294967UL);
+  us.advanceMs(1);
+  TEST_ASSERT_TRUE(us.nowUs() < 1000000UL);
+
+  TEST_ASSERT_TRUE(timeReached(5, 0xFFFFFFF0UL));
+  TEST_ASSERT_FALSE(timeReached(0xFFFFFFF0UL, 5));
+  TEST_ASSERT_EQUAL(21, timeElapsed(5, 0xFFFFFFF0UL));
+}
+
+// Counts the firings of a 1 s schedule over 60 s starting 30 s before the wrap
+void test_periodic_timer_across_rollover() {
+  VirtualClock clock(0xFFFFFFFFUL - 30000UL);
+  PeriodicTimer timer;
+  timer.start(clock.nowMs(), 1000);
+  uint32_t naiveNext = clock.nowMs();
+  int fired = 0, naiveFired = 0;
+  uint32_t longestGap = 0, lastFire = clock.nowMs();
+  for (int i = 0; i < 6000; i++) {
+    clock.advanceMs(TICK_MS);
+    uint32_t now = clock.nowMs();
+    if (timer.due(now)) {
+      fired++;
+      if (timeElapsed(now, lastFire) > longestGap) longestGap = timeElapsed(now, lastFire);
+      lastFire = now;
+    }
+    // The comparison reflow_main() used before
+    if (now > naiveNext) {
+      naiveNext += 1000;
+      naiveFired++;
+    }
+  }
+  printf("\n1 s schedule over 60 s across the wrap: %d periods (naive compare %d), longest gap %u ms\n", fired,
+         naiveFired, longestGap);
+  // At the start and after each of the 60 seconds
+  TEST_ASSERT_EQUAL(61, fired);
+  TEST_ASSERT_EQUAL(1000, longestGap);
+  // The naive schedule stops at the wrap
+  TEST_ASSERT_LESS_THAN(40, naiveFired);
+}
+
+struct ClockedRun {
+  uint32_t ticks;
+  float outputSum;
+  float peakC;
+  bool completed;
+};
+
+// Full profile on the simulated oven, every time from the virtual clock
+static ClockedRun runFrom(uint32_t startMs) {
+  VirtualClock clock(startMs);
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 3.0f;
+  p.sensorNoiseC = 0.25f;
+  OvenSimulator oven(p);
+  oven.setNoiseSeed(11);
+  PlantModel model = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  OvenGains gains = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+  SequencerProfile profile = {150, 180, 217, 150, 300, 3.0f, 0, 0};
+  ReflowSequencer<float> sequencer;
+  sequencer.start(clock.nowMs(), 25.0f, 25.0f, profile, model, gains);
+
+  ClockedRun r = {0, 0.0f, 0.0f, false};
+  for (uint32_t i = 0; i < 20UL * 60UL * 100UL; i++) {
+    float reading = oven.getSensorTemperature();
+    float output = sequencer.update(clock.nowMs(), reading, 0.0f, reading);
+    if (sequencer.getStage() == SEQUENCER_COMPLETE) {
+      r.completed = true;
+      break;
+    }
+    r.outputSum += output;
+    oven.step(output / WINDOW_SIZE, TICK_MS / 1000.0f);
+    if (oven.getOvenTemperature() > r.peakC) r.peakC = oven.getOvenTemperature();
+    clock.advanceMs(TICK_MS);
+    r.ticks++;
+  }
+  return r;
+}
+
+// The millisecond counter wraps in the middle of the run (49.7 days of uptime)
+void test_run_is_reproducible_across_rollover() {
+  ClockedRun fromBoot = runFrom(0);
+  ClockedRun wrapping = runFrom(0xFFFFFFFFUL - 200000UL);
+  printf("Run from boot: %u ticks, peak %.2f C; wrapping mid-run: %u ticks, peak %.2f C\n", fromBoot.ticks,
+         fromBoot.peakC, wrapping.ticks, wrapping.peakC);
+  TEST_ASSERT_TRUE(fromBoot.completed);
+  TEST_ASSERT_TRUE(wrapping.completed);
+  TEST_ASSERT_EQUAL(fromBoot.ticks, wrapping.ticks);
+  TEST_ASSERT_EQUAL_FLOAT(fromBoot.outputSum, wrapping.outputSum);
+  TEST_ASSERT_EQUAL_FLOAT(fromBoot.peakC, wrapping.peakC);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_virtual_clock_steps);
+  RUN_TEST(test_periodic_timer_across_rollover);
+  RUN_TEST(test_run_is_reproducible_across_rollover);
+  return UNITY_END();
+}
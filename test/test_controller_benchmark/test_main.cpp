@@ -0,0 +1,341 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ReflowSequencer.h"
+#include "RunAnalyzer.h"
+#include "SampleFilter.h"
+#include "SSRModulator.h"
+#include "OvenSimulator.h"
+#include "ControlClock.h"
+// Conformance limits of the firmware (include/)
+#include "RunLimits.h"
+
+// Controller benchmark: every controller mode on every oven/load scenario for
+// every profile JSON under lib/ProfileManager/examples. One JSON line per run
+// (prefixed "BENCH ") for scripts:
+//   pio test -e native -f test_controller_benchmark -v | grep '^BENCH ' | cut -c7-
+
+#define TICK_MS 10
+#define SENSOR_MS 100
+#define WINDOW_SIZE 2000.0f
+#define MAX_RUN_MS (30UL * 60UL * 1000UL)
+
+void setUp() {}
+void tearDown() {}
+
+// ---------------------------------------------------------------------------
+// Profiles: the fields of the ProfileManager JSON format the run needs
+
+struct BenchProfile {
+  std::string title;
+  float liquidusC;
+  float maxC;               // temp_range[1]
+  float durationS;          // time_range[1] - time_range[0]
+  float soakLowC;
+  SequencerProfile run;
+};
+
+// Value after "key": in a flat reading of the document (keys are unique in the format)
+static const char* jsonValue(const std::string& text, const char* key) {
+  std::string quoted = std::string("\"") + key + "\"";
+  size_t at = text.find(quoted);
+  if (at == std::string::npos) return 0;
+  at = text.find(':', at + quoted.size());
+  if (at == std::string::npos) return 0;
+  const char* p = text.c_str() + at + 1;
+  while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p++;
+  return p;
+}
+
+static float jsonNumber(const std::string& text, const char* key, float fallback) {
+  const char* p = jsonValue(text, key);
+  return p ? strtof(p, 0) : fallback;
+}
+
+static bool jsonPair(const std::string& text, const char* key, float* first, float* second) {
+  const char* p = jsonValue(text, key);
+  if (!p || *p != '[') return false;
+  char* end;
+  *first = strtof(p + 1, &end);
+  while (*end == ',' || *end == ' ') end++;
+  *second = strtof(end, 0);
+  return true;
+}
+
+static std::string jsonString(const std::string& text, const char* key) {
+  const char* p = jsonValue(text, key);
+  if (!p || *p != '"') return "";
+  const char* end = strchr(p + 1, '"');
+  return end ? std::string(p + 1, end) : "";
+}
+
+static bool loadProfile(const std::filesystem::path& path, BenchProfile* profile) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string text = buffer.str();
+  float t0, t1, unused;
+  profile->title = jsonString(text, "title");
+  profile->liquidusC = jsonNumber(text, "melting_point", 0);
+  if (!jsonPair(text, "temp_range", &unused, &profile->maxC)) return false;
+  if (!jsonPair(text, "time_range", &t0, &t1)) return false;
+  profile->durationS = t1 - t0;
+  SequencerProfile& run = profile->run;
+  if (!jsonPair(text, "preheat", &unused, &run.preheatC)) return false;
+  if (!jsonPair(text, "soak", &profile->soakLowC, &run.soakC)) return false;
+  if (!jsonPair(text, "reflow", &unused, &run.peakC)) return false;
+  if (!jsonPair(text, "cool", &unused, &run.coolC)) return false;
+  run.durationS = profile->durationS;
+  run.maxRampRate = jsonNumber(text, "max_ramp_rate", MPC_MAX_RAMP_RATE);
+  run.gainSchedule = 0;
+  run.gainPoints = 0;
+  return !profile->title.empty();
+}
+
+static std::vector<BenchProfile> loadExampleProfiles() {
+  // The repository root, from this file's path (absolute under PlatformIO)
+  std::filesystem::path root = std::filesystem::path(__FILE__).parent_path().parent_path().parent_path();
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(root / "lib/ProfileManager/examples")) {
+    if (entry.path().extension() == ".json") files.push_back(entry.path());
+  }
+  std::sort(files.begin(), files.end());
+  std::vector<BenchProfile> profiles;
+  for (const auto& path : files) {
+    BenchProfile profile;
+    if (loadProfile(path, &profile)) profiles.push_back(profile);
+  }
+  return profiles;
+}
+
+// ---------------------------------------------------------------------------
+// Scenarios: oven and load
+
+struct Scenario {
+  const char* name;
+  OvenParameters oven;
+};
+
+static OvenParameters oven(float powerW, float massJPerK, float lossWPerK, float boardJPerK, float deadTimeS,
+                           float noiseC) {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.heaterPowerW = powerW;
+  p.thermalMassJPerK = massJPerK;
+  p.lossWPerK = lossWPerK;
+  p.boardMassJPerK = boardJPerK;
+  // Board time constant about 15 s
+  p.boardTransferWPerK = boardJPerK / 15.0f;
+  p.deadTimeS = deadTimeS;
+  p.sensorNoiseC = noiseC;
+  return p;
+}
+
+static std::vector<Scenario> scenarios() {
+  return {
+    {"small_light", oven(1000, 450, 4.0f, 80, 2, 0.1f)},
+    {"small_heavy", oven(1000, 450, 4.0f, 300, 2, 0.1f)},
+    {"large_light", oven(1800, 1200, 7.0f, 80, 3, 0.1f)},
+    {"large_heavy", oven(1800, 1200, 7.0f, 400, 3, 0.1f)},
+    {"long_dead_time", oven(1500, 750, 5.5f, 150, 10, 0.1f)},
+    {"noisy_sensor", oven(1500, 750, 5.5f, 150, 3, 1.0f)},
+  };
+}
+
+// What the characterization wizard identifies: one lumped mass, the
+// thermocouple lag counted into the dead time
+static PlantModel characterize(const OvenParameters& p) {
+  PlantModel m = {1, p.heaterPowerW / p.lossWPerK, (p.thermalMassJPerK + p.boardMassJPerK) / p.lossWPerK,
+                  p.deadTimeS + p.sensorTauS, p.ambientC, 0.1f};
+  return m;
+}
+
+// ---------------------------------------------------------------------------
+// Controller modes
+
+enum ControllerMode {
+  MODE_PID,                 // PID alone, cut-off at the peak minus the margin
+  MODE_PID_FF,              // + model feed-forward
+  MODE_PID_FF_SMITH,        // + dead-time compensation
+  MODE_BOARD,               // + board observer: REFLOW on the board estimate, board peak cut-off
+  MODE_MPC,                 // Model-predictive controller while heating
+  MODE_COUNT
+};
+
+static const char* modeName(int mode) {
+  static const char* names[MODE_COUNT] = {"pid", "pid_ff", "pid_ff_smith", "board", "mpc"};
+  return names[mode];
+}
+
+static SequencerConfig modeConfig(int mode, const OvenParameters& p) {
+  SequencerConfig c = ReflowSequencer<float>::defaultConfig();
+  c.feedForward = mode != MODE_PID;
+  c.deadTimeCompensation = mode >= MODE_PID_FF_SMITH;
+  c.exitOnBoard = mode >= MODE_BOARD;
+  c.modelPredictive = mode == MODE_MPC;
+  if (mode == MODE_BOARD) c.controlVariable[2] = CONTROL_VARIABLE_BOARD;
+  c.board.boardTauS = 15.0f;
+  c.board.massRatio = p.boardMassJPerK / p.thermalMassJPerK;
+  return c;
+}
+
+// ---------------------------------------------------------------------------
+// One run
+
+struct BenchResult {
+  bool completed;
+  float overshootC;         // Board peak above the profile peak
+  float rmsC;               // Setpoint - reading, PREHEAT to REFLOW
+  float talS;               // Board time above liquidus
+  float talDeviationS;      // From the middle of [RUN_TAL_MIN, RUN_TAL_MAX]
+  float cycleS;             // Start to the end of cooling
+  float tickNs;             // Sequencer cost per control tick
+  uint8_t score;            // RunAnalyzer conformance on the board temperature
+};
+
+static RunSpec runSpec(const BenchProfile& profile) {
+  RunSpec spec;
+  spec.liquidusC = profile.liquidusC;
+  spec.talMinS = RUN_TAL_MIN;
+  spec.talMaxS = RUN_TAL_MAX;
+  spec.peakMinC = profile.run.peakC - RUN_PEAK_TOLERANCE;
+  spec.peakMaxC = profile.maxC > profile.run.peakC ? profile.maxC : profile.run.peakC;
+  spec.maxRampRate = profile.run.maxRampRate;
+  spec.maxCoolRate = RUN_MAX_COOL_RATE;
+  spec.soakLowC = profile.soakLowC;
+  spec.soakHighC = profile.run.soakC;
+  spec.soakMinS = RUN_SOAK_MIN;
+  spec.soakMaxS = RUN_SOAK_MAX;
+  spec.coolEndC = profile.run.coolC;
+  spec.maxDurationS = profile.durationS + RUN_DURATION_MARGIN;
+  return spec;
+}
+
+static BenchResult runBenchmark(const BenchProfile& profile, const Scenario& scenario, int mode) {
+  VirtualClock clock;
+  OvenSimulator sim(scenario.oven);
+  sim.setNoiseSeed(1);
+  sim.reset(25.0f);
+  SampleFilter filter(SampleFilter::defaultConfig());
+  SSRModulator modulator(200, 50);
+  modulator.setMode(SSR_MODULATION_WINDOWED);
+  RunAnalyzer analyzer;
+  analyzer.begin(runSpec(profile), 0);
+  ReflowSequencer<float> sequencer;
+  sequencer.setConfig(modeConfig(mode, scenario.oven));
+  OvenGains gains = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+
+  filter.update(sim.getSensorTemperature(), clock.nowUs());
+  sequencer.start(clock.nowMs(), filter.getValue(), filter.getValue(), profile.run, characterize(scenario.oven), gains);
+
+  BenchResult r = {false, 0, 0, 0, 0, 0, 0, 0};
+  float peakBoardC = 0;
+  double sumSq = 0, costNs = 0;
+  uint32_t tracked = 0, ticks = 0;
+  for (; clock.nowMs() < MAX_RUN_MS; clock.advanceMs(TICK_MS)) {
+    uint32_t now = clock.nowMs();
+    if (now % SENSOR_MS == 0) filter.update(sim.getSensorTemperature(), clock.nowUs());
+    float input = filter.getValue();
+    auto start = std::chrono::steady_clock::now();
+    float output = sequencer.update(now, input, filter.getDerivative(), input);
+    costNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    ticks++;
+    SequencerStage stage = sequencer.getStage();
+    if (now % 1000 == 0 && stage != SEQUENCER_COMPLETE) {
+      analyzer.addSample(now / 1000.0f, sim.getBoardTemperature(), stage - SEQUENCER_PREHEAT);
+    }
+    if (stage == SEQUENCER_COMPLETE) {
+      r.completed = true;
+      r.cycleS = now / 1000.0f;
+      break;
+    }
+    if (stage <= SEQUENCER_REFLOW) {
+      float error = sequencer.getSetpoint() - input;
+      sumSq += error * error;
+      tracked++;
+    }
+    modulator.setDuty((uint32_t)(output / WINDOW_SIZE * SSR_DUTY_ONE));
+    sim.step(modulator.nextSlot() ? 1.0f : 0.0f, TICK_MS / 1000.0f);
+    if (sim.getBoardTemperature() > peakBoardC) peakBoardC = sim.getBoardTemperature();
+  }
+  const RunReport& report = analyzer.finish();
+  r.overshootC = peakBoardC - profile.run.peakC;
+  r.rmsC = tracked ? sqrt(sumSq / tracked) : 0;
+  r.talS = report.talS;
+  r.talDeviationS = report.talS - (RUN_TAL_MIN + RUN_TAL_MAX) / 2.0f;
+  r.tickNs = costNs / ticks;
+  r.score = report.score;
+  if (!r.completed) r.cycleS = MAX_RUN_MS / 1000.0f;
+  return r;
+}
+
+// ---------------------------------------------------------------------------
+
+void test_example_profiles_load() {
+  std::vector<BenchProfile> profiles = loadExampleProfiles();
+  TEST_ASSERT_TRUE(profiles.size() >= 3);
+  // profile1.json sorts first
+  const BenchProfile& sac305 = profiles[0];
+  TEST_ASSERT_EQUAL_STRING("Lead-Free SAC305", sac305.title.c_str());
+  TEST_ASSERT_EQUAL_FLOAT(217.0f, sac305.liquidusC);
+  TEST_ASSERT_EQUAL_FLOAT(150.0f, sac305.run.preheatC);
+  TEST_ASSERT_EQUAL_FLOAT(180.0f, sac305.run.soakC);
+  TEST_ASSERT_EQUAL_FLOAT(217.0f, sac305.run.peakC);
+  TEST_ASSERT_EQUAL_FLOAT(150.0f, sac305.run.coolC);
+  TEST_ASSERT_EQUAL_FLOAT(300.0f, sac305.durationS);
+  TEST_ASSERT_EQUAL_FLOAT(MPC_MAX_RAMP_RATE, sac305.run.maxRampRate);
+}
+
+void test_controller_matrix() {
+  std::vector<BenchProfile> profiles = loadExampleProfiles();
+  std::vector<Scenario> matrix = scenarios();
+
+  int runs = 0, completed = 0;
+  float rms[MODE_COUNT] = {0}, overshoot[MODE_COUNT] = {0}, tickNs[MODE_COUNT] = {0};
+  printf("\n");
+  for (const BenchProfile& profile : profiles) {
+    for (const Scenario& scenario : matrix) {
+      for (int mode = 0; mode < MODE_COUNT; mode++) {
+        BenchResult r = runBenchmark(profile, scenario, mode);
+        printf("BENCH {\"profile\":\"%s\",\"scenario\":\"%s\",\"controller\":\"%s\",\"completed\":%s,"
+               "\"overshoot_c\":%.2f,\"rms_c\":%.2f,\"tal_s\":%.1f,\"tal_dev_s\":%.1f,\"cycle_s\":%.1f,"
+               "\"tick_ns\":%.0f,\"score\":%u}\n",
+               profile.title.c_str(), scenario.name, modeName(mode), r.completed ? "true" : "false", r.overshootC,
+               r.rmsC, r.talS, r.talDeviationS, r.cycleS, r.tickNs, r.score);
+        runs++;
+        if (r.completed) completed++;
+        rms[mode] += r.rmsC;
+        overshoot[mode] += fabsf(r.overshootC);
+        tickNs[mode] += r.tickNs;
+      }
+    }
+  }
+  int perMode = runs / MODE_COUNT;
+  printf("%d runs, %d completed\n", runs, completed);
+  for (int mode = 0; mode < MODE_COUNT; mode++) {
+    printf("%-13s mean rms %.2f C, mean |overshoot| %.2f C, %.0f ns/tick\n", modeName(mode), rms[mode] / perMode,
+           overshoot[mode] / perMode, tickNs[mode] / perMode);
+  }
+
+  TEST_ASSERT_EQUAL((int)(profiles.size() * matrix.size() * MODE_COUNT), runs);
+  TEST_ASSERT_EQUAL(runs, completed);
+  // The feed-forward follows the ramps, the board observer lands the peak
+  TEST_ASSERT_LESS_THAN_FLOAT(rms[MODE_PID], rms[MODE_PID_FF]);
+  TEST_ASSERT_LESS_THAN_FLOAT(overshoot[MODE_PID], overshoot[MODE_BOARD]);
+  TEST_ASSERT_LESS_THAN_FLOAT(2.0f, overshoot[MODE_BOARD] / perMode);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_example_profiles_load);
+  RUN_TEST(test_controller_matrix);
+  return UNITY_END();
+}
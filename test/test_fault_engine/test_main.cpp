@@ -0,0 +1,181 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "FaultEngine.h"
+#include "SetpointTrajectory.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define SAMPLE_MS 100
+#define TICK_MS 1000
+#define FAULT_AT_S 90
+#define PEAK_C 217.0f
+
+void setUp() {}
+void tearDown() {}
+
+enum Injection {
+  INJECT_NONE,
+  INJECT_HEATER_OPEN,     // Heater never heats, whatever the SSR is told
+  INJECT_RELAY_STUCK,     // SSR stays closed once the profile cuts it at the peak
+  INJECT_SENSOR_FROZEN,   // Converter keeps returning the last reading
+  INJECT_SENSOR_JUMP,     // Reading steps by 40 C and stays
+  INJECT_SENSOR_OPEN,     // MCP9600 input range flag set
+  INJECT_SENSOR_SILENT    // No conversions arrive
+};
+
+struct FaultRun {
+  FaultCode fault;
+  float latencyS;         // From the injection to the latch
+  float peakOvenC;        // Hottest the oven got
+};
+
+// Reflow profile on the simulated oven: samples every 100 ms (MCP9600 quantised
+// to 0.0625 C), control tick every second, heater cut at the peak, then cooling.
+// A fault is injected at FAULT_AT_S (or at the peak for the stuck relay) and the
+// SSR is forced off once the engine latches.
+static FaultRun runProfile(Injection injection, uint32_t startMs) {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  SetpointTrajectory trajectory;
+  trajectory.buildFromStages(25, 150, 180, PEAK_C, 150, 300, SetpointTrajectory::defaultRates());
+  float peakTimeS = trajectory.point(3).timeS;
+
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setTunings(300, 0.05f, 250);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.reset(25.0f, 0.0f);
+
+  FaultEngine engine(FaultEngine::defaultConfig());
+  FaultRun r = {FAULT_NONE, -1.0f, 0.0f};
+  float duty = 0.0f;
+  float frozenC = 0.0f;
+  bool heating = true;
+  float injectedAtS = -1.0f;
+
+  for (uint32_t ms = 0; ms < 700000; ms += SAMPLE_MS) {
+    uint32_t now = startMs + ms;
+    float t = ms / 1000.0f;
+    bool injected = injectedAtS >= 0.0f;
+    if (!injected && injection != INJECT_NONE && injection != INJECT_RELAY_STUCK && t >= FAULT_AT_S) {
+      injectedAtS = t;
+      injected = true;
+      frozenC = oven.getSensorTemperature();
+    }
+
+    float sensorC = floorf(oven.getSensorTemperature() * 16.0f) / 16.0f;
+    bool open = false;
+    bool silent = false;
+    if (injected) {
+      if (injection == INJECT_SENSOR_FROZEN) sensorC = floorf(frozenC * 16.0f) / 16.0f;
+      if (injection == INJECT_SENSOR_JUMP) sensorC += 40.0f;
+      if (injection == INJECT_SENSOR_OPEN) open = true;
+      if (injection == INJECT_SENSOR_SILENT) silent = true;
+    }
+    if (!silent) engine.addSample(now, sensorC, !open, open, false);
+
+    if (ms % TICK_MS == 0) {
+      if (heating) {
+        float setpoint = t >= peakTimeS ? PEAK_C : trajectory.evaluate(t);
+        duty = pid.compute(setpoint, sensorC) / WINDOW_SIZE;
+        if (sensorC >= PEAK_C - 5.0f) {
+          heating = false;
+          if (injection == INJECT_RELAY_STUCK) injectedAtS = t;
+        }
+      }
+      if (!heating) duty = 0.0f;
+      engine.update(now, sensorC, duty);
+      if (engine.isFaulted() && r.fault == FAULT_NONE) {
+        r.fault = engine.getFault();
+        r.latencyS = injectedAtS >= 0.0f ? t - injectedAtS : -1.0f;
+      }
+    }
+
+    float applied = engine.isFaulted() ? 0.0f : duty;
+    if (injectedAtS >= 0.0f && injection == INJECT_HEATER_OPEN) applied = 0.0f;
+    if (injectedAtS >= 0.0f && injection == INJECT_RELAY_STUCK) applied = 1.0f;
+    oven.step(applied, SAMPLE_MS / 1000.0f);
+    if (oven.getOvenTemperature() > r.peakOvenC) r.peakOvenC = oven.getOvenTemperature();
+  }
+  return r;
+}
+
+static void reportRun(const char* name, const FaultRun& r) {
+  printf("%-16s %-12s latency %5.1f s  oven peak %5.1f C\n",
+         name, FaultEngine::faultName(r.fault), r.latencyS, r.peakOvenC);
+}
+
+void test_clean_run_raises_nothing(void) {
+  FaultRun r = runProfile(INJECT_NONE, 0);
+  reportRun("clean", r);
+  TEST_ASSERT_EQUAL(FAULT_NONE, r.fault);
+
+  // Same run with the millisecond clock wrapping during preheat
+  r = runProfile(INJECT_NONE, 0xFFFFFFFFu - 60000u);
+  TEST_ASSERT_EQUAL(FAULT_NONE, r.fault);
+}
+
+void test_detection_latency(void) {
+  struct Case { const char* name; Injection injection; FaultCode expected; float maxLatencyS; };
+  const Case cases[] = {
+    {"heater open", INJECT_HEATER_OPEN, FAULT_HEATING_TOO_SLOW, 45.0f},
+    {"relay stuck", INJECT_RELAY_STUCK, FAULT_STUCK_RELAY, 20.0f},
+    {"sensor frozen", INJECT_SENSOR_FROZEN, FAULT_SENSOR_FLATLINE, 45.0f},
+    {"sensor jump", INJECT_SENSOR_JUMP, FAULT_SENSOR_JUMP, 1.0f},
+    {"sensor open", INJECT_SENSOR_OPEN, FAULT_SENSOR_OPEN, 1.0f},
+    {"sensor silent", INJECT_SENSOR_SILENT, FAULT_SENSOR_STALE, 3.0f},
+  };
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    FaultRun r = runProfile(cases[i].injection, 1000);
+    reportRun(cases[i].name, r);
+    TEST_ASSERT_EQUAL_MESSAGE(cases[i].expected, r.fault, cases[i].name);
+    TEST_ASSERT_TRUE(r.latencyS >= 0.0f);
+    TEST_ASSERT_TRUE(r.latencyS <= cases[i].maxLatencyS);
+    // Forcing the SSR off keeps the oven out of runaway; a welded relay
+    // needs the hardware cut-off, the engine can only report it
+    if (cases[i].injection != INJECT_RELAY_STUCK) TEST_ASSERT_TRUE(r.peakOvenC < 240.0f);
+  }
+}
+
+void test_latch_and_recovery(void) {
+  FaultEngine engine(FaultEngine::defaultConfig());
+  engine.update(0, 25.0f, 0.0f);
+  for (uint32_t ms = 0; ms < 1000; ms += 100) engine.addSample(ms, 25.0f, true, false, false);
+  TEST_ASSERT_FALSE(engine.isFaulted());
+
+  // A single spike is left to the sample filter, a sustained step latches
+  engine.addSample(1000, 80.0f, true, false, false);
+  engine.addSample(1100, 25.0f, true, false, false);
+  TEST_ASSERT_FALSE(engine.isFaulted());
+
+  // Open circuit is debounced, then latched with the first cause kept
+  engine.addSample(1200, 0.0f, false, true, false);
+  engine.addSample(1300, 0.0f, false, true, false);
+  TEST_ASSERT_FALSE(engine.isFaulted());
+  engine.addSample(1400, 0.0f, false, true, false);
+  TEST_ASSERT_EQUAL(FAULT_SENSOR_OPEN, engine.getFault());
+  engine.update(1500, 300.0f, 0.0f);
+  TEST_ASSERT_EQUAL(FAULT_SENSOR_OPEN, engine.getFault());
+  TEST_ASSERT_TRUE(engine.isRecoverable());
+  TEST_ASSERT_FALSE(engine.isSensorHealthy(1500));
+  engine.addSample(1600, 25.0f, true, false, false);
+  TEST_ASSERT_TRUE(engine.isSensorHealthy(1600));
+  engine.clear();
+  TEST_ASSERT_FALSE(engine.isFaulted());
+
+  // Thermal faults need a reset
+  engine.update(2000, 25.0f, 0.0f);
+  engine.addSample(2000, 270.0f, true, false, false);
+  engine.update(2100, 270.0f, 0.0f);
+  TEST_ASSERT_EQUAL(FAULT_OVER_TEMPERATURE, engine.getFault());
+  TEST_ASSERT_FALSE(engine.isRecoverable());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_clean_run_raises_nothing);
+  RUN_TEST(test_detection_latency);
+  RUN_TEST(test_latch_and_recovery);
+  return UNITY_END();
+}
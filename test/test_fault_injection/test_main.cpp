@@ -0,0 +1,231 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "FaultInjector.h"
+#include "FaultEngine.h"
+#include "ReflowSequencer.h"
+#include "SampleFilter.h"
+#include "SSRModulator.h"
+#include "OvenSimulator.h"
+#include "ControlClock.h"
+
+// Control task tick, one SSR slot per tick
+#define TICK_MS 10
+// Thermocouple conversion period
+#define SENSOR_MS 100
+// reflow_main() sensor read and fault engine update (SENSOR_SAMPLING_TIME)
+#define READ_MS 1000
+#define STALE_MS 2000
+#define WINDOW_SIZE 2000.0f
+#define MAX_RUN_MS (20UL * 60UL * 1000UL)
+// The harness stops this long after a fault
+#define AFTER_FAULT_MS 60000UL
+
+void setUp() {}
+void tearDown() {}
+
+struct InjectedRun {
+  bool completed;
+  FaultCode fault;
+  float peakOvenC;
+  float durationS;
+};
+
+static OvenParameters realisticOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 3.0f;
+  p.boardMassJPerK = 225.0f;
+  p.boardTransferWPerK = 15.0f;
+  p.sensorNoiseC = 0.25f;
+  return p;
+}
+
+// SAC305 run with the firmware's sensor and SSR paths: conversions into the
+// fault engine and the sample filter, the filtered reading every second with
+// the staleness check, the fault check every tick (enterFault() drops SSR_PIN)
+// and the SSR modulator deciding every half-cycle. The injector sits between
+// the paths and the simulated oven.
+static InjectedRun runScript(const FaultEvent* script, uint8_t count, FaultInjectionReport* reports) {
+  OvenSimulator oven(realisticOven());
+  oven.setNoiseSeed(3);
+  oven.reset(25.0f);
+  FaultInjector injector(oven);
+  injector.setScript(script, count);
+
+  VirtualClock clock;
+  SampleFilter filter(SampleFilter::defaultConfig());
+  SSRModulator modulator(200, 50);
+  modulator.setMode(SSR_MODULATION_WINDOWED);
+  FaultEngine engine(FaultEngine::defaultConfig());
+  ReflowSequencer<float> sequencer;
+  PlantModel model = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  OvenGains gains = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+  SequencerProfile profile = {150, 180, 217, 150, 300, 3.0f, 0, 0};
+
+  injector.begin(clock.nowMs());
+  sequencer.start(clock.nowMs(), 25.0f, 25.0f, profile, model, gains);
+  PeriodicTimer readTimer;
+  readTimer.start(clock.nowMs(), READ_MS);
+  float input = 25.0f, rate = 0.0f, output = 0.0f;
+  bool faulted = false;
+  uint32_t faultedMs = 0;
+  InjectedRun r = {false, FAULT_NONE, 0.0f, 0.0f};
+
+  for (; clock.nowMs() < MAX_RUN_MS; clock.advanceMs(TICK_MS)) {
+    uint32_t now = clock.nowMs();
+    // readProbes()
+    if (now % SENSOR_MS == 0) {
+      float reading;
+      bool valid = injector.readSensor(now, &reading);
+      engine.addSample(now, reading, valid, false, false);
+      if (valid && !isnan(reading)) filter.update(reading, clock.nowUs());
+    }
+    if (readTimer.due(now)) {
+      if (filter.isValid() && timeElapsed(clock.nowUs(), filter.getLastTimestampUs()) < STALE_MS * 1000UL) {
+        input = filter.getValue();
+        rate = filter.getDerivative();
+      } else {
+        filter.reset();
+      }
+      engine.update(now, input, faulted ? 0.0f : output / WINDOW_SIZE);
+    }
+    // enterFault(): ssr.off() and the sequencer stops
+    if (engine.isFaulted() && !faulted) {
+      faulted = true;
+      faultedMs = now;
+      sequencer.stop();
+    }
+    if (!faulted) {
+      output = sequencer.update(now, input, rate, input);
+      if (sequencer.getStage() == SEQUENCER_COMPLETE) {
+        r.completed = true;
+        r.durationS = now / 1000.0f;
+        break;
+      }
+    } else {
+      output = 0.0f;
+      if (timeElapsed(now, faultedMs) >= AFTER_FAULT_MS) break;
+    }
+    modulator.setDuty((uint32_t)(output / WINDOW_SIZE * SSR_DUTY_ONE));
+    bool ssrPin = modulator.nextSlot() && !faulted;
+    injector.observe(now, engine.getFault(), ssrPin);
+    injector.step(now, ssrPin ? 1.0f : 0.0f, TICK_MS / 1000.0f);
+    if (oven.getOvenTemperature() > r.peakOvenC) r.peakOvenC = oven.getOvenTemperature();
+  }
+  r.fault = engine.getFault();
+  for (uint8_t i = 0; i < count; i++) reports[i] = injector.getReport(i);
+  return r;
+}
+
+void test_injector_paths() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  FaultInjector injector(oven);
+  const FaultEvent script[] = {
+    {INJECT_I2C_FAILURE, 1000, 500, 0},
+    {INJECT_READING_VALUE, 2000, 100, -999.0f},
+    {INJECT_STUCK_VALUE, 3000, 1000, 0},
+    {INJECT_SSR_STUCK_ON, 5000, 1000, 0},
+    {INJECT_HEATER_DEGRADED, 7000, 0, 0.5f},
+  };
+  injector.setScript(script, 5);
+  injector.begin(0xFFFFFFFFUL - 2500UL);
+  uint32_t start = 0xFFFFFFFFUL - 2500UL;
+  float c;
+  TEST_ASSERT_TRUE(injector.readSensor(start + 999, &c));
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, c);
+  TEST_ASSERT_FALSE(injector.readSensor(start + 1000, &c));
+  TEST_ASSERT_FALSE(injector.readSensor(start + 1499, &c));
+  TEST_ASSERT_TRUE(injector.readSensor(start + 1500, &c));
+  TEST_ASSERT_TRUE(injector.readSensor(start + 2000, &c));
+  TEST_ASSERT_EQUAL_FLOAT(-999.0f, c);
+  // The reading freezes while the oven heats, across the millisecond wrap
+  oven.step(0.0f, 0.1f);
+  TEST_ASSERT_TRUE(injector.readSensor(start + 3000, &c));
+  float frozen = c;
+  oven.step(1.0f, 10.0f);
+  TEST_ASSERT_TRUE(injector.readSensor(start + 3900, &c));
+  TEST_ASSERT_EQUAL_FLOAT(frozen, c);
+  TEST_ASSERT_TRUE(injector.readSensor(start + 4000, &c));
+  TEST_ASSERT_EQUAL_FLOAT(oven.getSensorTemperature(), c);
+
+  TEST_ASSERT_EQUAL_FLOAT(0.3f, injector.heaterFraction(start + 4999, 0.3f));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, injector.heaterFraction(start + 5000, 0.0f));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, injector.heaterFraction(start + 6000, 0.0f));
+  TEST_ASSERT_EQUAL_FLOAT(0.4f, injector.heaterFraction(start + 60000, 0.8f));
+
+  // Latency from the scheduled injection to the latch and to SSR_PIN low
+  injector.observe(start + 7000, FAULT_NONE, true);
+  injector.observe(start + 7500, FAULT_HEATING_TOO_SLOW, true);
+  injector.observe(start + 7510, FAULT_HEATING_TOO_SLOW, false);
+  const FaultInjectionReport& report = injector.getReport(4);
+  TEST_ASSERT_TRUE(report.injected);
+  TEST_ASSERT_EQUAL(FAULT_HEATING_TOO_SLOW, report.detected);
+  TEST_ASSERT_EQUAL(500, report.detectMs);
+  TEST_ASSERT_EQUAL(510, report.ssrOffMs);
+}
+
+// Every injected fault is latched and SSR_PIN goes low in the same tick
+void test_detection_and_shutdown_latency() {
+  struct Case { FaultEvent event; FaultCode expected; float maxDetectS; };
+  const Case cases[] = {
+    {{INJECT_I2C_FAILURE, 100000, 10000, 0}, FAULT_SENSOR_STALE, 3.0f},
+    {{INJECT_READING_VALUE, 100000, 0, -999.0f}, FAULT_SENSOR_RANGE, 0.1f},
+    {{INJECT_READING_NAN, 100000, 0, 0}, FAULT_SENSOR_RANGE, 0.1f},
+    {{INJECT_STUCK_VALUE, 100000, 0, 0}, FAULT_SENSOR_FLATLINE, 35.0f},
+    {{INJECT_NOISE_BURST, 100000, 10000, 20.0f}, FAULT_SENSOR_JUMP, 10.0f},
+    {{INJECT_SSR_STUCK_ON, 400000, 0, 0}, FAULT_STUCK_RELAY, 40.0f},
+    {{INJECT_SSR_STUCK_OFF, 100000, 0, 0}, FAULT_HEATING_TOO_SLOW, 45.0f},
+    {{INJECT_HEATER_DEGRADED, 100000, 0, 0.4f}, FAULT_HEATING_TOO_SLOW, 120.0f},
+  };
+  printf("\n%-16s %-13s %9s %9s %10s\n", "injected", "detected as", "detect s", "SSR off s", "oven peak");
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    FaultInjectionReport report;
+    InjectedRun r = runScript(&cases[i].event, 1, &report);
+    printf("%-16s %-13s %9.2f %9.2f %8.1f C\n", FaultInjector::faultName(cases[i].event.fault),
+           FaultEngine::faultName(report.detected), report.detectMs / 1000.0f, report.ssrOffMs / 1000.0f,
+           r.peakOvenC);
+    TEST_ASSERT_EQUAL_MESSAGE(cases[i].expected, report.detected, FaultInjector::faultName(cases[i].event.fault));
+    TEST_ASSERT_TRUE(report.detectMs >= 0);
+    TEST_ASSERT_TRUE(report.detectMs <= cases[i].maxDetectS * 1000.0f);
+    // enterFault() runs in the tick the fault latches
+    TEST_ASSERT_TRUE(report.ssrOffMs - report.detectMs <= TICK_MS);
+    TEST_ASSERT_FALSE(r.completed);
+    // A welded SSR keeps heating, only the hardware cut-off removes the power
+    if (cases[i].event.fault != INJECT_SSR_STUCK_ON) TEST_ASSERT_LESS_THAN_FLOAT(240.0f, r.peakOvenC);
+  }
+}
+
+// Glitches the filter and the controller absorb do not stop the run
+void test_transients_ride_through() {
+  const FaultEvent script[] = {
+    {INJECT_I2C_FAILURE, 60000, 500, 0},
+    {INJECT_NOISE_BURST, 150000, 5000, 1.0f},
+    {INJECT_HEATER_DEGRADED, 200000, 30000, 0.85f},
+    {INJECT_READING_NAN, 250000, 0, 0},
+  };
+  // Without the NaN reading
+  FaultInjectionReport reports[4];
+  InjectedRun r = runScript(script, 3, reports);
+  printf("Transients: %s after %.0f s, oven peak %.1f C\n", r.completed ? "completed" : "stopped", r.durationS,
+         r.peakOvenC);
+  TEST_ASSERT_TRUE(r.completed);
+  TEST_ASSERT_EQUAL(FAULT_NONE, r.fault);
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(reports[i].injected);
+    TEST_ASSERT_EQUAL(-1, reports[i].detectMs);
+  }
+
+  // A NaN later in the same run is still caught
+  r = runScript(script, 4, reports);
+  TEST_ASSERT_EQUAL(FAULT_SENSOR_RANGE, r.fault);
+  TEST_ASSERT_EQUAL(FAULT_NONE, reports[0].detected);
+  TEST_ASSERT_EQUAL(FAULT_SENSOR_RANGE, reports[3].detected);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_injector_paths);
+  RUN_TEST(test_detection_and_shutdown_latency);
+  RUN_TEST(test_transients_ride_through);
+  return UNITY_END();
+}
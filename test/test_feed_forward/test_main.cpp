@@ -0,0 +1,123 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "PlantModel.h"
+#include "SetpointTrajectory.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+
+void setUp() {}
+void tearDown() {}
+
+static OvenParameters laggyOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 4.0f;
+  return p;
+}
+
+// Characterized model of the simulated oven
+static PlantModel ovenModel() {
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 5.0f, 25.0f, 0.1f};
+  return m;
+}
+
+struct TrackingResult {
+  float rmsC;
+  float preheatLagC;        // Setpoint minus oven at the end of preheat
+  float peakLagC;           // and at the time the peak is due
+  float integralShare;      // Mean |PID integral| relative to the window
+};
+
+// SAC305 trajectory up to the peak (then held) with the repo's preheat gains, optionally
+// with the slope feed-forward summed before the SSR
+static TrackingResult trackProfile(bool feedForward) {
+  OvenSimulator oven(laggyOven());
+  PlantModel model = ovenModel();
+  SetpointTrajectory trajectory;
+  // Ramps this oven can follow (at most ~0.6 C/s near the peak)
+  TrajectoryRates rates = SetpointTrajectory::defaultRates();
+  rates.preheatRate = 1.0f;
+  rates.reflowRate = 0.4f;
+  trajectory.buildFromStages(25, 150, 180, 217, 150, 300, rates);
+  float peakTimeS = trajectory.point(3).timeS;
+
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(25.0f, 0.0f);
+
+  TrackingResult r = {0.0f, 0.0f, 0.0f, 0.0f};
+  int preheatEnd = (int)trajectory.point(1).timeS;
+  int peakDue = (int)peakTimeS;
+  float sumSq = 0.0f;
+  int n = 0;
+  for (int s = 0; s < 400; s++) {
+    float measured = oven.getSensorTemperature();
+    float slope;
+    float setpoint = trajectory.evaluate(s, &slope);
+    float ff = 0.0f;
+    // Hold the peak like the REFLOW state
+    if (s >= peakTimeS) {
+      setpoint = 217.0f;
+      slope = 0.0f;
+    } else {
+      trajectory.lookahead(s, model.deadTimeS, &slope);
+    }
+    if (feedForward) {
+      ff = model.feedForwardDuty(measured, slope) * WINDOW_SIZE;
+    }
+    // The PID works on what the feed-forward leaves
+    pid.setOutputLimits(-ff, WINDOW_SIZE - ff);
+    float output = ff + pid.compute(setpoint, measured);
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+
+    if (s < peakTimeS) {
+      sumSq += (setpoint - measured) * (setpoint - measured);
+      r.integralShare += fabsf(pid.getIntegral()) / WINDOW_SIZE;
+      n++;
+    }
+    if (s == preheatEnd) r.preheatLagC = setpoint - measured;
+    if (s == peakDue) r.peakLagC = setpoint - measured;
+  }
+  r.rmsC = sqrtf(sumSq / n);
+  r.integralShare /= n;
+  return r;
+}
+
+void test_feed_forward_duty() {
+  PlantModel m = ovenModel();
+  // Holding 150 C needs the loss of 125 K, ramping adds tau * rate
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 125.0f / m.gainC, m.feedForwardDuty(150.0f, 0.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, (125.0f + m.tauS * 0.5f) / m.gainC, m.feedForwardDuty(150.0f, 0.5f));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, m.feedForwardDuty(250.0f, 3.0f));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, m.feedForwardDuty(100.0f, -5.0f));
+  m.valid = 0;
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, m.feedForwardDuty(150.0f, 0.5f));
+}
+
+void test_feed_forward_tracks_ramps() {
+  TrackingResult pidOnly = trackProfile(false);
+  TrackingResult withFf = trackProfile(true);
+  printf("\nSAC305 ramp tracking up to the peak, 4 s dead time\n");
+  printf("%-16s %8s %14s %11s %10s\n", "controller", "rms C", "preheat lag C", "peak lag C", "|I| share");
+  printf("%-16s %8.2f %14.2f %11.2f %10.3f\n", "PID", pidOnly.rmsC, pidOnly.preheatLagC, pidOnly.peakLagC,
+         pidOnly.integralShare);
+  printf("%-16s %8.2f %14.2f %11.2f %10.3f\n", "PID + FF", withFf.rmsC, withFf.preheatLagC, withFf.peakLagC,
+         withFf.integralShare);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.5f * pidOnly.rmsC, withFf.rmsC);
+  TEST_ASSERT_LESS_THAN_FLOAT(pidOnly.integralShare, withFf.integralShare);
+  // Ramps arrive on time
+  TEST_ASSERT_LESS_THAN_FLOAT(2.0f, fabsf(withFf.preheatLagC));
+  TEST_ASSERT_LESS_THAN_FLOAT(2.0f, fabsf(withFf.peakLagC));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_feed_forward_duty);
+  RUN_TEST(test_feed_forward_tracks_ramps);
+  return UNITY_END();
+}
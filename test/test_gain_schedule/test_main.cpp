@@ -0,0 +1,194 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "GainSchedule.h"
+#include "PIDAutotune.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+
+void setUp() {}
+void tearDown() {}
+
+static GainPoint point(uint16_t temperature, uint8_t phase, float kp, float ki, float kd) {
+  GainPoint p;
+  p.temperature = temperature;
+  p.phase = phase;
+  p.gains.kp = kp;
+  p.gains.ki = ki;
+  p.gains.kd = kd;
+  return p;
+}
+
+void test_interpolates_between_points() {
+  GainPoint table[] = {
+    point(200, GAIN_PHASE_ANY, 300, 0.5f, 30),
+    point(100, GAIN_PHASE_ANY, 100, 0.1f, 10),
+  };
+  GainSchedule schedule;
+  schedule.setTable(table, 2);
+  PIDGains g;
+  TEST_ASSERT_TRUE(schedule.lookup(150, GAIN_PHASE_SOAK, &g));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 200.0f, g.kp);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.3f, g.ki);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 20.0f, g.kd);
+  TEST_ASSERT_TRUE(schedule.lookup(125, GAIN_PHASE_ANY, &g));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 150.0f, g.kp);
+}
+
+void test_holds_gains_outside_table() {
+  GainPoint table[] = {
+    point(100, GAIN_PHASE_ANY, 100, 0.1f, 10),
+    point(200, GAIN_PHASE_ANY, 300, 0.5f, 30),
+  };
+  GainSchedule schedule;
+  schedule.setTable(table, 2);
+  PIDGains g;
+  TEST_ASSERT_TRUE(schedule.lookup(25, GAIN_PHASE_ANY, &g));
+  TEST_ASSERT_EQUAL_FLOAT(100.0f, g.kp);
+  TEST_ASSERT_TRUE(schedule.lookup(260, GAIN_PHASE_ANY, &g));
+  TEST_ASSERT_EQUAL_FLOAT(300.0f, g.kp);
+}
+
+void test_phase_entries_take_precedence() {
+  GainPoint table[] = {
+    point(100, GAIN_PHASE_ANY, 100, 0.1f, 10),
+    point(200, GAIN_PHASE_ANY, 300, 0.5f, 30),
+    point(150, GAIN_PHASE_REFLOW, 500, 1.0f, 50),
+  };
+  GainSchedule schedule;
+  schedule.setTable(table, 3);
+  PIDGains g;
+  TEST_ASSERT_TRUE(schedule.lookup(150, GAIN_PHASE_REFLOW, &g));
+  TEST_ASSERT_EQUAL_FLOAT(500.0f, g.kp);
+  TEST_ASSERT_TRUE(schedule.lookup(150, GAIN_PHASE_SOAK, &g));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 200.0f, g.kp);
+
+  GainSchedule empty;
+  TEST_ASSERT_TRUE(empty.isEmpty());
+  TEST_ASSERT_FALSE(empty.lookup(150, GAIN_PHASE_SOAK, &g));
+  TEST_ASSERT_EQUAL(GAIN_PHASE_SOAK, GainSchedule::phaseFromName("soak"));
+  TEST_ASSERT_EQUAL(GAIN_PHASE_ANY, GainSchedule::phaseFromName("bogus"));
+}
+
+// Oven whose incremental loss more than doubles between preheat and reflow
+static OvenParameters radiatingOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.lossWPerK = 1.5f;
+  p.radiationWPerK4 = 8e-9f;
+  return p;
+}
+
+static PIDGains tuneAt(float targetC) {
+  OvenSimulator oven(radiatingOven());
+  RelayAutotuner tuner(RelayAutotuner::defaultConfig(WINDOW_SIZE));
+  tuner.start(targetC, 0.0f);
+  float output = 0.0f;
+  for (int i = 0; i < 36000 && tuner.isRunning(); i++) {
+    if (i % 10 == 0) output = tuner.update(oven.getSensorTemperature(), i * STEP_S);
+    oven.step(output / WINDOW_SIZE, STEP_S);
+  }
+  TEST_ASSERT_EQUAL(AUTOTUNE_DONE, tuner.getState());
+  return tuner.getResult().gains;
+}
+
+// RMS tracking error of a 0.5 C/s ramp from 50 to 240 C followed by a 60 s hold.
+// phaseSets = true switches between the table entries at the phase boundaries
+// like the three fixed gain sets, otherwise the table is interpolated every step.
+static float trackRamp(const GainSchedule& schedule, bool phaseSets, float* maxError) {
+  OvenSimulator oven(radiatingOven());
+  oven.reset(50.0f);
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  PIDGains g;
+  schedule.lookup(50.0f, GAIN_PHASE_ANY, &g);
+  pid.setTunings(g);
+  pid.reset(50.0f, 0.0f);
+
+  float sumSq = 0.0f;
+  *maxError = 0.0f;
+  int n = 0;
+  for (int s = 0; s < 440; s++) {
+    float setpoint = s < 380 ? 50.0f + 0.5f * s : 240.0f;
+    float measured = oven.getSensorTemperature();
+    if (phaseSets) {
+      float at = setpoint < 125.0f ? 100.0f : setpoint < 175.0f ? 150.0f : 200.0f;
+      schedule.lookup(at, GAIN_PHASE_ANY, &g);
+    } else {
+      schedule.lookup(measured, GAIN_PHASE_ANY, &g);
+    }
+    pid.setTunings(g);
+    float output = pid.compute(setpoint, measured);
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+    if (s >= 20) {
+      float e = fabsf(oven.getSensorTemperature() - setpoint);
+      sumSq += e * e;
+      if (e > *maxError) *maxError = e;
+      n++;
+    }
+  }
+  return sqrtf(sumSq / n);
+}
+
+// Autotune points replace or extend a JSON schedule without dropping entries
+void test_merge_keeps_existing_entries() {
+  GainPoint table[GAIN_SCHEDULE_SIZE] = {
+    point(150, GAIN_PHASE_SOAK, 300, 0.05f, 250),
+    point(200, GAIN_PHASE_ANY, 400, 0.1f, 300),
+  };
+  bool stored;
+  uint8_t count = GainSchedule::merge(table, 2, point(200, GAIN_PHASE_ANY, 450, 0.2f, 320), &stored);
+  TEST_ASSERT_TRUE(stored);
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL_FLOAT(450.0f, table[1].gains.kp);
+  // Same temperature, other phase: a new entry, the soak entry keeps its tag
+  count = GainSchedule::merge(table, count, point(150, GAIN_PHASE_ANY, 350, 0.1f, 200), &stored);
+  TEST_ASSERT_EQUAL(3, count);
+  TEST_ASSERT_EQUAL(GAIN_PHASE_SOAK, table[0].phase);
+  TEST_ASSERT_EQUAL_FLOAT(300.0f, table[0].gains.kp);
+  for (uint16_t t = 100; count < GAIN_SCHEDULE_SIZE; t += 10) {
+    count = GainSchedule::merge(table, count, point(t, GAIN_PHASE_ANY, 100, 0.1f, 10), &stored);
+  }
+  count = GainSchedule::merge(table, count, point(230, GAIN_PHASE_ANY, 100, 0.1f, 10), &stored);
+  TEST_ASSERT_FALSE(stored);
+  TEST_ASSERT_EQUAL(GAIN_SCHEDULE_SIZE, count);
+}
+
+void test_schedule_tracks_across_range() {
+  GainPoint single[] = {
+    {60, GAIN_PHASE_ANY, tuneAt(60.0f)},
+  };
+  GainPoint table[] = {
+    {100, GAIN_PHASE_ANY, tuneAt(100.0f)},
+    {150, GAIN_PHASE_ANY, tuneAt(150.0f)},
+    {200, GAIN_PHASE_ANY, tuneAt(200.0f)},
+  };
+  GainSchedule singleSchedule;
+  singleSchedule.setTable(single, 1);
+  GainSchedule schedule;
+  schedule.setTable(table, 3);
+
+  float maxSingle, maxSets, maxScheduled;
+  float rmsSingle = trackRamp(singleSchedule, false, &maxSingle);
+  float rmsSets = trackRamp(schedule, true, &maxSets);
+  float rmsScheduled = trackRamp(schedule, false, &maxScheduled);
+  printf("\nRamp 50 -> 240 C at 0.5 C/s, radiating oven\n");
+  printf("%-22s %8s %8s\n", "gains", "rms C", "max C");
+  printf("%-22s %8.3f %8.3f\n", "tuned at 60 C only", rmsSingle, maxSingle);
+  printf("%-22s %8.3f %8.3f\n", "phase sets", rmsSets, maxSets);
+  printf("%-22s %8.3f %8.3f\n", "scheduled", rmsScheduled, maxScheduled);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.5f * rmsSingle, rmsScheduled);
+  TEST_ASSERT_LESS_OR_EQUAL_FLOAT(rmsSets * 1.01f, rmsScheduled);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_interpolates_between_points);
+  RUN_TEST(test_holds_gains_outside_table);
+  RUN_TEST(test_phase_entries_take_precedence);
+  RUN_TEST(test_merge_keeps_existing_entries);
+  RUN_TEST(test_schedule_tracks_across_range);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "IterativeLearning.h"
+#include "PlantModel.h"
+#include "SetpointTrajectory.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+#define RUNS 8
+
+void setUp() {}
+void tearDown() {}
+
+static ILCConfig testConfig() {
+  ILCConfig c = IterativeLearning::defaultConfig(0.05f);
+  c.binS = 2.0f;
+  c.leadS = 6.0f;
+  return c;
+}
+
+void test_correction_interpolates_bin_centers() {
+  IterativeLearning ilc(testConfig());
+  ilc.begin(20.0f);
+  // Constant error only in bin 5 (10-12 s), attributed 3 bins earlier
+  ilc.record(11.0f, 10.0f);
+  TEST_ASSERT_TRUE(ilc.finishRun());
+  TEST_ASSERT_EQUAL(1, ilc.getRuns());
+  float peak = ilc.correctionAt(5.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * 0.025f * 10.0f, peak);
+  // 1-2-1 smoothing spreads it to the neighbours, halfway between centers is the mean
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * peak, ilc.correctionAt(3.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.75f * peak, ilc.correctionAt(4.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, ilc.correctionAt(15.0f));
+}
+
+void test_store_round_trip_and_reset() {
+  IterativeLearning ilc(testConfig());
+  ilc.begin(100.0f);
+  for (int t = 0; t < 100; t++) ilc.record(t, 5.0f);
+  TEST_ASSERT_TRUE(ilc.finishRun());
+
+  ILCStore blob;
+  memcpy(&blob, &ilc.getStore(), sizeof(blob));
+  IterativeLearning other(testConfig());
+  other.load(&blob);
+  TEST_ASSERT_EQUAL(1, other.getRuns());
+  TEST_ASSERT_EQUAL_FLOAT(ilc.correctionAt(50.0f), other.correctionAt(50.0f));
+
+  // Same trajectory keeps the correction, another one starts over
+  other.begin(100.0f);
+  TEST_ASSERT_EQUAL(1, other.getRuns());
+  other.begin(140.0f);
+  TEST_ASSERT_EQUAL(0, other.getRuns());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, other.correctionAt(50.0f));
+
+  // Unknown blobs are ignored
+  blob.version = 99;
+  other.load(&blob);
+  TEST_ASSERT_EQUAL(0, other.getRuns());
+  // Nothing recorded, nothing learned
+  other.begin(100.0f);
+  TEST_ASSERT_FALSE(other.finishRun());
+}
+
+// One run of the SAC305 trajectory up to the peak with feed-forward from a
+// model whose gain is 30% too high (the oven was characterized empty and now
+// carries a board), PID and the learned correction. Returns the rms error.
+static float runProfile(IterativeLearning& ilc, float* peakLag) {
+  OvenParameters params = OvenSimulator::defaultParameters();
+  params.deadTimeS = 4.0f;
+  OvenSimulator oven(params);
+  PlantModel model = {1, 1.3f * 1500.0f / 5.5f, 750.0f / 5.5f, 5.0f, 25.0f, 0.1f};
+  SetpointTrajectory trajectory;
+  TrajectoryRates rates = SetpointTrajectory::defaultRates();
+  rates.preheatRate = 1.0f;
+  rates.reflowRate = 0.4f;
+  trajectory.buildFromStages(25, 150, 180, 217, 150, 300, rates);
+  float peakTimeS = trajectory.point(3).timeS;
+
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(25.0f, 0.0f);
+
+  ilc.begin(peakTimeS);
+  float sumSq = 0.0f;
+  int n = 0;
+  for (int s = 0; s < (int)peakTimeS; s++) {
+    float measured = oven.getSensorTemperature();
+    float slope;
+    float setpoint = trajectory.evaluate(s, &slope);
+    trajectory.lookahead(s, model.deadTimeS, &slope);
+    float ff = (model.feedForwardDuty(measured, slope) + ilc.correctionAt(s)) * WINDOW_SIZE;
+    if (ff < 0.0f) ff = 0.0f;
+    if (ff > WINDOW_SIZE) ff = WINDOW_SIZE;
+    pid.setOutputLimits(-ff, WINDOW_SIZE - ff);
+    float output = ff + pid.compute(setpoint, measured);
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+
+    ilc.record(s, setpoint - measured);
+    sumSq += (setpoint - measured) * (setpoint - measured);
+    n++;
+    *peakLag = setpoint - measured;
+  }
+  ilc.finishRun();
+  return sqrtf(sumSq / n);
+}
+
+void test_learning_converges_over_runs() {
+  // Kp 100 on a 2000 ms window
+  IterativeLearning ilc(IterativeLearning::defaultConfig(100.0f / WINDOW_SIZE));
+  float rms[RUNS];
+  float peakLag[RUNS];
+  printf("\nILC on a 30%% gain mismatch, 4 s dead time\n%4s %8s %11s\n", "run", "rms C", "peak lag C");
+  for (int r = 0; r < RUNS; r++) {
+    rms[r] = runProfile(ilc, &peakLag[r]);
+    printf("%4d %8.2f %11.2f\n", r + 1, rms[r], peakLag[r]);
+  }
+  TEST_ASSERT_EQUAL(RUNS, ilc.getRuns());
+  TEST_ASSERT_LESS_THAN_FLOAT(0.25f * rms[0], rms[RUNS - 1]);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.1f * fabsf(peakLag[0]), fabsf(peakLag[RUNS - 1]));
+  // No divergence once learned
+  TEST_ASSERT_LESS_OR_EQUAL_FLOAT(rms[RUNS - 3] * 1.05f, rms[RUNS - 1]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_correction_interpolates_bin_centers);
+  RUN_TEST(test_store_round_trip_and_reset);
+  RUN_TEST(test_learning_converges_over_runs);
+  return UNITY_END();
+}
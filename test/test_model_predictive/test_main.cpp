@@ -0,0 +1,248 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "ModelPredictive.h"
+#include "PlantModel.h"
+#include "SetpointTrajectory.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+#define MOVE_WEIGHT 0.02f
+
+void setUp() {}
+void tearDown() {}
+
+static OvenParameters laggyOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 4.0f;
+  return p;
+}
+
+// Characterized model of the simulated oven
+static PlantModel ovenModel() {
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 5.0f, 25.0f, 0.1f};
+  return m;
+}
+
+static SetpointTrajectory sac305() {
+  SetpointTrajectory trajectory;
+  TrajectoryRates rates = SetpointTrajectory::defaultRates();
+  rates.preheatRate = 1.0f;
+  rates.reflowRate = 0.4f;
+  trajectory.buildFromStages(25, 150, 180, 217, 150, 300, rates);
+  return trajectory;
+}
+
+// Setpoints one dead time plus 1..MPC_HORIZON samples ahead, the peak held after it is due
+static void fillReference(const SetpointTrajectory& trajectory, float timeS, float deadTimeS, float peakTimeS,
+                          float* reference) {
+  for (int i = 0; i < MPC_HORIZON; i++) {
+    float t = timeS + deadTimeS + i + 1;
+    reference[i] = t >= peakTimeS ? 217.0f : trajectory.lookahead(timeS, t - timeS);
+  }
+}
+
+struct RunResult {
+  float rmsC;
+  float maxC;               // Highest oven temperature
+  float maxRateCPerS;       // Steepest sensor rise over 1 s
+};
+
+template <typename T>
+static RunResult runMpc(MPCController<T>& mpc, float peakLimitC, float maxRate, int seconds, float* trace) {
+  OvenSimulator oven(laggyOven());
+  SetpointTrajectory trajectory = sac305();
+  float peakTimeS = trajectory.point(3).timeS;
+  PlantModel model = ovenModel();
+  mpc.configure(model, 1.0f, MOVE_WEIGHT);
+  mpc.setConstraints(peakLimitC, maxRate);
+  mpc.reset(25.0f, 0.0f);
+
+  RunResult r = {0.0f, 0.0f, 0.0f};
+  float sumSq = 0.0f;
+  int n = 0;
+  float last = oven.getSensorTemperature();
+  float reference[MPC_HORIZON];
+  for (int s = 0; s < seconds; s++) {
+    float measured = oven.getSensorTemperature();
+    float setpoint = s >= peakTimeS ? 217.0f : trajectory.evaluate(s);
+    fillReference(trajectory, s, mpc.getDeadTime(), peakTimeS, reference);
+    float duty = mpc.compute(reference, measured);
+    for (int i = 0; i < 10; i++) oven.step(duty, STEP_S);
+    if (trace) trace[s] = duty;
+    if (s < peakTimeS) {
+      sumSq += (setpoint - measured) * (setpoint - measured);
+      n++;
+    }
+    if (oven.getOvenTemperature() > r.maxC) r.maxC = oven.getOvenTemperature();
+    float now = oven.getSensorTemperature();
+    if (now - last > r.maxRateCPerS) r.maxRateCPerS = now - last;
+    last = now;
+  }
+  r.rmsC = sqrtf(sumSq / n);
+  return r;
+}
+
+// The repo's PID path on the same trajectory, optionally with the slope feed-forward
+static RunResult runPid(bool feedForward, int seconds) {
+  OvenSimulator oven(laggyOven());
+  SetpointTrajectory trajectory = sac305();
+  float peakTimeS = trajectory.point(3).timeS;
+  PlantModel model = ovenModel();
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(25.0f, 0.0f);
+
+  RunResult r = {0.0f, 0.0f, 0.0f};
+  float sumSq = 0.0f;
+  int n = 0;
+  float last = oven.getSensorTemperature();
+  for (int s = 0; s < seconds; s++) {
+    float measured = oven.getSensorTemperature();
+    float slope = 0.0f;
+    float setpoint = s >= peakTimeS ? 217.0f : trajectory.evaluate(s);
+    if (s < peakTimeS) trajectory.lookahead(s, model.deadTimeS, &slope);
+    float ff = feedForward ? model.feedForwardDuty(measured, slope) * WINDOW_SIZE : 0.0f;
+    pid.setOutputLimits(-ff, WINDOW_SIZE - ff);
+    float output = ff + pid.compute(setpoint, measured);
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+    if (s < peakTimeS) {
+      sumSq += (setpoint - measured) * (setpoint - measured);
+      n++;
+    }
+    if (oven.getOvenTemperature() > r.maxC) r.maxC = oven.getOvenTemperature();
+    float now = oven.getSensorTemperature();
+    if (now - last > r.maxRateCPerS) r.maxRateCPerS = now - last;
+    last = now;
+  }
+  r.rmsC = sqrtf(sumSq / n);
+  return r;
+}
+
+void test_holds_setpoint_without_offset() {
+  // Model gain 20% off: the bias estimate removes the steady-state error
+  PlantModel model = ovenModel();
+  model.gainC *= 1.2f;
+  MPCController<float> mpc;
+  TEST_ASSERT_TRUE(mpc.configure(model, 1.0f, MOVE_WEIGHT));
+  TEST_ASSERT_EQUAL(5, mpc.getDelay());
+  OvenSimulator oven(laggyOven());
+  oven.reset(140.0f);
+  mpc.reset(140.0f, model.feedForwardDuty(140.0f, 0.0f));
+  float reference[MPC_HORIZON];
+  for (int i = 0; i < MPC_HORIZON; i++) reference[i] = 150.0f;
+  for (int s = 0; s < 1200; s++) {
+    float duty = mpc.compute(reference, oven.getSensorTemperature());
+    TEST_ASSERT_TRUE(duty >= 0.0f && duty <= 1.0f);
+    for (int i = 0; i < 10; i++) oven.step(duty, STEP_S);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 150.0f, oven.getSensorTemperature());
+}
+
+void test_respects_peak_and_ramp_constraints() {
+  MPCController<float> mpc;
+  // Peak capped below the profile's 217 C: the oven must not cross it
+  RunResult capped = runMpc(mpc, 210.0f, 3.0f, 400, nullptr);
+  printf("\nPeak limit 210 C: max oven %.2f C\n", capped.maxC);
+  TEST_ASSERT_LESS_THAN_FLOAT(210.5f, capped.maxC);
+
+  // A ramp limit below what the preheat asks for
+  RunResult limited = runMpc(mpc, 230.0f, 0.6f, 400, nullptr);
+  printf("Ramp limit 0.6 C/s: max rise %.2f C/s\n", limited.maxRateCPerS);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.7f, limited.maxRateCPerS);
+}
+
+void test_fixed_point_tracks_float() {
+  MPCController<float> mpcFloat;
+  MPCController<Fixed16> mpcFixed;
+  float traceFloat[400], traceFixed[400];
+  RunResult f = runMpc(mpcFloat, 222.0f, 3.0f, 400, traceFloat);
+  RunResult q = runMpc(mpcFixed, 222.0f, 3.0f, 400, traceFixed);
+  float worst = 0.0f;
+  for (int i = 0; i < 400; i++) {
+    float d = fabsf(traceFloat[i] - traceFixed[i]);
+    if (d > worst) worst = d;
+  }
+  printf("\nFixed16 vs float: worst duty difference %.4f, rms %.2f vs %.2f C\n", worst, q.rmsC, f.rmsC);
+  TEST_ASSERT_FLOAT_WITHIN(0.2f, f.rmsC, q.rmsC);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, f.maxC, q.maxC);
+}
+
+template <typename T>
+static double nsPerCompute(bool constrained, float* iterations) {
+  MPCController<T> mpc;
+  mpc.configure(ovenModel(), 1.0f, MOVE_WEIGHT);
+  // A reference above the peak keeps the peak constraint active
+  mpc.setConstraints(constrained ? 150.0f : 1000.0f, 3.0f);
+  mpc.reset(140.0f, 0.4f);
+  float reference[MPC_HORIZON];
+  for (int i = 0; i < MPC_HORIZON; i++) reference[i] = constrained ? 160.0f + i : 140.5f;
+  const int calls = 20000;
+  volatile float sink = 0.0f;
+  long iterationSum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++) {
+    sink = sink + mpc.compute(reference, 140.0f + (i & 7) * 0.1f);
+    iterationSum += mpc.getIterations();
+  }
+  auto end = std::chrono::steady_clock::now();
+  *iterations = (float)iterationSum / calls;
+  return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+static double nsPerPidCompute() {
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.setTunings(100, 0.025f, 20);
+  pid.reset(140.0f, 0.0f);
+  const int calls = 1000000;
+  volatile float sink = 0.0f;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++) sink = sink + pid.compute(150.0f, 140.0f + (i & 7) * 0.1f);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+void test_benchmark_cost_and_tracking() {
+  // Host figures; on the ESP32 the Fixed16 cost scales with the Hildreth iterations
+  float itFloat, itFixed, itFloatC, itFixedC;
+  double nsFloat = nsPerCompute<float>(false, &itFloat);
+  double nsFixed = nsPerCompute<Fixed16>(false, &itFixed);
+  double nsFloatC = nsPerCompute<float>(true, &itFloatC);
+  double nsFixedC = nsPerCompute<Fixed16>(true, &itFixedC);
+  printf("\nPer-tick cost on the host\n");
+  printf("%-34s %10s %11s\n", "controller", "ns/call", "iterations");
+  printf("%-34s %10.1f %11s\n", "PIDController<float>", nsPerPidCompute(), "-");
+  printf("%-34s %10.1f %11.1f\n", "MPCController<float>", nsFloat, itFloat);
+  printf("%-34s %10.1f %11.1f\n", "MPCController<Fixed16>", nsFixed, itFixed);
+  printf("%-34s %10.1f %11.1f\n", "MPCController<float>, constrained", nsFloatC, itFloatC);
+  printf("%-34s %10.1f %11.1f\n", "MPCController<Fixed16>, constrained", nsFixedC, itFixedC);
+
+  MPCController<Fixed16> mpc;
+  RunResult pid = runPid(false, 400);
+  RunResult pidFf = runPid(true, 400);
+  RunResult mpcRun = runMpc(mpc, 222.0f, 3.0f, 400, nullptr);
+  printf("\nSAC305 tracking up to the peak, 4 s dead time\n");
+  printf("%-22s %8s %10s\n", "controller", "rms C", "max oven C");
+  printf("%-22s %8.2f %10.2f\n", "PID", pid.rmsC, pid.maxC);
+  printf("%-22s %8.2f %10.2f\n", "PID + feed-forward", pidFf.rmsC, pidFf.maxC);
+  printf("%-22s %8.2f %10.2f\n", "MPC<Fixed16>", mpcRun.rmsC, mpcRun.maxC);
+  TEST_ASSERT_LESS_THAN_FLOAT(pid.rmsC, mpcRun.rmsC);
+  TEST_ASSERT_LESS_THAN_FLOAT(222.5f, mpcRun.maxC);
+  // Well inside one control period of 1 s even at ESP32 speeds
+  TEST_ASSERT_LESS_THAN_FLOAT(1e6, nsFixedC);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_holds_setpoint_without_offset);
+  RUN_TEST(test_respects_peak_and_ramp_constraints);
+  RUN_TEST(test_fixed_point_tracks_float);
+  RUN_TEST(test_benchmark_cost_and_tracking);
+  return UNITY_END();
+}
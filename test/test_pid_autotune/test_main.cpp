@@ -0,0 +1,85 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "PIDAutotune.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+
+void setUp() {}
+void tearDown() {}
+
+// Run a relay experiment on the simulated oven, 1 s sensor sampling as on target
+static bool runAutotune(OvenSimulator& oven, RelayAutotuner& tuner, float targetC) {
+  tuner.start(targetC, 0.0f);
+  float output = 0.0f;
+  for (int i = 0; i < 36000 && tuner.isRunning(); i++) {
+    float timeS = i * STEP_S;
+    if (i % 10 == 0) {
+      output = tuner.update(oven.getSensorTemperature(), timeS);
+    }
+    oven.step(output / WINDOW_SIZE, STEP_S);
+  }
+  return tuner.getState() == AUTOTUNE_DONE;
+}
+
+// Peak overshoot of a setpoint step with the tuned gains
+static float stepOvershoot(const PIDGains& gains, float fromC, float toC) {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  oven.reset(fromC);
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.setTunings(gains.kp, gains.ki, gains.kd);
+  pid.reset(fromC, 0.0f);
+  float peak = fromC;
+  for (int s = 0; s < 600; s++) {
+    float output = pid.compute(toC, oven.getSensorTemperature());
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+    if (oven.getSensorTemperature() > peak) peak = oven.getSensorTemperature();
+  }
+  return peak - toC;
+}
+
+void test_relay_experiment_finds_limit_cycle() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  RelayAutotuner tuner(RelayAutotuner::defaultConfig(WINDOW_SIZE));
+  TEST_ASSERT_TRUE(runAutotune(oven, tuner, 150.0f));
+
+  const AutotuneResult& r = tuner.getResult();
+  printf("\nKu %.1f  Pu %.1f s  a %.2f C  bias %.0f  ->  Kp %.1f Ki %.3f Kd %.1f\n",
+         r.ku, r.pu, r.amplitudeC, r.bias, r.gains.kp, r.gains.ki, r.gains.kd);
+  TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, r.ku);
+  TEST_ASSERT_GREATER_THAN_FLOAT(1.0f, r.pu);
+  // Adapted bias approaches the duty holding 150 C (loss 5.5 W/K * 125 K of 1500 W)
+  TEST_ASSERT_FLOAT_WITHIN(0.1f * WINDOW_SIZE, 5.5f * 125.0f / 1500.0f * WINDOW_SIZE, r.bias);
+}
+
+void test_tuned_gains_control_the_oven() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  RelayAutotuner tuner(RelayAutotuner::defaultConfig(WINDOW_SIZE));
+  TEST_ASSERT_TRUE(runAutotune(oven, tuner, 150.0f));
+  float overshoot = stepOvershoot(tuner.getResult().gains, 120.0f, 150.0f);
+  printf("Step 120 -> 150 C overshoot with tuned gains: %.2f C\n", overshoot);
+  TEST_ASSERT_LESS_THAN_FLOAT(5.0f, overshoot);
+}
+
+void test_aborts_above_max_temperature() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  AutotuneConfig config = RelayAutotuner::defaultConfig(WINDOW_SIZE);
+  config.maxTemperatureC = 100.0f;
+  RelayAutotuner tuner(config);
+  TEST_ASSERT_FALSE(runAutotune(oven, tuner, 150.0f));
+  TEST_ASSERT_EQUAL(AUTOTUNE_FAILED, tuner.getState());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, tuner.update(120.0f, 10.0f));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_relay_experiment_finds_limit_cycle);
+  RUN_TEST(test_tuned_gains_control_the_oven);
+  RUN_TEST(test_aborts_above_max_temperature);
+  return UNITY_END();
+}
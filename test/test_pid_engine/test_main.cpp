@@ -0,0 +1,148 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+// Reflow_logic.h gains and output range
+#define WINDOW_SIZE 2000.0f
+#define KP_PREHEAT 100.0f
+#define KI_PREHEAT 0.025f
+#define KD_PREHEAT 20.0f
+#define KP_SOAK 300.0f
+#define KI_SOAK 0.05f
+#define KD_SOAK 250.0f
+
+void setUp() {}
+void tearDown() {}
+
+template <typename T>
+static void configure(PIDController<T>& pid, float kp, float ki, float kd) {
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.setTunings(kp, ki, kd);
+}
+
+// Closed loop at 1 s sample time, heater duty averaged over the window
+template <typename T>
+static void runLoop(PIDController<T>& pid, OvenSimulator& oven, float setpoint, int seconds, float* trace) {
+  for (int s = 0; s < seconds; s++) {
+    float input = oven.getSensorTemperature();
+    float output = (float)pid.compute(T(setpoint), T(input));
+    for (int i = 0; i < 100; i++) {
+      oven.step(output / WINDOW_SIZE, 0.01f);
+    }
+    if (trace) trace[s] = oven.getSensorTemperature();
+  }
+}
+
+void test_fixed_point_arithmetic() {
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 3.75f, (float)(Fixed16(1.5f) * Fixed16(2.5f)));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.6f, (float)(Fixed16(-1.5f) / Fixed16(2.5f)));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.05f, (float)Fixed16(0.05f));
+  // 300 * 225 overflows Q16.16 and must saturate, not wrap
+  TEST_ASSERT_GREATER_THAN_FLOAT(32767.0f, (float)(Fixed16(300) * Fixed16(225)));
+  TEST_ASSERT_LESS_THAN_FLOAT(-32767.0f, (float)(Fixed16(-300) * Fixed16(225)));
+}
+
+void test_derivative_on_measurement_has_no_setpoint_kick() {
+  PIDController<float> pid;
+  configure(pid, 0.0f, 0.0f, 10.0f);
+  pid.reset(100.0f, 500.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 500.0f, pid.compute(100.0f, 100.0f));
+  // Setpoint jump does not reach the derivative term
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 500.0f, pid.compute(200.0f, 100.0f));
+  // Measurement change does
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 490.0f, pid.compute(200.0f, 101.0f));
+  // External rate estimate replaces the difference
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 480.0f, pid.compute(200.0f, 101.0f, 2.0f));
+}
+
+void test_anti_windup_limits_overshoot() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  PIDController<float> pid;
+  configure(pid, KP_PREHEAT, 1.0f, KD_PREHEAT);   // Large Ki to provoke windup
+  pid.reset(25.0f, 0.0f);
+  float trace[400];
+  runLoop(pid, oven, 150.0f, 400, trace);
+
+  TEST_ASSERT_LESS_OR_EQUAL(WINDOW_SIZE, (float)pid.getIntegral());
+  float peak = 0.0f;
+  for (int i = 0; i < 400; i++) {
+    if (trace[i] > peak) peak = trace[i];
+  }
+  TEST_ASSERT_LESS_THAN_FLOAT(160.0f, peak);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 150.0f, trace[399]);
+}
+
+void test_bumpless_tuning_change() {
+  OvenSimulator oven(OvenSimulator::defaultParameters());
+  PIDController<float> pid;
+  configure(pid, KP_PREHEAT, KI_PREHEAT, KD_PREHEAT);
+  pid.reset(25.0f, 0.0f);
+  runLoop(pid, oven, 100.0f, 60, nullptr);
+
+  float before = pid.getOutput();
+  pid.setTunings(KP_SOAK, KI_SOAK, KD_SOAK);
+  // Same operating point right after the change: the output must continue smoothly
+  float input = oven.getSensorTemperature();
+  float after = pid.compute(100.0f, input);
+  float naive = KP_SOAK * (100.0f - input);
+  TEST_ASSERT_LESS_THAN_FLOAT(fabsf(naive - before) / 4.0f + 50.0f, fabsf(after - before));
+}
+
+void test_fixed_point_tracks_float() {
+  OvenSimulator ovenFloat(OvenSimulator::defaultParameters());
+  OvenSimulator ovenFixed(OvenSimulator::defaultParameters());
+  PIDController<float> pidFloat;
+  PIDController<Fixed16> pidFixed;
+  configure(pidFloat, KP_SOAK, KI_SOAK, KD_SOAK);
+  configure(pidFixed, KP_SOAK, KI_SOAK, KD_SOAK);
+  pidFloat.reset(25.0f, 0.0f);
+  pidFixed.reset(Fixed16(25.0f), Fixed16(0));
+
+  float traceFloat[300], traceFixed[300];
+  runLoop(pidFloat, ovenFloat, 180.0f, 300, traceFloat);
+  runLoop(pidFixed, ovenFixed, 180.0f, 300, traceFixed);
+  for (int i = 0; i < 300; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, traceFloat[i], traceFixed[i]);
+  }
+}
+
+template <typename T>
+static double nsPerCompute() {
+  PIDController<T> pid;
+  configure(pid, KP_SOAK, KI_SOAK, KD_SOAK);
+  pid.reset(T(25.0f), T(0));
+  const int iterations = 1000000;
+  volatile float sink = 0.0f;
+  float input = 25.0f;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    input += 0.0001f;
+    sink = sink + (float)pid.compute(T(180.0f), T(input));
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void test_benchmark_compute_cost() {
+  // Host figures only; the on-target cycle counts come from examples/Benchmark
+  printf("\nPID compute cost on the host\n");
+  printf("%-24s %10s\n", "engine", "ns/call");
+  printf("%-24s %10.1f\n", "PIDController<double>", nsPerCompute<double>());
+  printf("%-24s %10.1f\n", "PIDController<float>", nsPerCompute<float>());
+  printf("%-24s %10.1f\n", "PIDController<Fixed16>", nsPerCompute<Fixed16>());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fixed_point_arithmetic);
+  RUN_TEST(test_derivative_on_measurement_has_no_setpoint_kick);
+  RUN_TEST(test_anti_windup_limits_overshoot);
+  RUN_TEST(test_bumpless_tuning_change);
+  RUN_TEST(test_fixed_point_tracks_float);
+  RUN_TEST(test_benchmark_compute_cost);
+  return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "PlantModel.h"
+#include "OvenSimulator.h"
+
+#define STEP_S 0.1f
+
+void setUp() {}
+void tearDown() {}
+
+static OvenParameters laggyOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 4.0f;
+  return p;
+}
+
+// Run the wizard on the simulator at 1 Hz, optionally with thermocouple noise
+static PlantModel characterize(const OvenParameters& params, float noiseC, OvenCharacterizer* wizard) {
+  OvenSimulator oven(params);
+  wizard->start(0.0f);
+  float duty = 0.0f;
+  unsigned int seed = 1;
+  for (int i = 0; i < 40000 && wizard->isRunning(); i++) {
+    if (i % 10 == 0) {
+      seed = seed * 1103515245u + 12345u;
+      float noise = noiseC * (((seed >> 16) & 0x7fff) / 16384.0f - 1.0f);
+      duty = wizard->update(oven.getSensorTemperature() + noise, i * STEP_S);
+    }
+    oven.step(duty, STEP_S);
+  }
+  return wizard->getModel();
+}
+
+void test_fit_recovers_first_order_plant() {
+  // Without dead time or sensor lag the discrete model is exact
+  OvenParameters params = OvenSimulator::defaultParameters();
+  params.sensorTauS = 0.0f;
+  OvenCharacterizer wizard(OvenCharacterizer::defaultConfig());
+  PlantModel m = characterize(params, 0.0f, &wizard);
+  TEST_ASSERT_EQUAL(CHARACTERIZE_DONE, wizard.getState());
+  TEST_ASSERT_TRUE(m.valid);
+  TEST_ASSERT_FLOAT_WITHIN(0.02f * 272.7f, 1500.0f / 5.5f, m.gainC);
+  TEST_ASSERT_FLOAT_WITHIN(0.03f * 136.4f, 750.0f / 5.5f, m.tauS);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 25.0f, m.ambientC);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, m.deadTimeS);
+}
+
+void test_fit_finds_dead_time() {
+  OvenCharacterizer wizard(OvenCharacterizer::defaultConfig());
+  PlantModel m = characterize(laggyOven(), 0.25f, &wizard);
+  printf("\nFOPDT fit: K %.1f C, tau %.1f s, dead time %.1f s, ambient %.1f C, rms %.3f C\n",
+         m.gainC, m.tauS, m.deadTimeS, m.ambientC, m.rmsErrorC);
+  TEST_ASSERT_EQUAL(CHARACTERIZE_DONE, wizard.getState());
+  TEST_ASSERT_FLOAT_WITHIN(0.1f * 272.7f, 1500.0f / 5.5f, m.gainC);
+  TEST_ASSERT_FLOAT_WITHIN(0.1f * 136.4f, 750.0f / 5.5f, m.tauS);
+  // Transport delay plus most of the 1.5 s thermocouple lag
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 5.0f, m.deadTimeS);
+}
+
+void test_model_helpers() {
+  PlantModel m = {1, 272.7f, 136.4f, 5.0f, 25.0f, 0.1f};
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 125.0f / 272.7f, m.steadyStateDuty(150.0f));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, m.steadyStateDuty(20.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 272.7f / 136.4f, m.maxRate(25.0f));
+  m.valid = 0;
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, m.maxRate(25.0f));
+}
+
+void test_aborts_above_max_temperature() {
+  CharacterizeConfig config = OvenCharacterizer::defaultConfig();
+  config.maxTemperatureC = 100.0f;
+  OvenCharacterizer wizard(config);
+  characterize(laggyOven(), 0.0f, &wizard);
+  TEST_ASSERT_EQUAL(CHARACTERIZE_FAILED, wizard.getState());
+  TEST_ASSERT_FALSE(wizard.getModel().valid);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fit_recovers_first_order_plant);
+  RUN_TEST(test_fit_finds_dead_time);
+  RUN_TEST(test_model_helpers);
+  RUN_TEST(test_aborts_above_max_temperature);
+  return UNITY_END();
+}
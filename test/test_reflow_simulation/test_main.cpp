@@ -0,0 +1,231 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "ReflowSequencer.h"
+#include "SampleFilter.h"
+#include "SSRModulator.h"
+#include "OvenSimulator.h"
+#include "ControlClock.h"
+
+// Control task period and one SSR slot (mains half-cycle at 50 Hz) per tick
+#define TICK_MS 10
+// Thermocouple conversion period
+#define SENSOR_MS 100
+#define WINDOW_SIZE 2000.0f
+#define MAX_RUN_MS (20UL * 60UL * 1000UL)
+
+void setUp() {}
+void tearDown() {}
+
+// Toaster oven with a transport delay, a board and a noisy thermocouple
+static OvenParameters realisticOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 3.0f;
+  p.boardMassJPerK = 225.0f;
+  p.boardTransferWPerK = 15.0f;
+  p.sensorNoiseC = 0.25f;
+  return p;
+}
+
+// What the characterization wizard identifies on it
+static PlantModel characterizedModel() {
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  return m;
+}
+
+static SequencerProfile sac305() {
+  SequencerProfile p;
+  p.preheatC = 150;
+  p.soakC = 180;
+  p.peakC = 217;
+  p.coolC = 150;
+  p.durationS = 300;
+  p.maxRampRate = 3.0f;
+  p.gainSchedule = 0;
+  p.gainPoints = 0;
+  return p;
+}
+
+// Autotuned on the simulated oven
+static OvenGains tunedGains() {
+  OvenGains g = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+  return g;
+}
+
+struct SimulatedRun {
+  bool completed;
+  uint8_t stagesSeen;       // Bit per SequencerStage entered
+  bool stagesInOrder;
+  float durationS;
+  float peakSensorC;
+  float peakBoardC;
+  float maxTrackingErrorC;  // |Setpoint - reading| in soak and reflow
+  uint32_t ticks;
+};
+
+// The firmware's control loop on the host: sensor conversions into the
+// sample filter, the sequencer every tick and the SSR modulator deciding
+// every half-cycle
+static SimulatedRun runProfile(uint32_t seed) {
+  OvenSimulator oven(realisticOven());
+  oven.setNoiseSeed(seed);
+  oven.reset(25.0f);
+  SampleFilter filter(SampleFilter::defaultConfig());
+  SSRModulator modulator(200, 50);
+  modulator.setMode(SSR_MODULATION_WINDOWED);
+  ReflowSequencer<float> sequencer;
+  VirtualClock clock;
+
+  SimulatedRun r = {false, 0, true, 0.0f, 0.0f, 0.0f, 0.0f, 0};
+  filter.update(oven.getSensorTemperature(), clock.nowUs());
+  sequencer.start(clock.nowMs(), filter.getValue(), filter.getValue(), sac305(), characterizedModel(), tunedGains());
+  SequencerStage last = sequencer.getStage();
+  r.stagesSeen = 1 << last;
+
+  bool heater = false;
+  for (; clock.nowMs() < MAX_RUN_MS; clock.advanceMs(TICK_MS)) {
+    uint32_t now = clock.nowMs();
+    if (now % SENSOR_MS == 0) {
+      filter.update(oven.getSensorTemperature(), clock.nowUs());
+    }
+    float input = filter.getValue();
+    float output = sequencer.update(now, input, filter.getDerivative(), input);
+    SequencerStage stage = sequencer.getStage();
+    if (stage != last) {
+      if (stage != last + 1) r.stagesInOrder = false;
+      r.stagesSeen |= 1 << stage;
+      last = stage;
+    }
+    if (stage == SEQUENCER_COMPLETE) {
+      r.completed = true;
+      r.durationS = now / 1000.0f;
+      break;
+    }
+    if (stage >= SEQUENCER_SOAK && stage <= SEQUENCER_REFLOW) {
+      float error = fabsf(sequencer.getSetpoint() - input);
+      if (error > r.maxTrackingErrorC) r.maxTrackingErrorC = error;
+    }
+    modulator.setDuty((uint32_t)(output / WINDOW_SIZE * SSR_DUTY_ONE));
+    heater = modulator.nextSlot();
+    oven.step(heater ? 1.0f : 0.0f, TICK_MS / 1000.0f);
+    if (oven.getSensorTemperature() > r.peakSensorC) r.peakSensorC = oven.getSensorTemperature();
+    if (oven.getBoardTemperature() > r.peakBoardC) r.peakBoardC = oven.getBoardTemperature();
+    r.ticks++;
+  }
+  return r;
+}
+
+void test_full_profile_faster_than_real_time() {
+  auto start = std::chrono::steady_clock::now();
+  SimulatedRun r = runProfile(1);
+  auto end = std::chrono::steady_clock::now();
+  double wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+  printf("\nSAC305 on the simulated oven (3 s dead time, board, 0.25 C noise), %u ticks of %d ms\n", r.ticks,
+         TICK_MS);
+  printf("Simulated %.0f s in %.2f ms wall time (%.0fx real time)\n", r.durationS, wallMs,
+         r.durationS * 1000.0 / wallMs);
+  printf("Peak reading %.1f C, board %.1f C, worst soak/reflow tracking %.1f C\n", r.peakSensorC, r.peakBoardC,
+         r.maxTrackingErrorC);
+
+  TEST_ASSERT_TRUE(r.completed);
+  TEST_ASSERT_TRUE(r.stagesInOrder);
+  TEST_ASSERT_EQUAL(0x3E, r.stagesSeen);
+  // The board reaches the peak without a long overshoot of the air
+  TEST_ASSERT_FLOAT_WITHIN(8.0f, 217.0f, r.peakBoardC);
+  TEST_ASSERT_LESS_THAN_FLOAT(240.0f, r.peakSensorC);
+  // The trajectory clock holds at TRAJECTORY_MAX_LAG, noise adds to it
+  TEST_ASSERT_LESS_THAN_FLOAT(12.0f, r.maxTrackingErrorC);
+  // Minutes of oven time in well under a second
+  TEST_ASSERT_LESS_THAN_FLOAT(1000.0f, (float)wallMs);
+}
+
+void test_noise_is_repeatable() {
+  SimulatedRun first = runProfile(7);
+  SimulatedRun again = runProfile(7);
+  SimulatedRun other = runProfile(8);
+  TEST_ASSERT_EQUAL(first.ticks, again.ticks);
+  TEST_ASSERT_EQUAL_FLOAT(first.peakSensorC, again.peakSensorC);
+  TEST_ASSERT_TRUE(other.completed);
+
+  // Reading noise around a constant oven has the configured deviation
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.sensorNoiseC = 0.5f;
+  OvenSimulator oven(p);
+  oven.setNoiseSeed(3);
+  float sum = 0.0f, sumSq = 0.0f;
+  int n = 10000;
+  for (int i = 0; i < n; i++) {
+    oven.step(0.0f, 0.01f);
+    float e = oven.getSensorTemperature() - oven.getOvenTemperature();
+    sum += e;
+    sumSq += e * e;
+  }
+  float mean = sum / n;
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, mean);
+  TEST_ASSERT_FLOAT_WITHIN(0.03f, 0.5f, sqrtf(sumSq / n - mean * mean));
+}
+
+void test_stop_drops_the_output() {
+  ReflowSequencer<float> sequencer;
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, sequencer.update(0, 25.0f, 0.0f, 25.0f));
+  sequencer.start(0, 25.0f, 25.0f, sac305(), characterizedModel(), tunedGains());
+  TEST_ASSERT_TRUE(sequencer.isRunning());
+  TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, sequencer.update(10, 25.0f, 0.0f, 25.0f));
+  sequencer.stop();
+  TEST_ASSERT_FALSE(sequencer.isRunning());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, sequencer.update(20, 25.0f, 0.0f, 25.0f));
+}
+
+// Oven that follows the setpoint up to a ceiling; returns the seconds REFLOW
+// spent holding the peak after the trajectory moved on to cooling, and the
+// length of the whole stage
+static float peakHoldS(const PlantModel& model, float ceilingC, float* reflowS = 0) {
+  ReflowSequencer<float> sequencer;
+  sequencer.start(0, 25.0f, 25.0f, sac305(), model, tunedGains());
+  float holdStartS = -1.0f, reflowStartS = -1.0f;
+  for (uint32_t now = 0; now < MAX_RUN_MS; now += TICK_MS) {
+    float c = sequencer.getSetpoint() < ceilingC ? sequencer.getSetpoint() : ceilingC;
+    sequencer.update(now, c, 0.0f, c);
+    bool cooling = sequencer.getTrajectory().phaseAt(sequencer.getTrajectoryTime()) >= TRAJECTORY_COOL;
+    if (sequencer.getStage() == SEQUENCER_REFLOW && reflowStartS < 0) reflowStartS = now / 1000.0f;
+    if (sequencer.getStage() == SEQUENCER_REFLOW && cooling && holdStartS < 0) holdStartS = now / 1000.0f;
+    if (sequencer.getStage() == SEQUENCER_COOL) {
+      if (reflowS) *reflowS = now / 1000.0f - reflowStartS;
+      return holdStartS < 0 ? 0.0f : now / 1000.0f - holdStartS;
+    }
+  }
+  return -1.0f;
+}
+
+// An oven stuck below the cut-off cannot keep REFLOW heating; without a
+// characterized model the air decides the cut-off
+void test_peak_hold_is_bounded() {
+  SequencerConfig config = ReflowSequencer<float>::defaultConfig();
+  PlantModel uncharacterized = {0, 0, 0, 0, 0, 0};
+  float boardHoldS = peakHoldS(characterizedModel(), 211.0f);
+  float fallbackHoldS = peakHoldS(uncharacterized, 211.0f);
+  printf("Held 6 C below the peak: %.1f s with the board exit, %.1f s on the fallback model\n", boardHoldS,
+         fallbackHoldS);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, config.peakHoldMaxS, boardHoldS);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, config.peakHoldMaxS, fallbackHoldS);
+  // Reaching peak - margin cuts on the air before the trajectory starts cooling
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, peakHoldS(uncharacterized, 217.0f));
+
+  // Levelled off more than maxLagC below the peak: the trajectory stops short
+  // of the hold, the REFLOW time limit ends the stage
+  float reflowS = 0.0f;
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, peakHoldS(characterizedModel(), 200.0f, &reflowS));
+  printf("Levelled off at 200 C: REFLOW ended after %.1f s\n", reflowS);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, config.reflowMaxS, reflowS);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_profile_faster_than_real_time);
+  RUN_TEST(test_noise_is_repeatable);
+  RUN_TEST(test_stop_drops_the_output);
+  RUN_TEST(test_peak_hold_is_bounded);
+  return UNITY_END();
+}
@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <stdio.h>
+#include "RunAnalyzer.h"
+
+void setUp() {}
+void tearDown() {}
+
+// SAC305 limits: liquidus 217 C, peak 235-250 C
+static RunSpec sac305Spec() {
+  RunSpec s;
+  s.liquidusC = 217.0f;
+  s.talMinS = 30.0f;
+  s.talMaxS = 90.0f;
+  s.peakMinC = 235.0f;
+  s.peakMaxC = 250.0f;
+  s.maxRampRate = 3.0f;
+  s.maxCoolRate = 6.0f;
+  s.soakLowC = 150.0f;
+  s.soakHighC = 200.0f;
+  s.soakMinS = 60.0f;
+  s.soakMaxS = 120.0f;
+  s.coolEndC = 100.0f;
+  s.maxDurationS = 400.0f;
+  return s;
+}
+
+struct Knot {
+  float timeS;
+  float temperatureC;
+  uint8_t stage;
+};
+
+// Feed a piecewise-linear run at 1 s samples
+static const RunReport& feed(RunAnalyzer& analyzer, const Knot* knots, int n) {
+  for (int k = 0; k + 1 < n; k++) {
+    for (float t = knots[k].timeS; t < knots[k + 1].timeS; t += 1.0f) {
+      float f = (t - knots[k].timeS) / (knots[k + 1].timeS - knots[k].timeS);
+      float temp = knots[k].temperatureC + f * (knots[k + 1].temperatureC - knots[k].temperatureC);
+      analyzer.addSample(t, temp, knots[k].stage);
+    }
+  }
+  analyzer.addSample(knots[n - 1].timeS, knots[n - 1].temperatureC, knots[n - 1].stage);
+  return analyzer.finish();
+}
+
+void test_conforming_run_passes() {
+  // 1 C/s to 150, soak to 200 over 90 s, 1 C/s to 240, 2 C/s down to 100
+  const Knot knots[] = {
+    {0, 30, RUN_STAGE_PREHEAT},
+    {120, 150, RUN_STAGE_SOAK},
+    {210, 200, RUN_STAGE_REFLOW},
+    {250, 240, RUN_STAGE_COOL},
+    {320, 100, RUN_STAGE_COOL},
+  };
+  RunAnalyzer analyzer;
+  analyzer.begin(sac305Spec(), 3);
+  const RunReport& r = feed(analyzer, knots, 5);
+  // Above 217 C from 227 s (rising at 1 C/s) to 261.5 s (falling at 2 C/s)
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 34.5f, r.talS);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 240.0f, r.peakC);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, r.maxRampRate);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, r.maxCoolRate);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, 90.0f, r.soakS);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, r.stageS[RUN_STAGE_PREHEAT]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 90.0f, r.stageS[RUN_STAGE_SOAK]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, r.stageS[RUN_STAGE_REFLOW]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 320.0f, r.durationS);
+  TEST_ASSERT_EQUAL(1, r.complete);
+  TEST_ASSERT_EQUAL(0, r.failed);
+  TEST_ASSERT_EQUAL(100, r.score);
+  TEST_ASSERT_EQUAL(3, r.profile);
+  TEST_ASSERT_TRUE(analyzer.passed());
+}
+
+void test_violations_are_flagged() {
+  // Short soak, 4 C/s spike to a low peak, quenched at 8 C/s
+  const Knot knots[] = {
+    {0, 30, RUN_STAGE_PREHEAT},
+    {100, 150, RUN_STAGE_SOAK},
+    {130, 180, RUN_STAGE_REFLOW},
+    {140, 220, RUN_STAGE_REFLOW},
+    {150, 230, RUN_STAGE_COOL},
+    {166, 102, RUN_STAGE_COOL},
+  };
+  RunAnalyzer analyzer;
+  analyzer.begin(sac305Spec(), 0);
+  const RunReport& r = feed(analyzer, knots, 6);
+  printf("\nTAL %.1f s, peak %.1f C, ramp %.2f C/s, cool %.2f C/s, soak %.1f s, score %d\n", r.talS, r.peakC,
+         r.maxRampRate, r.maxCoolRate, r.soakS, r.score);
+  TEST_ASSERT_EQUAL(RUN_CHECK_TAL | RUN_CHECK_PEAK | RUN_CHECK_RAMP | RUN_CHECK_COOL | RUN_CHECK_SOAK | RUN_CHECK_DURATION,
+                    r.failed);
+  TEST_ASSERT_EQUAL(0, r.score);
+  TEST_ASSERT_EQUAL(0, r.complete);
+  TEST_ASSERT_FALSE(analyzer.passed());
+  TEST_ASSERT_EQUAL_STRING("Ramp", RunAnalyzer::checkName(RUN_CHECK_RAMP));
+}
+
+void test_partial_score() {
+  // Conforming except a 4 C/s final ramp
+  const Knot knots[] = {
+    {0, 30, RUN_STAGE_PREHEAT},
+    {120, 150, RUN_STAGE_SOAK},
+    {210, 200, RUN_STAGE_REFLOW},
+    {220, 240, RUN_STAGE_REFLOW},
+    {250, 240, RUN_STAGE_COOL},
+    {320, 100, RUN_STAGE_COOL},
+  };
+  RunAnalyzer analyzer;
+  analyzer.begin(sac305Spec(), 0);
+  const RunReport& r = feed(analyzer, knots, 6);
+  TEST_ASSERT_EQUAL(RUN_CHECK_RAMP, r.failed);
+  TEST_ASSERT_EQUAL(83, r.score);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_conforming_run_passes);
+  RUN_TEST(test_violations_are_flagged);
+  RUN_TEST(test_partial_score);
+  return UNITY_END();
+}
@@ -0,0 +1,169 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "RunReplay.h"
+
+// recorded_run.log is a serial capture of a SAC305 run on the simulated oven
+// (3 s dead time, board, 0.25 C noise) with the settings below. To replay an
+// incident, put the run's settings into recordedRun() and point REPLAY_LOG at
+// the capture:
+//   REPLAY_LOG=/path/to/capture.log pio test -e native -f test_run_replay -v
+
+#define MAX_ROWS 1800
+
+void setUp() {}
+void tearDown() {}
+
+static RunLogRow rows[MAX_ROWS];
+static ReplayDecision decisions[MAX_ROWS];
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+static std::string fixturePath() {
+  std::string path = __FILE__;
+  return path.substr(0, path.find_last_of("/\\") + 1) + "recorded_run.log";
+}
+
+static void recordedRun(RunReplay<float>& replay) {
+  SequencerProfile profile = {150, 180, 217, 150, 300, 3.0f, 0, 0};
+  PlantModel model = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  OvenGains gains = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+  replay.setRun(ReflowSequencer<float>::defaultConfig(), profile, model, gains);
+}
+
+void test_parse_serial_and_binary_logs() {
+  const char* capture =
+    "Profile 1 selected\r\n"
+    "1 30.00 25.00 100.00\r\n"                  // Before the header: not part of a run
+    "Time Setpoint Input Output\r\n"
+    "Dead-time compensation on, 4.00 s\r\n"
+    "1 24.54 24.00 1494.18\r\n"
+    "Float temp: 24.02 ; Integer temp: 24\r\n"
+    "2 26.04 24.06 1403.77\r\n"
+    "3 27.54 23.99\r\n"                         // Truncated
+    "4 29.04 24.07 1425.96\r\n"
+    "Time Setpoint Input Output\r\n"
+    "1 24.00 24.00 0.00\r\n";
+  RunLogRow parsed[8];
+  uint16_t count = parseRunLog(capture, parsed, 8);
+  TEST_ASSERT_EQUAL(3, count);
+  TEST_ASSERT_EQUAL(1, parsed[0].timeS);
+  TEST_ASSERT_EQUAL_FLOAT(24.54f, parsed[0].setpointC);
+  TEST_ASSERT_EQUAL_FLOAT(24.06f, parsed[1].inputC);
+  TEST_ASSERT_EQUAL(4, parsed[2].timeS);
+  TEST_ASSERT_EQUAL_FLOAT(1425.96f, parsed[2].output);
+  TEST_ASSERT_EQUAL(2, parseRunLog(capture, parsed, 2));
+
+  uint8_t binary[3 * RUN_LOG_RECORD_SIZE];
+  for (int i = 0; i < 3; i++) encodeRunLogRecord(parsed[i], binary + i * RUN_LOG_RECORD_SIZE);
+  RunLogRow decoded[3];
+  // A partial record at the end is dropped
+  TEST_ASSERT_EQUAL(3, parseRunLogBinary(binary, sizeof(binary), decoded, 3));
+  TEST_ASSERT_EQUAL(2, parseRunLogBinary(binary, sizeof(binary) - 1, decoded, 3));
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL(parsed[i].timeS, decoded[i].timeS);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, parsed[i].setpointC, decoded[i].setpointC);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, parsed[i].inputC, decoded[i].inputC);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, parsed[i].output, decoded[i].output);
+  }
+}
+
+// The recorded run replays to the same decisions, in well under a second
+void test_replay_matches_recording() {
+  std::string capture = readFile(fixturePath());
+  uint16_t count = parseRunLog(capture.c_str(), rows, MAX_ROWS);
+  RunReplay<float> replay;
+  recordedRun(replay);
+
+  auto start = std::chrono::steady_clock::now();
+  ReplayReport r = replay.align(rows, count, decisions);
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  printf("\nReplayed %u rows in %.1f ms, row 1 at %u ms: %u differ, setpoint diff max %.2f C rms %.3f C, "
+         "output diff max %.1f rms %.1f\n",
+         r.rows, wallMs, r.phaseMs, r.mismatches, r.maxSetpointDiffC, r.rmsSetpointDiffC, r.maxOutputDiff,
+         r.rmsOutputDiff);
+  TEST_ASSERT_EQUAL(737, count);
+  // The capture's rows were printed 370 ms after the start of each second
+  TEST_ASSERT_EQUAL(370, r.phaseMs);
+  TEST_ASSERT_EQUAL(0, r.mismatches);
+  TEST_ASSERT_EQUAL(-1, r.firstMismatch);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.1f, r.rmsSetpointDiffC);
+  // Every row reached, the last one still cooling
+  TEST_ASSERT_EQUAL(SEQUENCER_PREHEAT, decisions[0].stage);
+  TEST_ASSERT_EQUAL(SEQUENCER_COOL, decisions[count - 1].stage);
+  TEST_ASSERT_LESS_THAN_FLOAT(1000.0f, (float)wallMs);
+}
+
+// A changed decision shows up at the row where the behaviour departs
+void test_replay_flags_changed_decisions() {
+  std::string capture = readFile(fixturePath());
+  uint16_t count = parseRunLog(capture.c_str(), rows, MAX_ROWS);
+  RunReplay<float> replay;
+  recordedRun(replay);
+  ReplayReport recorded = replay.replay(rows, count, 370);
+
+  // Without the feed-forward the first output already differs
+  SequencerConfig changed = ReflowSequencer<float>::defaultConfig();
+  changed.feedForward = false;
+  SequencerProfile profile = {150, 180, 217, 150, 300, 3.0f, 0, 0};
+  PlantModel model = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 4.0f, 25.0f, 0.1f};
+  OvenGains gains = {{100, 1.0f, 50}, {100, 1.0f, 50}, {100, 1.0f, 50}};
+  replay.setRun(changed, profile, model, gains);
+  ReplayReport noFeedForward = replay.replay(rows, count, 370);
+
+  // A 10 C lower peak reshapes the trajectory from the soak on
+  profile.peakC = 207;
+  replay.setRun(ReflowSequencer<float>::defaultConfig(), profile, model, gains);
+  ReplayReport lowerPeak = replay.replay(rows, count, 370);
+
+  printf("Without feed-forward: %u of %u rows differ from row %d; peak 207 C: %u differ from row %d\n",
+         noFeedForward.mismatches, count, noFeedForward.firstMismatch, lowerPeak.mismatches,
+         lowerPeak.firstMismatch);
+  TEST_ASSERT_EQUAL(0, recorded.mismatches);
+  TEST_ASSERT_EQUAL(0, noFeedForward.firstMismatch);
+  TEST_ASSERT_GREATER_THAN(count / 2, noFeedForward.mismatches);
+  TEST_ASSERT_GREATER_THAN(0, lowerPeak.firstMismatch);
+  TEST_ASSERT_GREATER_THAN(0, lowerPeak.mismatches);
+}
+
+// REPLAY_LOG=<capture>: replays an incident and lists the rows that differ
+void test_replay_incident_log() {
+  const char* path = getenv("REPLAY_LOG");
+  std::string capture = readFile(path);
+  uint16_t count = parseRunLog(capture.c_str(), rows, MAX_ROWS);
+  TEST_ASSERT_GREATER_THAN(0, count);
+  RunReplay<float> replay;
+  recordedRun(replay);
+  ReplayReport r = replay.align(rows, count, decisions);
+  printf("\n%s: %u rows, row 1 at %u ms, %u differ\n", path, r.rows, r.phaseMs, r.mismatches);
+  printf("time stage setpoint replayed input output replayed\n");
+  for (uint16_t i = 0; i < count; i++) {
+    if (fabsf(decisions[i].setpointC - rows[i].setpointC) > replay.getConfig().setpointTolC
+        || fabsf(decisions[i].output - rows[i].output) > replay.getConfig().outputTol) {
+      printf("%u %s %.2f %.2f %.2f %.2f %.2f\n", rows[i].timeS, ReflowSequencer<float>::stageName(decisions[i].stage),
+             rows[i].setpointC, decisions[i].setpointC, rows[i].inputC, rows[i].output, decisions[i].output);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_serial_and_binary_logs);
+  RUN_TEST(test_replay_matches_recording);
+  RUN_TEST(test_replay_flags_changed_decisions);
+  if (getenv("REPLAY_LOG")) {
+    RUN_TEST(test_replay_incident_log);
+  }
+  return UNITY_END();
+}
@@ -0,0 +1,129 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "SampleFilter.h"
+
+// 16-bit MCP9600 conversions: 80 ms nominal with acquisition jitter
+#define SAMPLE_US 80000
+#define RAMP_C_PER_S 1.5f
+#define NOISE_C 0.25f
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t nowNs() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float gaussian() {
+  // Box-Muller
+  float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// Noisy ramp with spikes and timestamp jitter; returns the worst tracking error after settling
+static float runRamp(SampleFilter& filter, bool spikes, float* derivativeError) {
+  srand(1234);
+  uint32_t timestampUs = 4294000000UL;   // Crosses the micros() rollover during the run
+  float worstError = 0.0f;
+  float worstDerivative = 0.0f;
+  for (int i = 0; i < 1000; i++) {
+    timestampUs += SAMPLE_US + (rand() % 20001) - 10000;
+    float timeS = i * SAMPLE_US * 1e-6f;
+    float truth = 25.0f + RAMP_C_PER_S * timeS;
+    float sample = truth + NOISE_C * gaussian();
+    if (spikes && i % 37 == 36) {
+      sample += 40.0f;
+    }
+    float value = filter.update(sample, timestampUs);
+    if (i > 100) {
+      // Kalman and IIR lag a ramp by a constant amount, compare against the lag-free truth loosely
+      float error = fabsf(value - truth);
+      if (error > worstError) worstError = error;
+      float dError = fabsf(filter.getDerivative() - RAMP_C_PER_S);
+      if (dError > worstDerivative) worstDerivative = dError;
+    }
+  }
+  *derivativeError = worstDerivative;
+  return worstError;
+}
+
+void test_median_removes_spikes() {
+  SampleFilterConfig config = SampleFilter::defaultConfig();
+  config.smoother = FILTER_SMOOTHER_NONE;
+  SampleFilter filter(config);
+  float derivativeError;
+  float error = runRamp(filter, true, &derivativeError);
+  TEST_ASSERT_LESS_THAN_FLOAT(2.0f, error);
+}
+
+void test_kalman_reduces_noise() {
+  SampleFilter filter(SampleFilter::defaultConfig());
+  float derivativeError;
+  runRamp(filter, false, &derivativeError);
+  SampleFilterStats stats = filter.getStats();
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, NOISE_C, stats.inputNoise);
+  TEST_ASSERT_LESS_THAN_FLOAT(stats.inputNoise / 2.0f, stats.outputNoise);
+}
+
+void test_derivative_with_jitter_and_rollover() {
+  SampleFilter filter(SampleFilter::defaultConfig());
+  float derivativeError;
+  runRamp(filter, true, &derivativeError);
+  TEST_ASSERT_LESS_THAN_FLOAT(1.0f, derivativeError);
+}
+
+void test_iir_uses_actual_interval() {
+  SampleFilterConfig config = SampleFilter::defaultConfig();
+  config.medianWindow = 1;
+  config.smoother = FILTER_SMOOTHER_IIR;
+  config.iirTimeConstantS = 1.0f;
+  SampleFilter filter(config);
+  filter.update(0.0f, 0);
+  // One step of 1 s equals one time constant: alpha = 0.5
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 50.0f, filter.update(100.0f, 1000000));
+}
+
+void test_benchmark_pipeline_cost_and_noise() {
+  struct {
+    const char* name;
+    uint8_t median;
+    FilterSmoother smoother;
+  } setups[] = {
+    {"raw", 1, FILTER_SMOOTHER_NONE},
+    {"median5", 5, FILTER_SMOOTHER_NONE},
+    {"median5+iir", 5, FILTER_SMOOTHER_IIR},
+    {"median5+kalman", 5, FILTER_SMOOTHER_KALMAN},
+  };
+
+  printf("\nFilter pipeline, 12.5 Hz samples, %.2f C noise, spikes every 37 samples\n", NOISE_C);
+  printf("%-16s %10s %10s %10s %10s %10s %10s\n", "pipeline", "median ns", "smooth ns", "deriv ns",
+         "noise C", "max err C", "dT err C/s");
+  for (unsigned i = 0; i < sizeof(setups) / sizeof(setups[0]); i++) {
+    SampleFilterConfig config = SampleFilter::defaultConfig();
+    config.medianWindow = setups[i].median;
+    config.smoother = setups[i].smoother;
+    SampleFilter filter(config);
+    filter.setCostClock(nowNs);
+    float derivativeError;
+    float error = runRamp(filter, true, &derivativeError);
+    SampleFilterStats s = filter.getStats();
+    printf("%-16s %10u %10u %10u %10.3f %10.2f %10.3f\n", setups[i].name, (unsigned)s.medianCost,
+           (unsigned)s.smootherCost, (unsigned)s.derivativeCost, s.outputNoise, error, derivativeError);
+    TEST_ASSERT_EQUAL(1000, s.samples);
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_median_removes_spikes);
+  RUN_TEST(test_kalman_reduces_noise);
+  RUN_TEST(test_derivative_with_jitter_and_rollover);
+  RUN_TEST(test_iir_uses_actual_interval);
+  RUN_TEST(test_benchmark_pipeline_cost_and_noise);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+#include <unity.h>
+#include <stdio.h>
+#include "SensorFusion.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define PEAK_C 217.0f
+
+void setUp() {}
+void tearDown() {}
+
+static SensorFusion threeProbes(FusionPolicy policy) {
+  SensorFusion fusion(3);
+  FusionConfig config = SensorFusion::defaultConfig();
+  config.policy = policy;
+  config.weights[0] = 1.0f;
+  config.weights[1] = 2.0f;
+  config.weights[2] = 1.0f;
+  config.phaseChannel[0] = 0;
+  config.phaseChannel[1] = 0;
+  config.phaseChannel[2] = 1;
+  config.phaseChannel[3] = 0;
+  fusion.setConfig(config);
+  fusion.update(0, 200.0f, 1.0f, 1000);
+  fusion.update(1, 190.0f, 2.0f, 1000);
+  fusion.update(2, 180.0f, 3.0f, 1000);
+  return fusion;
+}
+
+void test_policies(void) {
+  SensorFusion primary = threeProbes(FUSION_POLICY_PRIMARY);
+  TEST_ASSERT_TRUE(primary.fuse(2, 1500));
+  TEST_ASSERT_EQUAL_FLOAT(200.0f, primary.getValue());
+  TEST_ASSERT_EQUAL(0, primary.getSource());
+
+  SensorFusion hottest = threeProbes(FUSION_POLICY_MAX);
+  hottest.update(2, 205.0f, 3.0f, 1000);
+  TEST_ASSERT_TRUE(hottest.fuse(FUSION_PHASE_NONE, 1500));
+  TEST_ASSERT_EQUAL_FLOAT(205.0f, hottest.getValue());
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, hottest.getRate());
+  TEST_ASSERT_EQUAL(2, hottest.getSource());
+
+  SensorFusion weighted = threeProbes(FUSION_POLICY_WEIGHTED);
+  TEST_ASSERT_TRUE(weighted.fuse(0, 1500));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 190.0f, weighted.getValue());
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f, weighted.getRate());
+  TEST_ASSERT_EQUAL(-1, weighted.getSource());
+
+  SensorFusion phase = threeProbes(FUSION_POLICY_PHASE);
+  TEST_ASSERT_TRUE(phase.fuse(0, 1500));
+  TEST_ASSERT_EQUAL(0, phase.getSource());
+  TEST_ASSERT_TRUE(phase.fuse(2, 1500));
+  TEST_ASSERT_EQUAL(1, phase.getSource());
+  TEST_ASSERT_TRUE(phase.fuse(FUSION_PHASE_NONE, 1500));
+  TEST_ASSERT_EQUAL(0, phase.getSource());
+}
+
+void test_failed_probes_drop_out(void) {
+  SensorFusion weighted = threeProbes(FUSION_POLICY_WEIGHTED);
+  weighted.invalidate(1);
+  TEST_ASSERT_TRUE(weighted.fuse(0, 1500));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 190.0f, weighted.getValue());
+  TEST_ASSERT_EQUAL(0x05, weighted.getHealthyMask(1500));
+
+  // Selected probe gone: the primary takes over
+  SensorFusion phase = threeProbes(FUSION_POLICY_PHASE);
+  phase.invalidate(1);
+  TEST_ASSERT_TRUE(phase.fuse(2, 1500));
+  TEST_ASSERT_EQUAL(0, phase.getSource());
+
+  // Primary stale: the next healthy probe, across the millisecond rollover
+  SensorFusion primary(2);
+  primary.update(0, 100.0f, 0.0f, 0xFFFFFF00u);
+  primary.update(1, 90.0f, 0.0f, 0x00000800u);
+  TEST_ASSERT_TRUE(primary.fuse(FUSION_PHASE_NONE, 0x00000400u));
+  TEST_ASSERT_EQUAL(0, primary.getSource());
+  TEST_ASSERT_TRUE(primary.fuse(FUSION_PHASE_NONE, 0x00000C00u));
+  TEST_ASSERT_EQUAL(1, primary.getSource());
+
+  // Nothing healthy: no result, the last value is kept
+  TEST_ASSERT_FALSE(primary.fuse(FUSION_PHASE_NONE, 0x00010000u));
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, primary.getValue());
+}
+
+// Preheat to 150 C, then 120 s of reflow at the peak on the oven with a lagging
+// board: air probe on channel 0, board probe on channel 1
+static float boardPeak(FusionPolicy policy) {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.boardMassJPerK = 225.0f;
+  p.boardTransferWPerK = 15.0f;
+  OvenSimulator oven(p);
+
+  SensorFusion fusion(2);
+  FusionConfig config = SensorFusion::defaultConfig();
+  config.policy = policy;
+  config.phaseChannel[2] = 1;
+  fusion.setConfig(config);
+
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setTunings(300, 2.0f, 250);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.reset(25.0f, 0.0f);
+
+  float peak = 0.0f;
+  float duty = 0.0f;
+  for (uint32_t s = 0; s < 320; s++) {
+    fusion.update(0, oven.getSensorTemperature(), 0.0f, s * 1000);
+    fusion.update(1, oven.getBoardTemperature(), 0.0f, s * 1000);
+    // Preheat to 150, then reflow to the peak
+    uint8_t phase = s < 200 ? 0 : 2;
+    fusion.fuse(phase, s * 1000);
+    duty = pid.compute(s < 200 ? 150.0f : PEAK_C, fusion.getValue()) / WINDOW_SIZE;
+    for (int i = 0; i < 10; i++) oven.step(duty, 0.1f);
+    if (oven.getBoardTemperature() > peak) peak = oven.getBoardTemperature();
+  }
+  return peak;
+}
+
+void test_board_probe_reaches_peak(void) {
+  float airOnly = boardPeak(FUSION_POLICY_PRIMARY);
+  float perPhase = boardPeak(FUSION_POLICY_PHASE);
+  printf("Board peak with the air probe %.1f C, board probe during reflow %.1f C\n", airOnly, perPhase);
+  TEST_ASSERT_TRUE(perPhase > airOnly + 2.0f);
+  TEST_ASSERT_TRUE(perPhase > PEAK_C - 3.0f);
+  TEST_ASSERT_TRUE(perPhase < PEAK_C + 1.0f);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_policies);
+  RUN_TEST(test_failed_probes_drop_out);
+  RUN_TEST(test_board_probe_reaches_peak);
+  return UNITY_END();
+}
@@ -0,0 +1,83 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "SetpointTrajectory.h"
+
+void setUp() {}
+void tearDown() {}
+
+// SAC305 example profile: preheat to 150, soak to 180, peak 217, cool to 150, 300 s
+static void buildSac305(SetpointTrajectory& trajectory) {
+  trajectory.buildFromStages(25, 150, 180, 217, 150, 300, SetpointTrajectory::defaultRates());
+}
+
+void test_knots_follow_profile_stages() {
+  SetpointTrajectory trajectory;
+  buildSac305(trajectory);
+  TEST_ASSERT_EQUAL(5, trajectory.size());
+  // 125 C at 1.5 C/s, 37 C at 1.5 C/s, 67 C at 2 C/s, soak takes the rest of 300 s
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 83.33f, trajectory.point(1).timeS);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 300.0f - 24.67f - 33.5f, trajectory.point(2).timeS);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 300.0f, trajectory.getDuration());
+  TEST_ASSERT_EQUAL_FLOAT(217.0f, trajectory.point(3).temperatureC);
+}
+
+void test_evaluate_is_continuous_with_slopes() {
+  SetpointTrajectory trajectory;
+  buildSac305(trajectory);
+  float slope;
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, trajectory.evaluate(0, &slope));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.5f, slope);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f, trajectory.evaluate(50, &slope));
+
+  float last = trajectory.evaluate(0);
+  float maxStep = 0.0f;
+  for (int i = 1; i <= 3200; i++) {
+    float v = trajectory.evaluate(i * 0.1f);
+    if (fabsf(v - last) > maxStep) maxStep = fabsf(v - last);
+    last = v;
+  }
+  // No staircase: 0.1 s steps never move more than 0.1 s * 2 C/s
+  TEST_ASSERT_LESS_OR_EQUAL_FLOAT(0.2001f, maxStep);
+  TEST_ASSERT_EQUAL_FLOAT(150.0f, trajectory.evaluate(1000, &slope));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, slope);
+  // Going back in time restarts the cursor
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f, trajectory.evaluate(50));
+}
+
+void test_phases_and_lookahead() {
+  SetpointTrajectory trajectory;
+  buildSac305(trajectory);
+  float soakStart = trajectory.point(1).timeS;
+  TEST_ASSERT_EQUAL(TRAJECTORY_PREHEAT, trajectory.phaseAt(10));
+  TEST_ASSERT_EQUAL(TRAJECTORY_SOAK, trajectory.phaseAt(soakStart + 1));
+  TEST_ASSERT_EQUAL(TRAJECTORY_REFLOW, trajectory.phaseAt(trajectory.point(2).timeS + 1));
+  TEST_ASSERT_EQUAL(TRAJECTORY_COOL, trajectory.phaseAt(trajectory.point(3).timeS + 1));
+  TEST_ASSERT_EQUAL(TRAJECTORY_END, trajectory.phaseAt(400));
+
+  // Lookahead across the preheat -> soak knot sees the soak slope
+  trajectory.evaluate(soakStart - 2);
+  float slope;
+  float ahead = trajectory.lookahead(soakStart - 2, 5, &slope);
+  float soakSlope = (180.0f - 150.0f) / (trajectory.point(2).timeS - soakStart);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, soakSlope, slope);
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 150.0f + 3 * soakSlope, ahead);
+  // and leaves the cursor alone
+  TEST_ASSERT_EQUAL(TRAJECTORY_PREHEAT, trajectory.phaseAt(soakStart - 2));
+}
+
+void test_short_time_range_keeps_minimum_soak() {
+  SetpointTrajectory trajectory;
+  trajectory.buildFromStages(25, 150, 180, 217, 150, 60, SetpointTrajectory::defaultRates());
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f, trajectory.point(2).timeS - trajectory.point(1).timeS);
+  TEST_ASSERT_FALSE(trajectory.addPoint(0, 0, TRAJECTORY_END));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_knots_follow_profile_stages);
+  RUN_TEST(test_evaluate_is_continuous_with_slopes);
+  RUN_TEST(test_phases_and_lookahead);
+  RUN_TEST(test_short_time_range_keeps_minimum_soak);
+  return UNITY_END();
+}
@@ -0,0 +1,151 @@
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include "SmithPredictor.h"
+#include "PIDEngine.h"
+#include "OvenSimulator.h"
+
+#define WINDOW_SIZE 2000.0f
+#define STEP_S 0.1f
+#define PEAK_C 235.0f
+#define PEAK_MARGIN_C 5.0f
+
+void setUp() {}
+void tearDown() {}
+
+static OvenParameters laggyOven() {
+  OvenParameters p = OvenSimulator::defaultParameters();
+  p.deadTimeS = 6.0f;
+  return p;
+}
+
+// Model as the characterization run identifies it (transport delay plus sensor lag)
+static PlantModel identifiedModel() {
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 7.0f, 25.0f, 0.1f};
+  return m;
+}
+
+void test_delay_line_matches_plant_without_mismatch() {
+  // With an exact model (no sensor lag) the corrected value equals the undelayed plant
+  OvenParameters p = laggyOven();
+  p.sensorTauS = 0.0f;
+  p.deadTimeS = 5.0f;
+  OvenSimulator oven(p);
+  PlantModel m = {1, 1500.0f / 5.5f, 750.0f / 5.5f, 5.0f, 25.0f, 0.0f};
+  SmithPredictor smith;
+  smith.configure(m, 1.0f);
+  TEST_ASSERT_TRUE(smith.isEnabled());
+  smith.reset(25.0f);
+
+  OvenParameters q = p;
+  q.deadTimeS = 0.0f;
+  OvenSimulator undelayed(q);
+  float maxError = 0.0f;
+  for (int s = 0; s < 300; s++) {
+    float duty = (s / 40) % 2 ? 0.2f : 0.9f;
+    float e = fabsf(smith.correct(oven.getSensorTemperature()) - undelayed.getSensorTemperature());
+    if (e > maxError) maxError = e;
+    smith.update(duty);
+    for (int i = 0; i < 10; i++) {
+      oven.step(duty, STEP_S);
+      undelayed.step(duty, STEP_S);
+    }
+  }
+  printf("\nMax prediction error with an exact model: %.3f C\n", maxError);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.5f, maxError);
+}
+
+void test_disabled_without_dead_time() {
+  PlantModel m = identifiedModel();
+  m.deadTimeS = 0.0f;
+  SmithPredictor smith;
+  smith.configure(m, 1.0f);
+  TEST_ASSERT_FALSE(smith.isEnabled());
+  TEST_ASSERT_EQUAL_FLOAT(123.0f, smith.correct(123.0f));
+  m = identifiedModel();
+  m.valid = 0;
+  smith.configure(m, 1.0f);
+  TEST_ASSERT_FALSE(smith.isEnabled());
+}
+
+// Reflow approach from a settled 150 C soak at full power, as the saturated
+// PID does in the REFLOW state, switching the heater off once the switching
+// temperature reaches the peak minus the margin. Returns the peak the
+// thermocouple sees.
+static float reflowPeak(bool useSmith, float marginC) {
+  OvenSimulator oven(laggyOven());
+  PlantModel model = identifiedModel();
+  float hold = model.steadyStateDuty(150.0f);
+  oven.reset(150.0f);
+  for (int i = 0; i < 10000; i++) oven.step(hold, STEP_S);
+
+  SmithPredictor smith;
+  smith.configure(model, 1.0f);
+  smith.reset(oven.getSensorTemperature());
+
+  bool cooling = false;
+  float peak = 0.0f;
+  for (int s = 0; s < 600; s++) {
+    float measured = oven.getSensorTemperature();
+    float switching = useSmith ? smith.correct(measured) : measured;
+    if (switching >= PEAK_C - marginC) cooling = true;
+    float duty = cooling ? 0.0f : 1.0f;
+    smith.update(duty);
+    for (int i = 0; i < 10; i++) {
+      oven.step(duty, STEP_S);
+      if (oven.getSensorTemperature() > peak) peak = oven.getSensorTemperature();
+    }
+  }
+  return peak;
+}
+
+void test_smith_predictor_hits_peak_without_margin() {
+  float plainMargin = reflowPeak(false, PEAK_MARGIN_C);
+  float plainNoMargin = reflowPeak(false, 0.0f);
+  float smith = reflowPeak(true, 0.0f);
+  printf("Reflow peak for a %.0f C target, 6 s dead time + 1.5 s thermocouple lag\n", PEAK_C);
+  printf("%-28s %8s\n", "switching on", "peak C");
+  printf("%-28s %8.1f\n", "measured, 5 C early", plainMargin);
+  printf("%-28s %8.1f\n", "measured, no margin", plainNoMargin);
+  printf("%-28s %8.1f\n", "Smith predictor, no margin", smith);
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, PEAK_C, smith);
+  TEST_ASSERT_GREATER_THAN_FLOAT(PEAK_C + 1.0f, plainNoMargin);
+}
+
+// Holding the peak with the PID on the corrected temperature does not overshoot
+void test_pid_with_predictor_settles_without_overshoot() {
+  OvenSimulator oven(laggyOven());
+  PlantModel model = identifiedModel();
+  float hold = model.steadyStateDuty(150.0f);
+  oven.reset(150.0f);
+  for (int i = 0; i < 10000; i++) oven.step(hold, STEP_S);
+
+  PIDController<float> pid;
+  pid.setSampleTime(1.0f);
+  pid.setOutputLimits(0, WINDOW_SIZE);
+  pid.setTunings(300, 2.0f, 0);
+  pid.reset(oven.getSensorTemperature(), hold * WINDOW_SIZE);
+  SmithPredictor smith;
+  smith.configure(model, 1.0f);
+  smith.reset(oven.getSensorTemperature());
+
+  float peak = 0.0f;
+  for (int s = 0; s < 900; s++) {
+    float output = pid.compute(PEAK_C, smith.correct(oven.getSensorTemperature()));
+    smith.update(output / WINDOW_SIZE);
+    for (int i = 0; i < 10; i++) oven.step(output / WINDOW_SIZE, STEP_S);
+    if (oven.getSensorTemperature() > peak) peak = oven.getSensorTemperature();
+  }
+  printf("PID on predicted temperature: peak %.2f C, final %.2f C\n", peak, oven.getSensorTemperature());
+  TEST_ASSERT_LESS_THAN_FLOAT(PEAK_C + 1.0f, peak);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, PEAK_C, oven.getSensorTemperature());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_delay_line_matches_plant_without_mismatch);
+  RUN_TEST(test_disabled_without_dead_time);
+  RUN_TEST(test_smith_predictor_hits_peak_without_margin);
+  RUN_TEST(test_pid_with_predictor_settles_without_overshoot);
+  return UNITY_END();
+}
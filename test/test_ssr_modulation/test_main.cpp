@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <stdio.h>
+#include "SSRModulator.h"
+#include "OvenSimulator.h"
+
+// 50 Hz mains: 10 ms half-cycle slots, 2 s window, 0.5 s burst
+#define SLOT_S 0.01f
+#define WINDOW_SLOTS 200
+#define BURST_SLOTS 50
+
+void setUp() {}
+void tearDown() {}
+
+static int countOnSlots(SSRModulator& modulator, int slots) {
+  int on = 0;
+  for (int i = 0; i < slots; i++) {
+    if (modulator.nextSlot()) on++;
+  }
+  return on;
+}
+
+void test_windowed_on_slots_at_start_of_window() {
+  SSRModulator modulator(WINDOW_SLOTS, BURST_SLOTS);
+  modulator.setMode(SSR_MODULATION_WINDOWED);
+  modulator.setDuty(SSR_DUTY_ONE / 4);
+  for (int i = 0; i < WINDOW_SLOTS; i++) {
+    TEST_ASSERT_EQUAL(i < WINDOW_SLOTS / 4, modulator.nextSlot());
+  }
+}
+
+void test_burst_fire_spreads_on_slots() {
+  SSRModulator modulator(WINDOW_SLOTS, BURST_SLOTS);
+  modulator.setMode(SSR_MODULATION_BURST_FIRE);
+  modulator.setDuty(SSR_DUTY_ONE / 2);
+  // 50 % must alternate on/off instead of one block
+  bool previous = modulator.nextSlot();
+  for (int i = 1; i < BURST_SLOTS; i++) {
+    bool on = modulator.nextSlot();
+    TEST_ASSERT_NOT_EQUAL(previous, on);
+    previous = on;
+  }
+  TEST_ASSERT_EQUAL(BURST_SLOTS / 2, countOnSlots(modulator, BURST_SLOTS));
+}
+
+void test_sigma_delta_tracks_duty_every_slot() {
+  SSRModulator modulator(WINDOW_SLOTS, BURST_SLOTS);
+  modulator.setMode(SSR_MODULATION_SIGMA_DELTA);
+  modulator.setDuty(0);
+  TEST_ASSERT_EQUAL(0, countOnSlots(modulator, 100));
+  modulator.setDuty(SSR_DUTY_ONE);
+  TEST_ASSERT_EQUAL(100, countOnSlots(modulator, 100));
+  modulator.setDuty(SSR_DUTY_ONE / 10);
+  TEST_ASSERT_INT_WITHIN(1, 100, countOnSlots(modulator, 1000));
+}
+
+// Open-loop SOAK plateau: hold the duty that balances the oven loss at 150 C
+// and measure the thermocouple ripple once the oven has settled. Ripple is the
+// worst peak-to-peak inside one 2 s window so slow drift from the duty
+// quantisation does not count.
+static float measureRipple(SSRModulation mode, float* deliveredDuty) {
+  OvenParameters params = OvenSimulator::defaultParameters();
+  OvenSimulator oven(params);
+  const float plateauC = 150.0f;
+  const float duty = params.lossWPerK * (plateauC - params.ambientC) / params.heaterPowerW;
+
+  SSRModulator modulator(WINDOW_SLOTS, BURST_SLOTS);
+  modulator.setMode(mode);
+  modulator.setDuty((uint32_t)(duty * SSR_DUTY_ONE + 0.5f));
+  oven.reset(plateauC);
+
+  float ripple = 0.0f;
+  float minC = 1000.0f;
+  float maxC = -1000.0f;
+  long onSlots = 0;
+  long slots = 0;
+  for (int i = 0; i < 12000; i++) {   // 120 s
+    bool on = modulator.nextSlot();
+    oven.step(on ? 1.0f : 0.0f, SLOT_S);
+    if (i < 6000) {                    // Skip the first 60 s
+      continue;
+    }
+    float t = oven.getSensorTemperature();
+    if (t < minC) minC = t;
+    if (t > maxC) maxC = t;
+    if (on) onSlots++;
+    if (++slots % WINDOW_SLOTS == 0) {
+      if (maxC - minC > ripple) ripple = maxC - minC;
+      minC = 1000.0f;
+      maxC = -1000.0f;
+    }
+  }
+  *deliveredDuty = (float)onSlots / slots;
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, duty, *deliveredDuty);
+  return ripple;
+}
+
+void test_benchmark_soak_ripple() {
+  const SSRModulation modes[] = {SSR_MODULATION_WINDOWED, SSR_MODULATION_BURST_FIRE, SSR_MODULATION_SIGMA_DELTA};
+  float ripple[3];
+
+  printf("\nSOAK plateau ripple at 150 C (default oven, thermocouple tau 1.5 s)\n");
+  printf("%-12s %12s %12s\n", "mode", "duty [%]", "ripple [C]");
+  for (int i = 0; i < 3; i++) {
+    float delivered;
+    ripple[i] = measureRipple(modes[i], &delivered);
+    printf("%-12s %12.2f %12.3f\n", SSRModulator::modeName(modes[i]), delivered * 100.0f, ripple[i]);
+  }
+
+  // Half-cycle modulation must cut the slow-PWM ripple substantially
+  TEST_ASSERT_LESS_THAN_FLOAT(ripple[0] / 5.0f, ripple[1]);
+  TEST_ASSERT_LESS_THAN_FLOAT(ripple[0] / 5.0f, ripple[2]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_windowed_on_slots_at_start_of_window);
+  RUN_TEST(test_burst_fire_spreads_on_slots);
+  RUN_TEST(test_sigma_delta_tracks_duty_every_slot);
+  RUN_TEST(test_benchmark_soak_ripple);
+  return UNITY_END();
+}